@@ -0,0 +1,55 @@
+// Reports what parsing costs in allocations, using the counting hooks of a
+// -DOBJECTTEXT_COUNT_ALLOCATIONS=ON build.
+//
+// Usage: objecttext-bench-alloc [kilobytes...]
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <tree_sitter/tree-sitter-objecttext-alloc.h>
+
+#include "objecttext/parser.h"
+#include "synthetic.h"
+
+using namespace objecttext;
+
+int main(int argc, char **argv) {
+    if (!tree_sitter_objecttext_alloc_stats_install()) {
+        fprintf(stderr, "allocation hooks already installed\n");
+        return EXIT_FAILURE;
+    }
+
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; i++) sizes.push_back(static_cast<size_t>(atoi(argv[i])));
+    if (sizes.empty()) sizes = {10, 100, 1000, 10000};
+
+    Parser parser;
+    TSObjecttextAllocStats before = {};
+    TSObjecttextAllocStats stats = {};
+    printf("%10s %12s %10s %12s %12s %10s\n", "input KB", "allocations", "reallocs",
+           "peak bytes", "bytes/input", "allocs/KB");
+    for (size_t kilobytes : sizes) {
+        std::string source = synthetic_ship_parts(kilobytes);
+        tree_sitter_objecttext_alloc_stats_reset();
+        tree_sitter_objecttext_alloc_stats_get(&before);
+        Tree tree = parser.parse(source);
+        tree_sitter_objecttext_alloc_stats_get(&stats);
+        // The peak starts at what was live before the parse: the parser's
+        // own state and nothing of this input.
+        int64_t peak = stats.peak_bytes - before.current_bytes;
+        printf("%10.0f %12llu %10llu %12lld %12.2f %10.1f\n", source.size() / 1e3,
+               static_cast<unsigned long long>(stats.allocations),
+               static_cast<unsigned long long>(stats.reallocations),
+               static_cast<long long>(peak), double(peak) / source.size(),
+               stats.allocations / (source.size() / 1e3));
+    }
+
+    printf("\nsize classes of the last parse:\n");
+    for (unsigned i = 0; i < TS_OBJECTTEXT_ALLOC_SIZE_CLASSES; i++) {
+        if (!stats.size_classes[i]) continue;
+        printf("  %10llu B+ %12llu\n", 1ull << i, static_cast<unsigned long long>(stats.size_classes[i]));
+    }
+    return EXIT_SUCCESS;
+}
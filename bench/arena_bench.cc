@@ -0,0 +1,84 @@
+// Measures batch parsing of many small documents with tree-sitter's default
+// malloc against a per-file Arena installed through install_arena_allocator().
+//
+// Usage: objecttext-bench-arena [files] [kilobytes-per-file]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "objecttext/arena.h"
+#include "objecttext/parser.h"
+#include "objecttext/path_match.h"
+#include "synthetic.h"
+
+using namespace objecttext;
+using Clock = std::chrono::steady_clock;
+
+static double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Parses |source| with a fresh parser and converts the tree into matches,
+// the way match_files() does for every file.
+static size_t parse_and_convert(const PathQuery &query, const std::string &source) {
+    Parser parser;
+    Tree tree = parser.parse(source);
+    std::vector<PathMatch> matches;
+    PathMatcher matcher(query);
+    matcher.run(ts_tree_root_node(tree.get()), source, [&](TSNode node) {
+        matches.push_back(make_path_match(node, source));
+    });
+    return matches.size();
+}
+
+int main(int argc, char **argv) {
+    int files = argc > 1 ? atoi(argv[1]) : 2000;
+    size_t kilobytes = argc > 2 ? static_cast<size_t>(atoi(argv[2])) : 50;
+
+    std::vector<std::string> sources;
+    size_t total_bytes = 0;
+    for (int i = 0; i < files; i++) {
+        sources.push_back(synthetic_ship_parts(kilobytes + i % 7));
+        total_bytes += sources.back().size();
+    }
+    auto query = PathQuery::compile("Root/Parts/*/Components/*/Cost");
+    if (!query) {
+        fprintf(stderr, "invalid path query\n");
+        return EXIT_FAILURE;
+    }
+
+    // The default allocator is measured before the hooks are installed.
+    size_t malloc_matches = 0;
+    Clock::time_point start = Clock::now();
+    for (const std::string &source : sources) malloc_matches += parse_and_convert(*query, source);
+    double malloc_seconds = seconds_since(start);
+
+    install_arena_allocator();
+    Arena arena;
+    size_t arena_matches = 0;
+    size_t peak_used = 0;
+    start = Clock::now();
+    for (const std::string &source : sources) {
+        {
+            ArenaScope scope(arena);
+            arena_matches += parse_and_convert(*query, source);
+            if (arena.bytes_used() > peak_used) peak_used = arena.bytes_used();
+        }
+        arena.reset();
+    }
+    double arena_seconds = seconds_since(start);
+
+    printf("input: %d files, %.1f MB\n", files, total_bytes / 1e6);
+    printf("malloc: %.3f s (%.1f MB/s)\n", malloc_seconds, total_bytes / 1e6 / malloc_seconds);
+    printf("arena:  %.3f s (%.1f MB/s), peak %.1f MB per file\n", arena_seconds,
+           total_bytes / 1e6 / arena_seconds, peak_used / 1e6);
+    printf("speedup: %.2fx\n", malloc_seconds / arena_seconds);
+    if (malloc_matches != arena_matches) {
+        fprintf(stderr, "match counts differ\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,259 @@
+#ifndef OBJECTTEXT_BENCH_CORPUS_H_
+#define OBJECTTEXT_BENCH_CORPUS_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Generates Cosmoteer-like documents for benchmarks: rules files with deep
+// nesting, inheritance, references, expressions, long strings and comments,
+// and localization files of mostly bare words and strings. Output is
+// deterministic for a given seed.
+
+enum class CorpusKind {
+    Rules,
+    Localization,
+};
+
+inline const char *corpus_kind_name(CorpusKind kind) {
+    return kind == CorpusKind::Rules ? "rules" : "localization";
+}
+
+struct CorpusOptions {
+    CorpusKind kind = CorpusKind::Rules;
+    size_t target_bytes = 1 << 20;
+    uint32_t max_depth = 10;
+    uint64_t seed = 1;
+};
+
+class CorpusGenerator {
+public:
+    explicit CorpusGenerator(const CorpusOptions &options)
+        : options_(options), state_(options.seed * 0x9E3779B97F4A7C15ull + 1) {}
+
+    // One document of at least |target_bytes|, a single root block.
+    std::string document() {
+        out_.clear();
+        out_.reserve(options_.target_bytes + 4096);
+        out_ += "// Generated corpus, seed " + std::to_string(options_.seed) + "\n";
+        if (options_.kind == CorpusKind::Rules) {
+            out_ += "Rules\n{\n";
+            while (out_.size() < options_.target_bytes) rules_entry(1, true);
+        } else {
+            out_ += "Strings\n{\n";
+            while (out_.size() < options_.target_bytes) localization_category(1);
+        }
+        out_ += "}\n";
+        return std::move(out_);
+    }
+
+private:
+    CorpusOptions options_;
+    uint64_t state_;
+    std::string out_;
+    std::vector<std::string> path_; // keys of the enclosing blocks, for references
+
+    uint64_t next() {
+        // xorshift64*
+        state_ ^= state_ >> 12;
+        state_ ^= state_ << 25;
+        state_ ^= state_ >> 27;
+        return state_ * 0x2545F4914F6CDD1Dull;
+    }
+    uint32_t below(uint32_t bound) { return static_cast<uint32_t>(next() % bound); }
+    bool percent(uint32_t chance) { return below(100) < chance; }
+
+    template <size_t N>
+    const char *pick(const char *const (&words)[N]) { return words[below(N)]; }
+
+    std::string identifier() {
+        static const char *const nouns[] = {
+            "Thruster", "Cannon", "Reactor", "Shield", "Armor", "Crew", "Door", "Tank",
+            "Factory", "Sensor", "Laser", "Missile", "Engine", "Corridor", "Battery",
+            "Storage", "Bridge", "Turret", "Hull", "Deck",
+        };
+        static const char *const suffixes[] = {"", "", "", "Rules", "Sprite", "Component",
+                                               "Effect", "Toggle", "Mode", "Part"};
+        std::string name = pick(nouns);
+        name += pick(suffixes);
+        if (percent(30)) name += std::to_string(below(64));
+        return name;
+    }
+
+    void indent(uint32_t depth) { out_.append(depth * 4, ' '); }
+
+    void comment(uint32_t depth) {
+        static const char *const lines[] = {
+            "Keep in sync with the base part.", "TODO: rebalance after the next update.",
+            "Values are per second unless noted.", "Inherited by every variant below.",
+        };
+        indent(depth);
+        if (percent(70)) {
+            out_ += "// ";
+            out_ += pick(lines);
+            out_ += '\n';
+            return;
+        }
+        out_ += "/*\n";
+        for (uint32_t i = 0, count = 1 + below(4); i < count; i++) {
+            indent(depth + 1);
+            out_ += pick(lines);
+            out_ += '\n';
+        }
+        indent(depth);
+        out_ += "*/\n";
+    }
+
+    void number() {
+        if (percent(15)) out_ += '-';
+        out_ += std::to_string(below(5000));
+        if (percent(40)) out_ += "." + std::to_string(below(100));
+        if (percent(10)) {
+            out_ += '%';
+        } else if (percent(5)) {
+            out_ += 'd';
+        }
+    }
+
+    void reference() {
+        out_ += '&';
+        if (!path_.empty() && percent(60)) {
+            // A path through up to three enclosing blocks, as inherited
+            // parts use.
+            uint32_t levels = 1 + below(std::min<uint32_t>(3, static_cast<uint32_t>(path_.size())));
+            size_t start = path_.size() - levels;
+            for (size_t i = start; i < path_.size(); i++) out_ += path_[i] + "/";
+        }
+        out_ += identifier();
+    }
+
+    void string_literal(bool long_text) {
+        static const char *const words[] = {
+            "the", "ship", "part", "fires", "when", "powered", "crew", "must", "operate",
+            "it", "and", "consumes", "ammo", "per", "shot", "\\\"heavy\\\"", "while", "moving",
+        };
+        out_ += '"';
+        uint32_t count = long_text ? 20 + below(40) : 1 + below(5);
+        for (uint32_t i = 0; i < count; i++) {
+            if (i) out_ += ' ';
+            out_ += pick(words);
+        }
+        out_ += '"';
+    }
+
+    void rules_value() {
+        uint32_t roll = below(100);
+        if (roll < 45) {
+            number();
+        } else if (roll < 60) {
+            string_literal(percent(20));
+        } else if (roll < 70) {
+            out_ += "@\"Data/" + identifier() + "/" + identifier() + ".png\"";
+        } else if (roll < 85) {
+            reference();
+        } else {
+            // An expression mixing references and numbers.
+            out_ += "(";
+            reference();
+            out_ += ") * ";
+            number();
+            if (percent(50)) {
+                out_ += " + ";
+                number();
+            }
+        }
+    }
+
+    void extensions() {
+        out_ += " : ";
+        for (uint32_t i = 0, count = 1 + below(2); i < count; i++) {
+            if (i) out_ += ", ";
+            out_ += identifier();
+            for (uint32_t part = 0, parts = below(3); part < parts; part++) out_ += "/" + identifier();
+        }
+    }
+
+    // |named| is false for the unnamed groups inside lists.
+    void rules_block(uint32_t depth, bool named) {
+        bool list = named && percent(20);
+        std::string key = named ? identifier() : std::string();
+        indent(depth);
+        if (named) {
+            out_ += key;
+            if (percent(25)) extensions();
+            out_ += '\n';
+            indent(depth);
+        }
+        out_ += list ? "[\n" : "{\n";
+
+        path_.push_back(named ? key : std::to_string(depth));
+        uint32_t entries = list ? 2 + below(6) : 3 + below(10);
+        for (uint32_t i = 0; i < entries; i++) {
+            if (list) {
+                rules_block(depth + 1, false);
+            } else {
+                rules_entry(depth + 1, false);
+            }
+        }
+        path_.pop_back();
+
+        indent(depth);
+        out_ += list ? "]\n" : "}\n";
+    }
+
+    void rules_entry(uint32_t depth, bool top) {
+        uint32_t roll = below(100);
+        if (roll < 8) {
+            comment(depth);
+        } else if (depth < options_.max_depth &&
+                   (top || (roll < 32 - 2 * depth && out_.size() < options_.target_bytes))) {
+            rules_block(depth, true);
+        } else {
+            indent(depth);
+            out_ += identifier() + " = ";
+            rules_value();
+            out_ += '\n';
+        }
+    }
+
+    void localization_category(uint32_t depth) {
+        indent(depth);
+        out_ += identifier() + "\n";
+        indent(depth);
+        out_ += "{\n";
+        for (uint32_t i = 0, count = 5 + below(30); i < count; i++) {
+            if (percent(5)) {
+                comment(depth + 1);
+                continue;
+            }
+            if (depth < 3 && percent(5)) {
+                localization_category(depth + 1);
+                continue;
+            }
+            indent(depth + 1);
+            out_ += identifier() + " = ";
+            if (percent(30)) {
+                string_literal(percent(30));
+            } else {
+                // Bare words run to the end of the line. They may hold a
+                // placeholder, but cannot start with a bracket.
+                static const char *const words[] = {
+                    "Build", "a", "ship", "that", "can", "survive", "the", "void", "and",
+                    "earn", "credits", "from", "every", "mission", "crew", "{0}",
+                };
+                const uint32_t count = sizeof(words) / sizeof(words[0]);
+                for (uint32_t word = 0, words_count = 2 + below(12); word < words_count; word++) {
+                    if (word) out_ += ' ';
+                    out_ += words[below(word ? count : count - 1)];
+                }
+            }
+            out_ += '\n';
+        }
+        indent(depth);
+        out_ += "}\n";
+    }
+};
+
+#endif // OBJECTTEXT_BENCH_CORPUS_H_
@@ -0,0 +1,83 @@
+// Writes a synthetic corpus to disk.
+//
+// Usage: objecttext-corpus <directory> [--files N] [--kilobytes K]
+//                          [--kind rules|localization|mixed] [--seed S]
+//                          [--max-depth D]
+//
+// File sizes vary between half and one and a half times |K|. The same
+// arguments always produce the same files.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#include "corpus.h"
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argv[1][0] == '-') {
+        fprintf(stderr, "usage: %s <directory> [--files N] [--kilobytes K] "
+                        "[--kind rules|localization|mixed] [--seed S] [--max-depth D]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    std::filesystem::path directory = argv[1];
+    int files = 100;
+    size_t kilobytes = 64;
+    std::string kind = "mixed";
+    uint64_t seed = 1;
+    uint32_t max_depth = CorpusOptions().max_depth;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--files") == 0) {
+            files = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--kilobytes") == 0) {
+            kilobytes = static_cast<size_t>(atoll(argv[i + 1]));
+        } else if (strcmp(argv[i], "--kind") == 0) {
+            kind = argv[i + 1];
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            seed = strtoull(argv[i + 1], nullptr, 10);
+        } else if (strcmp(argv[i], "--max-depth") == 0) {
+            max_depth = static_cast<uint32_t>(atoi(argv[i + 1]));
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (kind != "rules" && kind != "localization" && kind != "mixed") {
+        fprintf(stderr, "unknown kind %s\n", kind.c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        fprintf(stderr, "cannot create %s: %s\n", directory.string().c_str(), error.message().c_str());
+        return EXIT_FAILURE;
+    }
+
+    size_t total = 0;
+    for (int i = 0; i < files; i++) {
+        CorpusOptions options;
+        options.seed = seed + static_cast<uint64_t>(i);
+        // Every fourth file of a mixed corpus is a localization file.
+        bool localization = kind == "localization" || (kind == "mixed" && i % 4 == 3);
+        options.kind = localization ? CorpusKind::Localization : CorpusKind::Rules;
+        options.max_depth = max_depth;
+        options.target_bytes = kilobytes * 512 + (options.seed * 7919 % (kilobytes * 1024 + 1));
+        std::string text = CorpusGenerator(options).document();
+
+        char name[64];
+        snprintf(name, sizeof(name), "%s_%04d.rules", corpus_kind_name(options.kind), i);
+        std::filesystem::path path = directory / name;
+        FILE *file = fopen(path.string().c_str(), "wb");
+        if (!file || fwrite(text.data(), 1, text.size(), file) != text.size()) {
+            fprintf(stderr, "cannot write %s\n", path.string().c_str());
+            if (file) fclose(file);
+            return EXIT_FAILURE;
+        }
+        fclose(file);
+        total += text.size();
+    }
+    printf("wrote %d files, %.1f MB, to %s\n", files, total / 1e6, directory.string().c_str());
+    return EXIT_SUCCESS;
+}
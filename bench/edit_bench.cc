@@ -0,0 +1,313 @@
+// Replays editing sessions against a large document with ts_tree_edit and
+// an incremental reparse, and reports latency and changed-range sizes per
+// kind of edit.
+//
+// Usage: objecttext-bench-edit [--megabytes M] [--rounds N] [--seed S]
+//                              [--record TRACE] [--json]
+//        objecttext-bench-edit --file FILE --trace TRACE [--json]
+//
+// Without a trace a session is synthesized over a generated rules corpus:
+// typing and backspacing in values, deleting and restoring lines, pasting
+// whole groups, commenting lines out and back in, and opening a `/*` or `"`
+// that is only closed by a later edit. --record writes that session out.
+//
+// A trace has one edit per line: `<kind> <start byte> <deleted bytes>
+// <inserted text>`, where the text escapes `\n`, `\t` and `\\`.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "corpus.h"
+#include "objecttext/parser.h"
+#include "objecttext/structure.h"
+
+using namespace objecttext;
+using Clock = std::chrono::steady_clock;
+
+struct Edit {
+    std::string kind;
+    uint32_t start;
+    uint32_t deleted;
+    std::string inserted;
+};
+
+struct Sample {
+    double seconds;
+    size_t changed_bytes;
+};
+
+static TSPoint point_at(std::string_view text, size_t offset) {
+    std::string_view prefix = text.substr(0, offset);
+    size_t line_start = prefix.rfind('\n');
+    line_start = line_start == std::string_view::npos ? 0 : line_start + 1;
+    return {static_cast<uint32_t>(count_newlines(prefix)), static_cast<uint32_t>(offset - line_start)};
+}
+
+static std::string escape(const std::string &text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '\n') {
+            out += "\\n";
+        } else if (c == '\t') {
+            out += "\\t";
+        } else if (c == '\\') {
+            out += "\\\\";
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+static std::string unescape(const std::string &text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] != '\\' || i + 1 == text.size()) {
+            out += text[i];
+            continue;
+        }
+        char c = text[++i];
+        out += c == 'n' ? '\n' : c == 't' ? '\t' : c;
+    }
+    return out;
+}
+
+static bool read_trace(const std::string &path, std::vector<Edit> *edits) {
+    std::string contents;
+    if (!read_file(path, &contents)) return false;
+    size_t position = 0;
+    while (position < contents.size()) {
+        size_t end = contents.find('\n', position);
+        if (end == std::string::npos) end = contents.size();
+        std::string line = contents.substr(position, end - position);
+        position = end + 1;
+        if (line.empty()) continue;
+
+        char kind[64];
+        unsigned start = 0, deleted = 0;
+        int consumed = 0;
+        if (sscanf(line.c_str(), "%63s %u %u%n", kind, &start, &deleted, &consumed) != 3) return false;
+        std::string inserted = static_cast<size_t>(consumed) < line.size()
+            ? line.substr(static_cast<size_t>(consumed) + 1)
+            : std::string();
+        edits->push_back({kind, start, deleted, unescape(inserted)});
+    }
+    return true;
+}
+
+static bool write_trace(const std::string &path, const std::vector<Edit> &edits) {
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) return false;
+    for (const Edit &edit : edits) {
+        fprintf(file, "%s %u %u %s\n", edit.kind.c_str(), edit.start, edit.deleted,
+                escape(edit.inserted).c_str());
+    }
+    return fclose(file) == 0;
+}
+
+// Builds a session of edit groups that each leave the document as it was,
+// so every position can be picked from the original text.
+static std::vector<Edit> synthesize(const std::string &source, int rounds, uint64_t seed) {
+    std::mt19937_64 random(seed);
+    auto below = [&](size_t bound) { return static_cast<size_t>(random() % bound); };
+
+    std::vector<uint32_t> assignments; // start of lines holding ` = `
+    for (size_t start = 0; start < source.size();) {
+        size_t end = source.find('\n', start);
+        if (end == std::string::npos) end = source.size();
+        if (std::string_view(source).substr(start, end - start).find(" = ") != std::string_view::npos) {
+            assignments.push_back(static_cast<uint32_t>(start));
+        }
+        start = end + 1;
+    }
+    std::vector<StructureSpan> groups;
+    StructureIndex index = StructureIndex::build(source);
+    for (const StructureSpan &span : index.blocks()) {
+        uint32_t size = span.end_byte - span.key_start;
+        if (span.key_start != span.start_byte && size >= 500 && size <= 8000) groups.push_back(span);
+    }
+    if (assignments.empty()) return {};
+
+    auto line_end = [&](uint32_t start) {
+        return static_cast<uint32_t>(source.find('\n', start));
+    };
+    auto first_non_space = [&](uint32_t start) {
+        return static_cast<uint32_t>(source.find_first_not_of(' ', start));
+    };
+
+    std::vector<Edit> edits;
+    for (int round = 0; round < rounds; round++) {
+        uint32_t line = assignments[below(assignments.size())];
+        uint32_t end = line_end(line);
+        uint32_t value = static_cast<uint32_t>(source.find(" = ", line)) + 3;
+
+        edits.push_back({"type", value, 0, "7"});
+        edits.push_back({"backspace", value, 1, ""});
+
+        std::string text = source.substr(line, end + 1 - line);
+        edits.push_back({"delete-line", line, static_cast<uint32_t>(text.size()), ""});
+        edits.push_back({"undo", line, 0, text});
+
+        uint32_t indent = first_non_space(line);
+        edits.push_back({"comment", indent, 0, "// "});
+        edits.push_back({"uncomment", indent, 3, ""});
+
+        if (!groups.empty()) {
+            const StructureSpan &group = groups[below(groups.size())];
+            uint32_t group_start = static_cast<uint32_t>(source.rfind('\n', group.key_start) + 1);
+            uint32_t group_end = line_end(group.end_byte - 1) + 1;
+            std::string copy = source.substr(group_start, group_end - group_start);
+            edits.push_back({"paste-group", group_end, 0, copy});
+            edits.push_back({"undo", group_end, static_cast<uint32_t>(copy.size()), ""});
+        }
+
+        // `/*` at the start of a line comments out everything up to the next
+        // `*/` until the closing half is typed a few lines below.
+        uint32_t close_line = line;
+        for (int i = 0; i < 3 && close_line < source.size(); i++) close_line = line_end(close_line) + 1;
+        uint32_t close = std::min<uint32_t>(close_line, static_cast<uint32_t>(source.size()));
+        edits.push_back({"open-comment", indent, 0, "/*"});
+        edits.push_back({"close-comment", close + 2, 0, "*/"});
+        edits.push_back({"undo", close + 2, 2, ""});
+        edits.push_back({"undo", indent, 2, ""});
+
+        edits.push_back({"open-string", value, 0, "\""});
+        edits.push_back({"close-string", end + 1, 0, "\""});
+        edits.push_back({"undo", end + 1, 1, ""});
+        edits.push_back({"undo", value, 1, ""});
+    }
+    return edits;
+}
+
+static double percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(fraction * (values.size() - 1))];
+}
+
+int main(int argc, char **argv) {
+    double megabytes = 10;
+    int rounds = 50;
+    uint64_t seed = 1;
+    bool json = false;
+    std::string file_path, trace_path, record_path;
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--megabytes") == 0 && has_value) {
+            megabytes = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--rounds") == 0 && has_value) {
+            rounds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--file") == 0 && has_value) {
+            file_path = argv[++i];
+        } else if (strcmp(argv[i], "--trace") == 0 && has_value) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--record") == 0 && has_value) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::string source;
+    std::vector<Edit> edits;
+    if (!trace_path.empty()) {
+        if (file_path.empty() || !read_file(file_path, &source) || !read_trace(trace_path, &edits)) {
+            fprintf(stderr, "cannot read the file and trace\n");
+            return EXIT_FAILURE;
+        }
+    } else {
+        CorpusOptions options;
+        options.seed = seed;
+        options.target_bytes = static_cast<size_t>(megabytes * 1e6);
+        source = CorpusGenerator(options).document();
+        edits = synthesize(source, rounds, seed);
+        if (!record_path.empty() && !write_trace(record_path, edits)) {
+            fprintf(stderr, "cannot write %s\n", record_path.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    Parser parser;
+    Clock::time_point start = Clock::now();
+    Tree tree = parser.parse(source);
+    double full_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::map<std::string, std::vector<Sample>> samples;
+    for (const Edit &edit : edits) {
+        if (edit.start > source.size() || edit.deleted > source.size() - edit.start) {
+            fprintf(stderr, "edit outside the document at byte %u\n", edit.start);
+            return EXIT_FAILURE;
+        }
+        TSInputEdit input;
+        input.start_byte = edit.start;
+        input.old_end_byte = edit.start + edit.deleted;
+        input.new_end_byte = edit.start + static_cast<uint32_t>(edit.inserted.size());
+        input.start_point = point_at(source, input.start_byte);
+        input.old_end_point = point_at(source, input.old_end_byte);
+        source.replace(edit.start, edit.deleted, edit.inserted);
+        input.new_end_point = point_at(source, input.new_end_byte);
+
+        start = Clock::now();
+        ts_tree_edit(tree.get(), &input);
+        Tree new_tree = parser.parse(source, tree.get());
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        uint32_t range_count = 0;
+        TSRange *ranges = ts_tree_get_changed_ranges(tree.get(), new_tree.get(), &range_count);
+        size_t changed = 0;
+        for (uint32_t i = 0; i < range_count; i++) changed += ranges[i].end_byte - ranges[i].start_byte;
+        free(ranges);
+
+        samples[edit.kind].push_back({seconds, changed});
+        tree = std::move(new_tree);
+    }
+
+    if (json) {
+        printf("{\"bytes\":%zu,\"edits\":%zu,\"full_parse_seconds\":%.6f,\"kinds\":[",
+               source.size(), edits.size(), full_seconds);
+    } else {
+        printf("input: %.1f MB, full parse %.1f ms, %zu edits\n", source.size() / 1e6,
+               full_seconds * 1e3, edits.size());
+        printf("%-14s %6s %9s %9s %9s %14s %14s\n", "edit", "count", "p50 ms", "p99 ms", "max ms",
+               "mean changed", "max changed");
+    }
+    bool first = true;
+    for (const auto &entry : samples) {
+        std::vector<double> latencies;
+        size_t total_changed = 0, max_changed = 0;
+        for (const Sample &sample : entry.second) {
+            latencies.push_back(sample.seconds);
+            total_changed += sample.changed_bytes;
+            max_changed = std::max(max_changed, sample.changed_bytes);
+        }
+        double mean_changed = double(total_changed) / entry.second.size();
+        if (json) {
+            printf("%s{\"kind\":\"%s\",\"count\":%zu,\"p50_ms\":%.4f,\"p99_ms\":%.4f,"
+                   "\"max_ms\":%.4f,\"mean_changed_bytes\":%.0f,\"max_changed_bytes\":%zu}",
+                   first ? "" : ",", entry.first.c_str(), entry.second.size(),
+                   percentile(latencies, 0.5) * 1e3, percentile(latencies, 0.99) * 1e3,
+                   percentile(latencies, 1.0) * 1e3, mean_changed, max_changed);
+        } else {
+            printf("%-14s %6zu %9.3f %9.3f %9.3f %14.0f %14zu\n", entry.first.c_str(),
+                   entry.second.size(), percentile(latencies, 0.5) * 1e3,
+                   percentile(latencies, 0.99) * 1e3, percentile(latencies, 1.0) * 1e3,
+                   mean_changed, max_changed);
+        }
+        first = false;
+    }
+    if (json) printf("]}\n");
+    return EXIT_SUCCESS;
+}
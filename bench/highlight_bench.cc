@@ -0,0 +1,66 @@
+// Measures the latency of single-character edits in the middle of a large
+// document through Highlighter, against highlighting the whole buffer again.
+//
+// Usage: objecttext-bench-highlight [megabytes] [edits]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "objecttext/highlighter.h"
+#include "synthetic.h"
+
+using namespace objecttext;
+using Clock = std::chrono::steady_clock;
+
+static double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static double percentile(std::vector<double> samples, double fraction) {
+    if (samples.empty()) return 0;
+    std::sort(samples.begin(), samples.end());
+    size_t index = static_cast<size_t>(fraction * (samples.size() - 1));
+    return samples[index];
+}
+
+int main(int argc, char **argv) {
+    double megabytes = argc > 1 ? atof(argv[1]) : 10;
+    int edits = argc > 2 ? atoi(argv[2]) : 200;
+
+    std::string source = synthetic_ship_parts(static_cast<size_t>(megabytes * 1000));
+    Highlighter highlighter;
+    Clock::time_point start = Clock::now();
+    highlighter.reset(source);
+    double full_seconds = seconds_since(start);
+    printf("input: %.1f MB, %zu lines, full highlight %.1f ms\n",
+           source.size() / 1e6, highlighter.lines().size(), full_seconds * 1e3);
+
+    // Type a digit into a `Cost` value near the middle, then delete it again.
+    std::vector<double> latencies;
+    size_t rows_changed = 0;
+    size_t position = source.find("Cost = ", source.size() / 2);
+    if (position == std::string::npos) {
+        fprintf(stderr, "no Cost assignment in the middle of the input\n");
+        return EXIT_FAILURE;
+    }
+    uint32_t offset = static_cast<uint32_t>(position + 7);
+    for (int i = 0; i < edits; i++) {
+        start = Clock::now();
+        auto diffs = (i % 2 == 0)
+            ? highlighter.edit(offset, offset, "7")
+            : highlighter.edit(offset, offset + 1, "");
+        latencies.push_back(seconds_since(start));
+        for (const HighlightDiff &diff : diffs) rows_changed += diff.lines.size();
+    }
+
+    printf("edits: %d, p50 %.3f ms, p99 %.3f ms, max %.3f ms\n", edits,
+           percentile(latencies, 0.5) * 1e3, percentile(latencies, 0.99) * 1e3,
+           percentile(latencies, 1.0) * 1e3);
+    printf("rows re-highlighted per edit: %.1f\n", edits ? double(rows_changed) / edits : 0.0);
+    printf("speedup over full highlight at p50: %.0fx\n", full_seconds / percentile(latencies, 0.5));
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,268 @@
+// Parse throughput over synthetic rules and localization corpora, or over
+// the given files.
+//
+// Usage: objecttext-bench-parse [--megabytes M] [--files N] [--repeat R]
+//                               [--seed S] [--label L] [--json]
+//                               [--metrics FILE] [file...]
+//
+// Reports MB/s and nodes/s (best of |R| runs), tree memory per node and the
+// peak RSS of the process. With --json a single JSON object is printed
+// instead, for comparing commits. Tree memory comes from the counting hooks
+// in a -DOBJECTTEXT_COUNT_ALLOCATIONS=ON build and from the RSS growth
+// while the trees are alive otherwise. In a -DOBJECTTEXT_PROFILE_LEXER=ON
+// build the lexer profile of the run follows the results (on stderr with
+// --json). --metrics writes the parse metrics of the whole run in the
+// Prometheus text format.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#ifdef OBJECTTEXT_COUNT_ALLOCATIONS
+#include <tree_sitter/tree-sitter-objecttext-alloc.h>
+#endif
+#ifdef OBJECTTEXT_PROFILE_LEXER
+#include <tree_sitter/tree-sitter-objecttext-profile.h>
+#endif
+
+#include "corpus.h"
+#include "objecttext/metrics.h"
+#include "objecttext/parse_metrics.h"
+#include "objecttext/parser.h"
+
+using namespace objecttext;
+using Clock = std::chrono::steady_clock;
+
+static double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static size_t peak_rss_bytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+// Bytes of tree-sitter memory currently live, or 0 if unknown.
+static size_t live_bytes() {
+#ifdef OBJECTTEXT_COUNT_ALLOCATIONS
+    TSObjecttextAllocStats stats;
+    tree_sitter_objecttext_alloc_stats_get(&stats);
+    return stats.current_bytes > 0 ? static_cast<size_t>(stats.current_bytes) : 0;
+#elif defined(__linux__)
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (!file) return 0;
+    unsigned long size = 0, resident = 0;
+    int fields = fscanf(file, "%lu %lu", &size, &resident);
+    fclose(file);
+    return fields == 2 ? resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+    return 0;
+#endif
+}
+
+static size_t count_nodes(TSNode root) {
+    size_t count = 0;
+    TSTreeCursor cursor = ts_tree_cursor_new(root);
+    for (;;) {
+        count++;
+        if (ts_tree_cursor_goto_first_child(&cursor)) continue;
+        while (!ts_tree_cursor_goto_next_sibling(&cursor)) {
+            if (!ts_tree_cursor_goto_parent(&cursor)) {
+                ts_tree_cursor_delete(&cursor);
+                return count;
+            }
+        }
+    }
+}
+
+struct Corpus {
+    std::string name;
+    std::vector<std::string> sources;
+};
+
+struct Result {
+    std::string name;
+    size_t files = 0;
+    size_t bytes = 0;
+    size_t nodes = 0;
+    size_t files_with_errors = 0;
+    size_t tree_bytes = 0;
+    double seconds = 0;
+};
+
+static Result run(Parser &parser, const Corpus &corpus, int repeat) {
+    Result result;
+    result.name = corpus.name;
+    result.files = corpus.sources.size();
+
+    // One untimed pass that keeps every tree alive, to count nodes and
+    // measure what the trees cost.
+    {
+        size_t before = live_bytes();
+        std::vector<Tree> trees;
+        for (const std::string &source : corpus.sources) {
+            trees.push_back(parser.parse(source));
+            TSNode root = ts_tree_root_node(trees.back().get());
+            result.bytes += source.size();
+            result.nodes += count_nodes(root);
+            if (ts_node_has_error(root)) result.files_with_errors++;
+        }
+        size_t after = live_bytes();
+        result.tree_bytes = after > before ? after - before : 0;
+    }
+
+    for (int i = 0; i < repeat; i++) {
+        Clock::time_point start = Clock::now();
+        for (const std::string &source : corpus.sources) parser.parse(source);
+        double seconds = seconds_since(start);
+        if (i == 0 || seconds < result.seconds) result.seconds = seconds;
+    }
+    return result;
+}
+
+static std::string json_string(const std::string &text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+            continue;
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+int main(int argc, char **argv) {
+#ifdef OBJECTTEXT_COUNT_ALLOCATIONS
+    tree_sitter_objecttext_alloc_stats_install();
+#endif
+    double megabytes = 20;
+    int files = 20;
+    int repeat = 3;
+    uint64_t seed = 1;
+    bool json = false;
+    std::string label;
+    std::string metrics;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--megabytes") == 0 && has_value) {
+            megabytes = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--files") == 0 && has_value) {
+            files = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--repeat") == 0 && has_value) {
+            repeat = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--label") == 0 && has_value) {
+            label = argv[++i];
+        } else if (strcmp(argv[i], "--metrics") == 0 && has_value) {
+            metrics = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else {
+            paths.emplace_back(argv[i]);
+        }
+    }
+    if (files < 1) files = 1;
+    if (repeat < 1) repeat = 1;
+
+    std::vector<Corpus> corpora;
+    if (paths.empty()) {
+        for (CorpusKind kind : {CorpusKind::Rules, CorpusKind::Localization}) {
+            Corpus corpus;
+            corpus.name = corpus_kind_name(kind);
+            for (int i = 0; i < files; i++) {
+                CorpusOptions options;
+                options.kind = kind;
+                options.seed = seed + static_cast<uint64_t>(i);
+                options.target_bytes = static_cast<size_t>(megabytes * 1e6 / files);
+                corpus.sources.push_back(CorpusGenerator(options).document());
+            }
+            corpora.push_back(std::move(corpus));
+        }
+    } else {
+        Corpus corpus;
+        corpus.name = "files";
+        for (const std::string &path : paths) {
+            std::string source;
+            if (!read_file(path, &source)) {
+                fprintf(stderr, "cannot read %s\n", path.c_str());
+                return EXIT_FAILURE;
+            }
+            corpus.sources.push_back(std::move(source));
+        }
+        corpora.push_back(std::move(corpus));
+    }
+
+    Parser parser;
+    std::vector<Result> results;
+    if (!metrics.empty()) enable_parse_metrics();
+    for (const Corpus &corpus : corpora) results.push_back(run(parser, corpus, repeat));
+    size_t peak_rss = peak_rss_bytes();
+    if (!metrics.empty() && !MetricsRegistry::global().write(metrics)) {
+        fprintf(stderr, "cannot write %s\n", metrics.c_str());
+        return EXIT_FAILURE;
+    }
+
+    if (json) {
+        printf("{\"label\":%s,\"repeat\":%d,\"peak_rss_bytes\":%zu,\"corpora\":[",
+               json_string(label).c_str(), repeat, peak_rss);
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result &result = results[i];
+            printf("%s{\"name\":%s,\"files\":%zu,\"bytes\":%zu,\"nodes\":%zu,"
+                   "\"files_with_errors\":%zu,\"seconds\":%.6f,\"mb_per_s\":%.3f,"
+                   "\"nodes_per_s\":%.0f,\"bytes_per_node\":%.2f}",
+                   i ? "," : "", json_string(result.name).c_str(), result.files, result.bytes,
+                   result.nodes, result.files_with_errors, result.seconds,
+                   result.bytes / 1e6 / result.seconds, result.nodes / result.seconds,
+                   result.nodes ? double(result.tree_bytes) / result.nodes : 0.0);
+        }
+        printf("]}\n");
+#ifdef OBJECTTEXT_PROFILE_LEXER
+        tree_sitter_objecttext_profile_report(stderr);
+#endif
+        return EXIT_SUCCESS;
+    }
+
+    printf("%-13s %6s %9s %11s %9s %12s %10s %7s\n", "corpus", "files", "MB", "nodes", "MB/s",
+           "nodes/s", "bytes/node", "errors");
+    for (const Result &result : results) {
+        printf("%-13s %6zu %9.1f %11zu %9.1f %12.0f %10.1f %7zu\n", result.name.c_str(),
+               result.files, result.bytes / 1e6, result.nodes, result.bytes / 1e6 / result.seconds,
+               result.nodes / result.seconds,
+               result.nodes ? double(result.tree_bytes) / result.nodes : 0.0,
+               result.files_with_errors);
+    }
+    printf("peak RSS: %.1f MB\n", peak_rss / 1e6);
+#ifdef OBJECTTEXT_PROFILE_LEXER
+    printf("\n");
+    tree_sitter_objecttext_profile_report(stdout);
+#endif
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,143 @@
+// Compares PathMatcher with the equivalent tree-sitter query.
+//
+// Usage: objecttext-bench-path-query [--threads N] [file...]
+//
+// Without files a synthetic ship parts document is generated in memory. With
+// files, they are additionally queried through match_files() to measure the
+// parallel read/parse/match pipeline. With OBJECTTEXT_TRACE=FILE that
+// pipeline is recorded as a Chrome trace.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "objecttext/parser.h"
+#include "objecttext/path_match.h"
+#include "objecttext/trace.h"
+#include "synthetic.h"
+
+using namespace objecttext;
+using Clock = std::chrono::steady_clock;
+
+static const char PATH_QUERY[] = "Root/Parts/*/Components/*/Cost";
+
+static const char SCM_QUERY[] =
+    "(group (identifier) @root\n"
+    "  (group (identifier) @parts\n"
+    "    (group\n"
+    "      (group (identifier) @components\n"
+    "        (group\n"
+    "          (assignment (identifier) @key) @match))))\n"
+    "  (#eq? @root \"Root\")\n"
+    "  (#eq? @parts \"Parts\")\n"
+    "  (#eq? @components \"Components\")\n"
+    "  (#eq? @key \"Cost\"))\n";
+
+static double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Evaluates the `#eq? @capture "string"` predicates that the C API leaves
+// to its callers, the way language bindings do.
+static bool eq_predicates_hold(const TSQuery *query, const TSQueryMatch &match,
+                               std::string_view source) {
+    uint32_t step_count = 0;
+    const TSQueryPredicateStep *steps =
+        ts_query_predicates_for_pattern(query, match.pattern_index, &step_count);
+    // The query only uses `#eq?` with a capture and a string, so every
+    // predicate is four steps: name, capture, string, done.
+    for (uint32_t i = 0; i + 4 <= step_count; i += 4) {
+        uint32_t capture_id = steps[i + 1].value_id;
+        uint32_t length = 0;
+        const char *expected = ts_query_string_value_for_id(query, steps[i + 2].value_id, &length);
+        for (uint16_t c = 0; c < match.capture_count; c++) {
+            if (match.captures[c].index != capture_id) continue;
+            if (node_text(match.captures[c].node, source) != std::string_view(expected, length)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    unsigned threads = 0;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = static_cast<unsigned>(atoi(argv[++i]));
+        } else {
+            paths.emplace_back(argv[i]);
+        }
+    }
+
+    std::string source = synthetic_ship_parts(20000);
+    Parser parser;
+    Clock::time_point start = Clock::now();
+    Tree tree = parser.parse(source);
+    double parse_seconds = seconds_since(start);
+    TSNode root = ts_tree_root_node(tree.get());
+    printf("input: %.1f MB, parsed in %.3f s\n", source.size() / 1e6, parse_seconds);
+
+    auto path_query = PathQuery::compile(PATH_QUERY);
+    if (!path_query) {
+        fprintf(stderr, "invalid path query\n");
+        return EXIT_FAILURE;
+    }
+    uint32_t error_offset = 0;
+    TSQueryError error_type = TSQueryErrorNone;
+    TSQuery *scm_query = ts_query_new(tree_sitter_objecttext(), SCM_QUERY,
+                                      static_cast<uint32_t>(strlen(SCM_QUERY)),
+                                      &error_offset, &error_type);
+    if (!scm_query) {
+        fprintf(stderr, "invalid scm query at offset %u\n", error_offset);
+        return EXIT_FAILURE;
+    }
+
+    const int iterations = 10;
+    size_t path_matches = 0;
+    PathMatcher matcher(*path_query);
+    start = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        path_matches = matcher.run(root, source, [](TSNode) {});
+    }
+    double path_seconds = seconds_since(start) / iterations;
+
+    size_t scm_matches = 0;
+    TSQueryCursor *cursor = ts_query_cursor_new();
+    start = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        scm_matches = 0;
+        ts_query_cursor_exec(cursor, scm_query, root);
+        TSQueryMatch match;
+        while (ts_query_cursor_next_match(cursor, &match)) {
+            if (eq_predicates_hold(scm_query, match, source)) scm_matches++;
+        }
+    }
+    double scm_seconds = seconds_since(start) / iterations;
+    ts_query_cursor_delete(cursor);
+    ts_query_delete(scm_query);
+
+    printf("path query: %8.3f ms, %zu matches\n", path_seconds * 1e3, path_matches);
+    printf("scm query:  %8.3f ms, %zu matches\n", scm_seconds * 1e3, scm_matches);
+    printf("speedup:    %8.1fx\n", scm_seconds / path_seconds);
+    if (path_matches != scm_matches) {
+        fprintf(stderr, "match counts differ\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!paths.empty()) {
+        bool traced = start_tracing_from_environment();
+        start = Clock::now();
+        std::vector<FileMatches> results = match_files(*path_query, paths, threads);
+        double files_seconds = seconds_since(start);
+        if (traced && !stop_tracing()) fprintf(stderr, "cannot write the trace\n");
+        size_t total = 0;
+        for (const FileMatches &result : results) total += result.matches.size();
+        printf("files:      %8.3f s, %zu files, %zu matches\n", files_seconds, results.size(), total);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,203 @@
+// Error-recovery cost over systematically broken rules corpora.
+//
+// Usage: objecttext-bench-recovery [--kilobytes K] [--breaks N] [--repeat R]
+//                                  [--seed S] [--threads T] [--json]
+//
+// A generated rules document is broken |N| times in one way per row, each
+// time by inserting a bad line before a random line: an unterminated
+// string, a stray `..` identifier, a block that is never closed, an extra
+// closing bracket, an unterminated block comment or an assignment without a
+// value. Every row reports the plain parse (best of |R|) and its slowdown
+// against the valid document, then SplitDocument::recover(): its time and
+// the share of the input that ended up in slices without errors.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "corpus.h"
+#include "objecttext/parser.h"
+#include "objecttext/split.h"
+
+using namespace objecttext;
+using Clock = std::chrono::steady_clock;
+
+static double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct Breakage {
+    const char *name;
+    const char *line; // inserted with the indentation of the line it precedes
+};
+
+static const Breakage kBreakages[] = {
+    {"valid", nullptr},
+    {"unterminated-string", "Description = \"never closed"},
+    {"stray-dots", "..Stray = 1"},
+    {"unclosed-block", "Broken\n{"},
+    {"extra-bracket", "}"},
+    {"unclosed-comment", "/* never closed"},
+    {"missing-value", "Cost ="},
+};
+
+// Inserts |breakage| before |count| random lines of |source|.
+static std::string break_document(const std::string &source, const Breakage &breakage,
+                                  int count, uint64_t seed) {
+    std::vector<size_t> lines;
+    for (size_t line = source.find('\n'); line != std::string::npos; line = source.find('\n', line + 1)) {
+        if (line + 1 < source.size()) lines.push_back(line + 1);
+    }
+    if (!breakage.line || lines.empty()) return source;
+
+    uint64_t state = seed * 0x9E3779B97F4A7C15ull + 1;
+    std::vector<size_t> chosen;
+    for (int i = 0; i < count; i++) {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        chosen.push_back(lines[(state * 0x2545F4914F6CDD1Dull) % lines.size()]);
+    }
+    std::sort(chosen.begin(), chosen.end());
+
+    std::string out;
+    out.reserve(source.size() + count * 32);
+    size_t copied = 0;
+    for (size_t start : chosen) {
+        out.append(source, copied, start - copied);
+        std::string indent = source.substr(start, source.find_first_not_of(" \t", start) - start);
+        for (const char *text = breakage.line; *text;) {
+            const char *end = strchr(text, '\n');
+            size_t length = end ? size_t(end - text) : strlen(text);
+            out += indent;
+            out.append(text, length);
+            out += '\n';
+            text += length + (end ? 1 : 0);
+        }
+        copied = start;
+    }
+    out.append(source, copied, std::string::npos);
+    return out;
+}
+
+struct Row {
+    const char *name;
+    size_t bytes = 0;
+    size_t error_nodes = 0;
+    double parse_seconds = 0;
+    double recover_seconds = 0;
+    size_t slices = 0;
+    size_t abandoned = 0;
+    size_t clean_bytes = 0;
+};
+
+static size_t count_errors(TSNode root) {
+    size_t count = 0;
+    TSTreeCursor cursor = ts_tree_cursor_new(root);
+    for (;;) {
+        TSNode node = ts_tree_cursor_current_node(&cursor);
+        if (ts_node_is_error(node) || ts_node_is_missing(node)) count++;
+        if (ts_node_has_error(node) && ts_tree_cursor_goto_first_child(&cursor)) continue;
+        while (!ts_tree_cursor_goto_next_sibling(&cursor)) {
+            if (!ts_tree_cursor_goto_parent(&cursor)) {
+                ts_tree_cursor_delete(&cursor);
+                return count;
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    double kilobytes = 2000;
+    int breaks = 10;
+    int repeat = 3;
+    uint64_t seed = 1;
+    unsigned threads = 1;
+    bool json = false;
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--kilobytes") == 0 && has_value) {
+            kilobytes = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--breaks") == 0 && has_value) {
+            breaks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--repeat") == 0 && has_value) {
+            repeat = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && has_value) {
+            threads = static_cast<unsigned>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else {
+            fprintf(stderr, "unknown argument %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (repeat < 1) repeat = 1;
+
+    CorpusOptions options;
+    options.seed = seed;
+    options.target_bytes = static_cast<size_t>(kilobytes * 1000);
+    const std::string valid = CorpusGenerator(options).document();
+
+    RecoveryOptions recovery;
+    recovery.threads = threads;
+    Parser parser;
+    std::vector<Row> rows;
+    for (const Breakage &breakage : kBreakages) {
+        std::string source = break_document(valid, breakage, breaks, seed);
+        Row row;
+        row.name = breakage.name;
+        row.bytes = source.size();
+        for (int i = 0; i < repeat; i++) {
+            Clock::time_point start = Clock::now();
+            Tree tree = parser.parse(source);
+            double seconds = seconds_since(start);
+            if (i == 0 || seconds < row.parse_seconds) row.parse_seconds = seconds;
+            if (i == 0) row.error_nodes = count_errors(ts_tree_root_node(tree.get()));
+        }
+
+        Clock::time_point start = Clock::now();
+        SplitDocument document = SplitDocument::recover(source, recovery);
+        row.recover_seconds = seconds_since(start);
+        row.slices = document.chunks().size();
+        for (const SplitChunk &chunk : document.chunks()) {
+            if (!chunk.tree) {
+                row.abandoned++;
+            } else if (!ts_node_has_error(ts_tree_root_node(chunk.tree.get()))) {
+                row.clean_bytes += chunk.body().end_byte - chunk.body().start_byte;
+            }
+        }
+        rows.push_back(row);
+    }
+
+    const double baseline = rows[0].parse_seconds / rows[0].bytes;
+    if (json) {
+        printf("{\"breaks\":%d,\"repeat\":%d,\"rows\":[", breaks, repeat);
+        for (size_t i = 0; i < rows.size(); i++) {
+            const Row &row = rows[i];
+            printf("%s{\"name\":\"%s\",\"bytes\":%zu,\"error_nodes\":%zu,\"parse_seconds\":%.6f,"
+                   "\"slowdown\":%.3f,\"recover_seconds\":%.6f,\"slices\":%zu,\"abandoned\":%zu,"
+                   "\"clean_fraction\":%.4f}",
+                   i ? "," : "", row.name, row.bytes, row.error_nodes, row.parse_seconds,
+                   row.parse_seconds / row.bytes / baseline, row.recover_seconds, row.slices,
+                   row.abandoned, double(row.clean_bytes) / row.bytes);
+        }
+        printf("]}\n");
+        return EXIT_SUCCESS;
+    }
+
+    printf("%-20s %9s %7s %9s %8s %10s %7s %9s %7s\n", "breakage", "KB", "errors", "parse ms",
+           "slowdown", "recover ms", "slices", "abandoned", "clean");
+    for (const Row &row : rows) {
+        printf("%-20s %9.1f %7zu %9.2f %7.2fx %10.2f %7zu %9zu %6.1f%%\n", row.name, row.bytes / 1e3,
+               row.error_nodes, row.parse_seconds * 1e3, row.parse_seconds / row.bytes / baseline,
+               row.recover_seconds * 1e3, row.slices, row.abandoned,
+               100.0 * row.clean_bytes / row.bytes);
+    }
+    return EXIT_SUCCESS;
+}
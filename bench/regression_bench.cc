@@ -0,0 +1,78 @@
+// Replays the performance regression corpus in fuzz/regressions, or the
+// given files, and fails if any of them is over the parse budget of the
+// fuzzer.
+//
+// Usage: objecttext-bench-regressions [file or directory...]
+//
+// Peak bytes are only checked in a -DOBJECTTEXT_COUNT_ALLOCATIONS=ON build.
+// The budgets can be tightened with OBJECTTEXT_BUDGET_NS_PER_BYTE and
+// OBJECTTEXT_BUDGET_BYTES_PER_BYTE.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "parse_budget.h"
+
+using namespace objecttext;
+
+int main(int argc, char **argv) {
+#ifdef OBJECTTEXT_COUNT_ALLOCATIONS
+    tree_sitter_objecttext_alloc_stats_install();
+#endif
+    std::vector<std::string> roots(argv + 1, argv + argc);
+    if (roots.empty()) roots.push_back(OBJECTTEXT_REGRESSIONS_DIR);
+
+    std::vector<std::string> paths;
+    for (const std::string &root : roots) {
+        std::error_code error;
+        if (std::filesystem::is_directory(root, error)) {
+            for (const auto &entry : std::filesystem::directory_iterator(root, error)) {
+                if (entry.is_regular_file()) paths.push_back(entry.path().string());
+            }
+        } else {
+            paths.push_back(root);
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    if (paths.empty()) {
+        fprintf(stderr, "no inputs\n");
+        return EXIT_FAILURE;
+    }
+
+    ParseBudget budget = ParseBudget::from_environment();
+    Parser parser;
+    int failures = 0;
+    printf("%-36s %9s %10s %12s\n", "input", "bytes", "ns/byte", "peak B/byte");
+    for (const std::string &path : paths) {
+        std::string source;
+        if (!read_file(path, &source)) {
+            fprintf(stderr, "cannot read %s\n", path.c_str());
+            failures++;
+            continue;
+        }
+        // Best of three, so that one descheduled run is not a regression.
+        ParseCost cost = measure_parse(parser, source);
+        for (int i = 0; i < 2; i++) cost.seconds = std::min(cost.seconds, measure_parse(parser, source).seconds);
+
+        size_t bytes = std::max<size_t>(source.size(), 1);
+        std::string name = std::filesystem::path(path).filename().string();
+        printf("%-36s %9zu %10.1f", name.c_str(), source.size(), cost.seconds * 1e9 / bytes);
+        if (cost.peak_bytes >= 0) {
+            printf(" %12.1f", double(cost.peak_bytes) / bytes);
+        } else {
+            printf(" %12s", "-");
+        }
+        std::string reason;
+        if (!within_budget(budget, cost, source.size(), &reason)) {
+            printf("  OVER BUDGET: %s", reason.c_str());
+            failures++;
+        }
+        printf("\n");
+    }
+    if (failures) fprintf(stderr, "%d input(s) over budget\n", failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,71 @@
+// Measures SplitDocument::parse on a large synthetic document at increasing
+// thread counts, against a single TSParser over the whole buffer.
+//
+// Usage: objecttext-bench-split [megabytes] [max-threads]
+//
+// With OBJECTTEXT_TRACE=FILE the split parses are recorded as a Chrome trace.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "objecttext/parallel.h"
+#include "objecttext/parser.h"
+#include "objecttext/path_match.h"
+#include "objecttext/split.h"
+#include "objecttext/trace.h"
+#include "synthetic.h"
+
+using namespace objecttext;
+using Clock = std::chrono::steady_clock;
+
+static double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main(int argc, char **argv) {
+    double megabytes = argc > 1 ? atof(argv[1]) : 100;
+    unsigned max_threads = argc > 2 ? static_cast<unsigned>(atoi(argv[2])) : default_threads();
+
+    std::string source = synthetic_ship_parts(static_cast<size_t>(megabytes * 1000));
+    auto query = PathQuery::compile("Root/Parts/*/Components/*/Cost");
+    if (!query) {
+        fprintf(stderr, "invalid path query\n");
+        return EXIT_FAILURE;
+    }
+
+    Parser parser;
+    Clock::time_point start = Clock::now();
+    Tree tree = parser.parse(source);
+    double single_seconds = seconds_since(start);
+    PathMatcher matcher(*query);
+    size_t expected = matcher.run(ts_tree_root_node(tree.get()), source, [](TSNode) {});
+    tree.reset();
+    printf("input: %.1f MB, one parser: %.3f s (%.1f MB/s), %zu matches\n",
+           source.size() / 1e6, single_seconds, source.size() / 1e6 / single_seconds, expected);
+
+    std::vector<unsigned> thread_counts;
+    for (unsigned threads = 1; threads < max_threads; threads *= 2) thread_counts.push_back(threads);
+    thread_counts.push_back(max_threads);
+
+    bool traced = start_tracing_from_environment();
+    for (unsigned threads : thread_counts) {
+        SplitOptions options;
+        options.threads = threads;
+        start = Clock::now();
+        SplitDocument document = SplitDocument::parse(source, options);
+        double seconds = seconds_since(start);
+        size_t matches = document.match(*query, threads).size();
+        printf("threads %2u: %.3f s (%.1f MB/s, %.2fx), %zu chunks%s\n", threads, seconds,
+               source.size() / 1e6 / seconds, single_seconds / seconds, document.chunks().size(),
+               document.has_error() ? ", has errors" : "");
+        if (matches != expected) {
+            fprintf(stderr, "split document found %zu matches\n", matches);
+            return EXIT_FAILURE;
+        }
+    }
+    if (traced && !stop_tracing()) fprintf(stderr, "cannot write the trace\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,42 @@
+// Measures StructureIndex::build throughput on a generated document.
+//
+// Usage: objecttext-bench-structure [megabytes]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "objecttext/structure.h"
+#include "synthetic.h"
+
+using namespace objecttext;
+using Clock = std::chrono::steady_clock;
+
+static double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main(int argc, char **argv) {
+    double megabytes = argc > 1 ? atof(argv[1]) : 100;
+    std::string source = synthetic_ship_parts(static_cast<size_t>(megabytes * 1000));
+
+    const int iterations = 5;
+    size_t blocks = 0;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        StructureIndex index = StructureIndex::build(source);
+        blocks = index.blocks().size();
+    }
+    double build_seconds = seconds_since(start) / iterations;
+
+    size_t lines = 0;
+    start = Clock::now();
+    for (int i = 0; i < iterations; i++) lines = count_newlines(source);
+    double newline_seconds = seconds_since(start) / iterations;
+
+    printf("input: %.1f MB, %zu lines, %zu blocks\n", source.size() / 1e6, lines + 1, blocks);
+    printf("structure index: %6.2f GB/s\n", source.size() / build_seconds / 1e9);
+    printf("newline count:   %6.2f GB/s\n", source.size() / newline_seconds / 1e9);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,32 @@
+#ifndef OBJECTTEXT_BENCH_SYNTHETIC_H_
+#define OBJECTTEXT_BENCH_SYNTHETIC_H_
+
+#include <string>
+
+// A single `Root` group holding |parts| parts with sprites and components,
+// roughly 1 KB of text per part.
+inline std::string synthetic_ship_parts(size_t parts) {
+    std::string out = "Root\n{\n    Parts\n    {\n";
+    for (size_t part = 0; part < parts; part++) {
+        out += "        Part" + std::to_string(part) + "\n        {\n";
+        out += "            Type = Thruster\n";
+        out += "            Mass = " + std::to_string(part % 97) + ".5\n";
+        out += "            Sprites\n            [\n";
+        for (int sprite = 0; sprite < 4; sprite++) {
+            out += "                {\n                    File = \"sprite" +
+                   std::to_string(sprite) + ".png\"\n                }\n";
+        }
+        out += "            ]\n            Components\n            {\n";
+        for (int component = 0; component < 6; component++) {
+            out += "                Component" + std::to_string(component) + "\n                {\n";
+            out += "                    Cost = " + std::to_string(part * 7 % 300) + "\n";
+            out += "                    Power = " + std::to_string(component * 3) + "%\n";
+            out += "                }\n";
+        }
+        out += "            }\n        }\n";
+    }
+    out += "    }\n}\n";
+    return out;
+}
+
+#endif // OBJECTTEXT_BENCH_SYNTHETIC_H_
@@ -0,0 +1,171 @@
+// Native toJSON() against a JavaScript tree walk.
+//
+// Usage: node bench/to_json_bench.js <corpus directory> [--megabytes M]
+//                                    [--repeat R] [--json]
+//
+// Reads files from a corpus written by objecttext-corpus until |M| MB
+// (default 50) are loaded, e.g. after
+//
+//   objecttext-corpus /tmp/corpus --files 100 --kilobytes 512 --kind rules
+//
+// and converts every file to a JSON string three ways, keeping the best of
+// |R| rounds: a parse alone with node-tree-sitter, as a floor for the walk;
+// that parse plus a walk with a TreeCursor that builds an object per entry,
+// then JSON.stringify(); and the addon's toJSON(), which parses, walks and
+// writes in C++ and returns one string.
+
+const fs = require("node:fs");
+const path = require("node:path");
+
+const Parser = require("tree-sitter");
+const language = require("../bindings/node");
+
+function parseArgs(argv) {
+  const options = { directory: null, megabytes: 50, repeat: 3, json: false };
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i] === "--megabytes" && i + 1 < argv.length) {
+      options.megabytes = Number(argv[++i]);
+    } else if (argv[i] === "--repeat" && i + 1 < argv.length) {
+      options.repeat = Math.max(1, Number(argv[++i]));
+    } else if (argv[i] === "--json") {
+      options.json = true;
+    } else if (!argv[i].startsWith("-") && !options.directory) {
+      options.directory = argv[i];
+    } else {
+      throw new Error(`unknown argument ${argv[i]}`);
+    }
+  }
+  if (!options.directory) throw new Error("usage: to_json_bench.js <corpus directory>");
+  return options;
+}
+
+function loadCorpus(directory, megabytes) {
+  const sources = [];
+  let bytes = 0;
+  for (const name of fs.readdirSync(directory).sort()) {
+    if (bytes >= megabytes * 1e6) break;
+    const source = fs.readFileSync(path.join(directory, name), "utf8");
+    sources.push(source);
+    bytes += Buffer.byteLength(source);
+  }
+  return { sources, bytes };
+}
+
+function unquote(text) {
+  text = text.trim();
+  if (text.startsWith('@"') && text.endsWith('"') && text.length >= 3) return text.slice(2, -1);
+  if (text.startsWith('"') && text.endsWith('"') && text.length >= 2) {
+    return text.slice(1, -1).replace(/\\"/g, '"');
+  }
+  return text;
+}
+
+function scalar(node) {
+  if (!node) return null;
+  const literal = node.namedChildCount > 0 ? node.namedChild(0) : node;
+  if (literal.type === "number") {
+    const text = literal.text.replace(/d$/, "");
+    const value = Number(text.replace(/%$/, ""));
+    if (Number.isFinite(value)) return text.endsWith("%") ? value / 100 : value;
+  }
+  return unquote(literal.text);
+}
+
+// The walk a dashboard would write: one JavaScript object per entry, keyed
+// the way toJSON() keys them.
+function walk(cursor) {
+  const node = cursor.currentNode;
+  if (node.type === "assignment") {
+    return scalar(node.children.find((child) => child.type === "value"));
+  }
+  const object = node.type !== "list";
+  const result = object ? {} : [];
+  if (!cursor.gotoFirstChild()) return result;
+  const extensions = [];
+  let index = 0;
+  do {
+    const type = cursor.nodeType;
+    if (type === "extension") {
+      const reference = cursor.currentNode.namedChild(0);
+      extensions.push(reference ? reference.text : cursor.nodeText);
+      continue;
+    }
+    if (type !== "assignment" && type !== "group" && type !== "list") continue;
+    const first = cursor.currentNode.child(0);
+    const key = first && first.type === "identifier" ? first.text : "";
+    const value = walk(cursor);
+    if (object) {
+      result[key || String(index)] = value;
+    } else {
+      result.push(key ? { [key]: value } : value);
+    }
+    index++;
+  } while (cursor.gotoNextSibling());
+  cursor.gotoParent();
+  if (object && extensions.length) return { $extends: extensions, ...result };
+  return result;
+}
+
+function jsToJSON(parse, source) {
+  return JSON.stringify(walk(parse(source).walk()));
+}
+
+function best(repeat, run) {
+  let seconds = Infinity;
+  for (let i = 0; i < repeat; i++) {
+    const start = process.hrtime.bigint();
+    run();
+    seconds = Math.min(seconds, Number(process.hrtime.bigint() - start) / 1e9);
+  }
+  return seconds;
+}
+
+function main() {
+  const options = parseArgs(process.argv.slice(2));
+  if (typeof language.toJSON !== "function") {
+    console.error("the addon was built without the tree-sitter runtime; toJSON() is unavailable");
+    process.exit(1);
+  }
+  const { sources, bytes } = loadCorpus(options.directory, options.megabytes);
+  const parser = new Parser();
+  parser.setLanguage(language);
+  // Files larger than node-tree-sitter's default buffer need an explicit one.
+  const parse = (source) =>
+    parser.parse(source, null, { bufferSize: Buffer.byteLength(source) * 2 });
+
+  if (sources.length &&
+      jsToJSON(parse, sources[0]) !== JSON.stringify(JSON.parse(language.toJSON(sources[0])))) {
+    console.error("warning: the JavaScript walk and toJSON() disagree on the first file");
+  }
+
+  const rows = [
+    ["parse only", () => sources.forEach(parse)],
+    ["js walk + stringify", () => sources.forEach((source) => jsToJSON(parse, source))],
+    ["native toJSON", () => sources.forEach((source) => language.toJSON(source))],
+  ].map(([name, run]) => ({ name, seconds: best(options.repeat, run) }));
+
+  const walkSeconds = rows[1].seconds;
+  if (options.json) {
+    console.log(JSON.stringify({
+      files: sources.length,
+      bytes,
+      repeat: options.repeat,
+      rows: rows.map((row) => ({
+        name: row.name,
+        seconds: row.seconds,
+        mb_per_second: bytes / 1e6 / row.seconds,
+        speedup: walkSeconds / row.seconds,
+      })),
+    }));
+    return;
+  }
+  console.log(`${sources.length} files, ${(bytes / 1e6).toFixed(1)} MB, best of ${options.repeat}`);
+  console.log(`${"method".padEnd(22)} ${"ms".padStart(10)} ${"MB/s".padStart(8)} ${"vs walk".padStart(8)}`);
+  for (const row of rows) {
+    console.log(`${row.name.padEnd(22)} ${(row.seconds * 1e3).toFixed(1).padStart(10)} ` +
+                `${(bytes / 1e6 / row.seconds).toFixed(1).padStart(8)} ` +
+                `${(walkSeconds / row.seconds).toFixed(2).padStart(7)}x`);
+  }
+}
+
+main();
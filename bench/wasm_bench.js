@@ -0,0 +1,144 @@
+// Parse throughput of the WebAssembly builds against the native addon.
+//
+// Usage: node bench/wasm_bench.js <corpus directory> [--megabytes M]
+//                                 [--repeat R] [--wasm FILE]... [--json]
+//
+// Reads files from a corpus written by objecttext-corpus until |M| MB
+// (default 20) are loaded and parses every file, keeping the best of |R|
+// rounds, with node-tree-sitter and the native addon and then with
+// web-tree-sitter and each wasm module: the two built by `make wasm`
+// (SIMD128 and LTO at -Oz and -O3, in .size.wasm and .speed.wasm), or the
+// modules given with --wasm, e.g. tree-sitter-objecttext.wasm from
+// `tree-sitter build --wasm` as a baseline. Needs web-tree-sitter 0.25 or
+// later, which reads ABI 15 modules:
+//
+//   make wasm && npm install --no-save web-tree-sitter
+//   node bench/wasm_bench.js /tmp/corpus --wasm tree-sitter-objecttext.wasm
+
+const fs = require("node:fs");
+const path = require("node:path");
+
+const root = path.join(__dirname, "..");
+
+function parseArgs(argv) {
+  const options = { directory: null, megabytes: 20, repeat: 3, wasm: [], json: false };
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i] === "--megabytes" && i + 1 < argv.length) {
+      options.megabytes = Number(argv[++i]);
+    } else if (argv[i] === "--repeat" && i + 1 < argv.length) {
+      options.repeat = Math.max(1, Number(argv[++i]));
+    } else if (argv[i] === "--wasm" && i + 1 < argv.length) {
+      options.wasm.push(argv[++i]);
+    } else if (argv[i] === "--json") {
+      options.json = true;
+    } else if (!argv[i].startsWith("-") && !options.directory) {
+      options.directory = argv[i];
+    } else {
+      throw new Error(`unknown argument ${argv[i]}`);
+    }
+  }
+  if (!options.directory) throw new Error("usage: wasm_bench.js <corpus directory>");
+  if (!options.wasm.length) {
+    options.wasm = ["tree-sitter-objecttext.size.wasm", "tree-sitter-objecttext.speed.wasm"]
+      .map((name) => path.join(root, name))
+      .filter((file) => fs.existsSync(file));
+    if (!options.wasm.length) throw new Error("no wasm modules; run `make wasm` first");
+  }
+  return options;
+}
+
+function loadCorpus(directory, megabytes) {
+  const sources = [];
+  let bytes = 0;
+  for (const name of fs.readdirSync(directory).sort()) {
+    if (bytes >= megabytes * 1e6) break;
+    const source = fs.readFileSync(path.join(directory, name), "utf8");
+    sources.push(source);
+    bytes += Buffer.byteLength(source);
+  }
+  return { sources, bytes };
+}
+
+function best(repeat, run) {
+  let seconds = Infinity;
+  for (let i = 0; i < repeat; i++) {
+    const start = process.hrtime.bigint();
+    run();
+    seconds = Math.min(seconds, Number(process.hrtime.bigint() - start) / 1e9);
+  }
+  return seconds;
+}
+
+function nativeParser() {
+  const Parser = require("tree-sitter");
+  const parser = new Parser();
+  parser.setLanguage(require("../bindings/node"));
+  // Files larger than node-tree-sitter's default buffer need an explicit one.
+  return (source) => parser.parse(source, null, { bufferSize: Buffer.byteLength(source) * 2 });
+}
+
+async function wasmParser(file) {
+  const { Parser, Language } = require("web-tree-sitter");
+  await Parser.init();
+  const parser = new Parser();
+  parser.setLanguage(await Language.load(fs.readFileSync(file)));
+  return parser;
+}
+
+async function main() {
+  const options = parseArgs(process.argv.slice(2));
+  const { sources, bytes } = loadCorpus(options.directory, options.megabytes);
+
+  const native = nativeParser();
+  const expected = sources.length ? native(sources[0]).rootNode.toString() : "";
+  const rows = [{ name: "native", bytes: null, seconds: best(options.repeat, () => sources.forEach(native)) }];
+
+  for (const file of options.wasm) {
+    const parser = await wasmParser(file);
+    if (sources.length) {
+      const tree = parser.parse(sources[0]);
+      if (tree.rootNode.toString() !== expected) {
+        console.error(`warning: ${path.basename(file)} and the native parser disagree on the first file`);
+      }
+      tree.delete();
+    }
+    // Trees live in the module's memory and must be freed by hand.
+    const seconds = best(options.repeat, () => {
+      for (const source of sources) parser.parse(source).delete();
+    });
+    rows.push({ name: path.basename(file), bytes: fs.statSync(file).size, seconds });
+    parser.delete();
+  }
+
+  const nativeSeconds = rows[0].seconds;
+  if (options.json) {
+    console.log(JSON.stringify({
+      files: sources.length,
+      bytes,
+      repeat: options.repeat,
+      rows: rows.map((row) => ({
+        name: row.name,
+        module_bytes: row.bytes,
+        seconds: row.seconds,
+        mb_per_second: bytes / 1e6 / row.seconds,
+        vs_native: nativeSeconds / row.seconds,
+      })),
+    }));
+    return;
+  }
+  console.log(`${sources.length} files, ${(bytes / 1e6).toFixed(1)} MB, best of ${options.repeat}`);
+  console.log(`${"parser".padEnd(36)} ${"KB".padStart(8)} ${"ms".padStart(10)} ` +
+              `${"MB/s".padStart(8)} ${"vs native".padStart(10)}`);
+  for (const row of rows) {
+    const kilobytes = row.bytes === null ? "-" : (row.bytes / 1024).toFixed(1);
+    console.log(`${row.name.padEnd(36)} ${kilobytes.padStart(8)} ` +
+                `${(row.seconds * 1e3).toFixed(1).padStart(10)} ` +
+                `${(bytes / 1e6 / row.seconds).toFixed(1).padStart(8)} ` +
+                `${(nativeSeconds / row.seconds).toFixed(2).padStart(9)}x`);
+  }
+}
+
+main().catch((error) => {
+  console.error(error.message);
+  process.exit(1);
+});
@@ -13,12 +13,43 @@
         "src/parser.c",
       ],
       "variables": {
-        "has_scanner": "<!(node -p \"fs.existsSync('src/scanner.c')\")"
+        "has_scanner": "<!(node -p \"fs.existsSync('src/scanner.c')\")",
+        "tree_sitter_lib": "<!(node bindings/node/tree_sitter_lib.js)",
       },
       "conditions": [
         ["has_scanner=='true'", {
           "sources+": ["src/scanner.c"],
         }],
+        # parseFiles(), parseFlat() and toJSON() need the runtime and the C++ API.
+        ["tree_sitter_lib!=''", {
+          "sources+": [
+            "<(tree_sitter_lib)/src/lib.c",
+            "bindings/cpp/arena.cc",
+            "bindings/cpp/flat_tree.cc",
+            "bindings/cpp/json.cc",
+            "bindings/cpp/metrics.cc",
+            "bindings/cpp/parse_metrics.cc",
+            "bindings/cpp/parser.cc",
+            "bindings/cpp/path_match.cc",
+            "bindings/cpp/path_query.cc",
+            "bindings/cpp/to_json.cc",
+            "bindings/cpp/trace.cc",
+            "bindings/cpp/value.cc",
+            "bindings/node/flat_tree.cc",
+            "bindings/node/parse_files.cc",
+            "bindings/node/to_json.cc",
+          ],
+          "include_dirs+": [
+            "<(tree_sitter_lib)/include",
+            "<(tree_sitter_lib)/src",
+            "bindings/c",
+            "bindings/cpp",
+          ],
+          "defines": ["OBJECTTEXT_WITH_RUNTIME"],
+          "cflags_cc": ["-std=c++17"],
+          "xcode_settings": {"CLANG_CXX_LANGUAGE_STANDARD": "c++17"},
+          "msvs_settings": {"VCCLCompilerTool": {"AdditionalOptions": ["/std:c++17"]}},
+        }],
         ["OS!='win'", {
           "cflags_c": [
             "-std=c11",
@@ -0,0 +1,166 @@
+#include "tree_sitter/alloc.h"
+#include "tree_sitter/tree-sitter-objecttext-alloc.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifndef TREE_SITTER_REUSE_ALLOCATOR
+#error "alloc_stats.c needs TREE_SITTER_REUSE_ALLOCATOR"
+#endif
+
+// Live bytes are measured with the allocator's own size query rather than a
+// header of our own, so blocks allocated before the hooks were installed (or
+// handed over from elsewhere) can be freed and reallocated as they are.
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#define usable_size(pointer) malloc_size(pointer)
+#elif defined(_WIN32)
+#include <malloc.h>
+#define usable_size(pointer) _msize(pointer)
+#elif defined(__FreeBSD__)
+#include <malloc_np.h>
+#define usable_size(pointer) malloc_usable_size(pointer)
+#else
+#include <malloc.h>
+#define usable_size(pointer) malloc_usable_size(pointer)
+#endif
+
+// Process-wide counters, since trees are often freed on another thread
+// than the one that parsed them.
+#ifdef _MSC_VER
+#include <intrin.h>
+typedef volatile int64_t Counter;
+
+static int64_t counter_add(Counter *counter, int64_t value) {
+  return _InterlockedExchangeAdd64(counter, value) + value;
+}
+
+static int64_t counter_load(Counter *counter) {
+  return _InterlockedCompareExchange64(counter, 0, 0);
+}
+
+static void counter_store(Counter *counter, int64_t value) {
+  _InterlockedExchange64(counter, value);
+}
+
+static bool counter_replace(Counter *counter, int64_t expected, int64_t value) {
+  return _InterlockedCompareExchange64(counter, value, expected) == expected;
+}
+#else
+#include <stdatomic.h>
+typedef _Atomic int64_t Counter;
+
+static int64_t counter_add(Counter *counter, int64_t value) {
+  return atomic_fetch_add_explicit(counter, value, memory_order_relaxed) + value;
+}
+
+static int64_t counter_load(Counter *counter) {
+  return atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+static void counter_store(Counter *counter, int64_t value) {
+  atomic_store_explicit(counter, value, memory_order_relaxed);
+}
+
+static bool counter_replace(Counter *counter, int64_t expected, int64_t value) {
+  return atomic_compare_exchange_weak_explicit(counter, &expected, value, memory_order_relaxed,
+                                               memory_order_relaxed);
+}
+#endif
+
+static struct {
+  Counter allocations;
+  Counter reallocations;
+  Counter frees;
+  Counter bytes_requested;
+  Counter current_bytes;
+  Counter peak_bytes;
+  Counter size_classes[TS_OBJECTTEXT_ALLOC_SIZE_CLASSES];
+} totals;
+
+static Counter installed;
+
+static unsigned size_class(size_t size) {
+  unsigned class_index = 0;
+  while (size > 1 && class_index + 1 < TS_OBJECTTEXT_ALLOC_SIZE_CLASSES) {
+    size >>= 1;
+    class_index++;
+  }
+  return class_index;
+}
+
+static void add_bytes(int64_t bytes) {
+  int64_t current = counter_add(&totals.current_bytes, bytes);
+  int64_t peak = counter_load(&totals.peak_bytes);
+  while (current > peak && !counter_replace(&totals.peak_bytes, peak, current)) {
+    peak = counter_load(&totals.peak_bytes);
+  }
+}
+
+static void *finish(void *block, size_t size) {
+  if (!block) return NULL;
+  counter_add(&totals.bytes_requested, (int64_t)size);
+  counter_add(&totals.size_classes[size_class(size)], 1);
+  add_bytes((int64_t)usable_size(block));
+  return block;
+}
+
+static void *counting_malloc(size_t size) {
+  counter_add(&totals.allocations, 1);
+  return finish(malloc(size), size);
+}
+
+static void *counting_calloc(size_t count, size_t size) {
+  counter_add(&totals.allocations, 1);
+  if (size && count > SIZE_MAX / size) return NULL;
+  return finish(calloc(count, size), count * size);
+}
+
+static void *counting_realloc(void *pointer, size_t size) {
+  if (!pointer) return counting_malloc(size);
+  counter_add(&totals.reallocations, 1);
+  int64_t old_size = (int64_t)usable_size(pointer);
+  void *moved = realloc(pointer, size);
+  if (!moved) return NULL;
+  add_bytes(-old_size);
+  return finish(moved, size);
+}
+
+static void counting_free(void *pointer) {
+  if (!pointer) return;
+  counter_add(&totals.frees, 1);
+  counter_add(&totals.current_bytes, -(int64_t)usable_size(pointer));
+  free(pointer);
+}
+
+bool tree_sitter_objecttext_alloc_stats_install(void) {
+  if (!counter_replace(&installed, 0, 1)) return false;
+  ts_current_malloc = counting_malloc;
+  ts_current_calloc = counting_calloc;
+  ts_current_realloc = counting_realloc;
+  ts_current_free = counting_free;
+  return true;
+}
+
+void tree_sitter_objecttext_alloc_stats_reset(void) {
+  counter_store(&totals.allocations, 0);
+  counter_store(&totals.reallocations, 0);
+  counter_store(&totals.frees, 0);
+  counter_store(&totals.bytes_requested, 0);
+  for (unsigned i = 0; i < TS_OBJECTTEXT_ALLOC_SIZE_CLASSES; i++) {
+    counter_store(&totals.size_classes[i], 0);
+  }
+  counter_store(&totals.peak_bytes, counter_load(&totals.current_bytes));
+}
+
+void tree_sitter_objecttext_alloc_stats_get(TSObjecttextAllocStats *result) {
+  result->allocations = (uint64_t)counter_load(&totals.allocations);
+  result->reallocations = (uint64_t)counter_load(&totals.reallocations);
+  result->frees = (uint64_t)counter_load(&totals.frees);
+  result->bytes_requested = (uint64_t)counter_load(&totals.bytes_requested);
+  result->current_bytes = counter_load(&totals.current_bytes);
+  result->peak_bytes = counter_load(&totals.peak_bytes);
+  for (unsigned i = 0; i < TS_OBJECTTEXT_ALLOC_SIZE_CLASSES; i++) {
+    result->size_classes[i] = (uint64_t)counter_load(&totals.size_classes[i]);
+  }
+}
@@ -0,0 +1,143 @@
+// src/parser.c with counting lexer macros, for -DOBJECTTEXT_PROFILE_LEXER=ON.
+// The generated file is included unchanged: its own include of
+// tree_sitter/parser.h is a no-op after the one below, so the macros
+// redefined here are the ones it expands.
+
+#include "tree_sitter/parser.h"
+#include "tree_sitter/tree-sitter-objecttext-profile.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Indexed by the full TSStateId range: ts_lex_modes only names the start
+// states, and the states reached from them are numbered past its maximum.
+// Pages that are never touched cost nothing.
+#define LEX_STATE_CAPACITY (UINT16_MAX + 1)
+
+static TSObjecttextLexStateCounts lex_states[LEX_STATE_CAPACITY];
+static uint64_t tokens[UINT16_MAX + 1];
+static uint32_t lex_state_count = 0;
+
+static inline TSObjecttextLexStateCounts *lex_counts(TSStateId state) {
+  if (state >= lex_state_count) lex_state_count = state + 1u;
+  return &lex_states[state];
+}
+
+#undef START_LEXER
+#define START_LEXER()                 \
+  bool result = false;                \
+  bool skip = false;                  \
+  UNUSED                              \
+  bool eof = false;                   \
+  int32_t lookahead;                  \
+  goto start;                         \
+  next_state:                         \
+  lexer->advance(lexer, skip);        \
+  start:                              \
+  lex_counts(state)->visits++;        \
+  skip = false;                       \
+  lookahead = lexer->lookahead;
+
+#undef ADVANCE
+#define ADVANCE(state_value)         \
+  {                                  \
+    lex_counts(state)->advances++;   \
+    state = state_value;             \
+    goto next_state;                 \
+  }
+
+#undef ADVANCE_MAP
+#define ADVANCE_MAP(...)                                              \
+  {                                                                   \
+    static const uint16_t map[] = { __VA_ARGS__ };                    \
+    for (uint32_t i = 0; i < sizeof(map) / sizeof(map[0]); i += 2) {  \
+      if (map[i] == lookahead) {                                      \
+        lex_counts(state)->advances++;                                \
+        state = map[i + 1];                                           \
+        goto next_state;                                              \
+      }                                                               \
+    }                                                                 \
+  }
+
+#undef SKIP
+#define SKIP(state_value)          \
+  {                                \
+    lex_counts(state)->skips++;    \
+    skip = true;                   \
+    state = state_value;           \
+    goto next_state;               \
+  }
+
+#undef END_STATE
+#define END_STATE()                                 \
+  if (result) tokens[lexer->result_symbol]++;       \
+  return result;
+
+#include "parser.c"
+
+void tree_sitter_objecttext_profile_reset(void) {
+  memset(lex_states, 0, lex_state_count * sizeof(lex_states[0]));
+  memset(tokens, 0, sizeof(tokens));
+}
+
+uint32_t tree_sitter_objecttext_profile_lex_state_count(void) {
+  return lex_state_count;
+}
+
+void tree_sitter_objecttext_profile_lex_state(uint32_t state, TSObjecttextLexStateCounts *counts) {
+  static const TSObjecttextLexStateCounts none;
+  *counts = state < LEX_STATE_CAPACITY ? lex_states[state] : none;
+}
+
+uint64_t tree_sitter_objecttext_profile_tokens(uint16_t symbol) {
+  return tokens[symbol];
+}
+
+static int by_visits(const void *a, const void *b) {
+  uint64_t left = lex_states[*(const uint32_t *)a].visits;
+  uint64_t right = lex_states[*(const uint32_t *)b].visits;
+  return left < right ? 1 : left > right ? -1 : 0;
+}
+
+static int by_tokens(const void *a, const void *b) {
+  uint64_t left = tokens[*(const uint32_t *)a];
+  uint64_t right = tokens[*(const uint32_t *)b];
+  return left < right ? 1 : left > right ? -1 : 0;
+}
+
+void tree_sitter_objecttext_profile_report(FILE *file) {
+  static uint32_t order[LEX_STATE_CAPACITY > SYMBOL_COUNT ? LEX_STATE_CAPACITY : SYMBOL_COUNT];
+  uint32_t states = lex_state_count;
+
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < states; i++) {
+    order[i] = i;
+    total += lex_states[i].visits;
+  }
+  qsort(order, states, sizeof(order[0]), by_visits);
+  fprintf(file, "%-9s %14s %7s %14s %14s  %s\n", "lex state", "visits", "share", "advances",
+          "skips", "parse states");
+  for (uint32_t i = 0; i < states && lex_states[order[i]].visits; i++) {
+    const TSObjecttextLexStateCounts *counts = &lex_states[order[i]];
+    fprintf(file, "%-9u %14llu %6.2f%% %14llu %14llu ", order[i],
+            (unsigned long long)counts->visits, 100.0 * (double)counts->visits / (double)total,
+            (unsigned long long)counts->advances, (unsigned long long)counts->skips);
+    // Only start states have parse states; the rest are reached from them.
+    for (uint32_t parse_state = 0; parse_state < STATE_COUNT; parse_state++) {
+      if (ts_lex_modes[parse_state].lex_state == order[i]) fprintf(file, " %u", parse_state);
+    }
+    fputc('\n', file);
+  }
+
+  total = 0;
+  for (uint32_t i = 0; i < SYMBOL_COUNT; i++) {
+    order[i] = i;
+    total += tokens[i];
+  }
+  qsort(order, SYMBOL_COUNT, sizeof(order[0]), by_tokens);
+  fprintf(file, "\n%-24s %14s %7s\n", "token", "count", "share");
+  for (uint32_t i = 0; i < SYMBOL_COUNT && tokens[order[i]]; i++) {
+    fprintf(file, "%-24s %14llu %6.2f%%\n", ts_symbol_names[order[i]],
+            (unsigned long long)tokens[order[i]], 100.0 * (double)tokens[order[i]] / (double)total);
+  }
+}
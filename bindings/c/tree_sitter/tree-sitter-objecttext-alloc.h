@@ -0,0 +1,45 @@
+#ifndef TREE_SITTER_OBJECTTEXT_ALLOC_H_
+#define TREE_SITTER_OBJECTTEXT_ALLOC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Only available when the library is built with
+// -DOBJECTTEXT_COUNT_ALLOCATIONS=ON.
+
+// Size class i counts requests of [2^i, 2^(i+1)) bytes; class 0 also holds
+// zero-byte requests and the last class everything larger.
+#define TS_OBJECTTEXT_ALLOC_SIZE_CLASSES 32
+
+typedef struct {
+  uint64_t allocations;   // malloc, calloc and realloc of a null pointer
+  uint64_t reallocations; // realloc of an existing block
+  uint64_t frees;
+  uint64_t bytes_requested;
+  int64_t current_bytes;  // usable size of live blocks, as malloc rounds it
+  int64_t peak_bytes;
+  uint64_t size_classes[TS_OBJECTTEXT_ALLOC_SIZE_CLASSES];
+} TSObjecttextAllocStats;
+
+// Points the tree-sitter allocator hooks at counting wrappers around malloc.
+// Live bytes come from malloc_usable_size (malloc_size, _msize), so blocks
+// allocated before the hooks were installed are freed as usual; they only
+// pull current_bytes below zero. Returns false if the hooks were already
+// installed.
+bool tree_sitter_objecttext_alloc_stats_install(void);
+
+// Counters are process-wide, so a parse is measured by resetting them before
+// ts_parser_parse and reading them afterwards while no other thread parses.
+// Reset keeps the bytes still live so that peaks stay comparable.
+void tree_sitter_objecttext_alloc_stats_reset(void);
+void tree_sitter_objecttext_alloc_stats_get(TSObjecttextAllocStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_OBJECTTEXT_ALLOC_H_
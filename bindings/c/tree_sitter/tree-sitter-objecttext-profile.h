@@ -0,0 +1,39 @@
+#ifndef TREE_SITTER_OBJECTTEXT_PROFILE_H_
+#define TREE_SITTER_OBJECTTEXT_PROFILE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Only available when the library is built with
+// -DOBJECTTEXT_PROFILE_LEXER=ON, which compiles src/parser.c with counting
+// versions of the lexer macros. The counters are plain globals: profile
+// single-threaded runs.
+
+typedef struct {
+  uint64_t visits;   // times the lexer was in this state
+  uint64_t advances; // ADVANCE and ADVANCE_MAP transitions out of it
+  uint64_t skips;    // SKIP transitions out of it
+} TSObjecttextLexStateCounts;
+
+void tree_sitter_objecttext_profile_reset(void);
+
+// Number of lex states; states are numbered from 0.
+uint32_t tree_sitter_objecttext_profile_lex_state_count(void);
+void tree_sitter_objecttext_profile_lex_state(uint32_t state, TSObjecttextLexStateCounts *counts);
+
+// Tokens the lexer returned with |symbol| as their result.
+uint64_t tree_sitter_objecttext_profile_tokens(uint16_t symbol);
+
+// Writes the lex states, hottest first with the parse states that lex in
+// them, then the tokens per symbol, most frequent first.
+void tree_sitter_objecttext_profile_report(FILE *file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_OBJECTTEXT_PROFILE_H_
@@ -0,0 +1,181 @@
+#include "objecttext/arena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+
+namespace objecttext {
+
+namespace {
+
+constexpr size_t kAlignment = 16;
+constexpr size_t kHeader = kAlignment; // holds the size of the allocation
+
+thread_local Arena *current = nullptr;
+
+// The blocks of every live arena, so that the allocation hooks can tell
+// arena memory freed outside its scope from memory malloc owns.
+struct BlockRegistry {
+    std::shared_mutex mutex;
+    std::map<uintptr_t, uintptr_t> ends; // start to end
+    std::atomic<size_t> count{0};
+};
+
+BlockRegistry &registry() {
+    // Never destroyed, for arenas that outlive static destruction.
+    static BlockRegistry *instance = new BlockRegistry;
+    return *instance;
+}
+
+size_t align_up(size_t size) {
+    return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+size_t &size_of(void *pointer) {
+    return *reinterpret_cast<size_t *>(static_cast<char *>(pointer) - kHeader);
+}
+
+} // namespace
+
+Arena::Arena(size_t block_size) : block_size_(std::max<size_t>(block_size, 4096)) {}
+
+Arena::~Arena() {
+    for (Block &block : blocks_) drop(block);
+}
+
+void Arena::drop(const Block &block) {
+    BlockRegistry &blocks = registry();
+    {
+        std::unique_lock<std::shared_mutex> lock(blocks.mutex);
+        blocks.ends.erase(reinterpret_cast<uintptr_t>(block.data));
+        blocks.count.fetch_sub(1, std::memory_order_relaxed);
+    }
+    free(block.raw);
+}
+
+bool Arena::grow(size_t size) {
+    size_t last = blocks_.empty() ? block_size_ : blocks_.back().size * 2;
+    size_t block_size = std::max(last, size);
+    // malloc only guarantees alignof(max_align_t), which may be 8.
+    block_size = align_up(block_size);
+    void *raw = malloc(block_size + kAlignment);
+    if (!raw) return false;
+    char *data = reinterpret_cast<char *>(align_up(reinterpret_cast<uintptr_t>(raw)));
+    blocks_.push_back({raw, data, block_size});
+    BlockRegistry &blocks = registry();
+    {
+        std::unique_lock<std::shared_mutex> lock(blocks.mutex);
+        blocks.ends[reinterpret_cast<uintptr_t>(data)] = reinterpret_cast<uintptr_t>(data) + block_size;
+        blocks.count.fetch_add(1, std::memory_order_relaxed);
+    }
+    offset_ = 0;
+    return true;
+}
+
+void *Arena::allocate(size_t size) {
+    size_t needed = kHeader + align_up(size ? size : 1);
+    if (blocks_.empty() || blocks_.back().size - offset_ < needed) {
+        if (!grow(needed)) return nullptr;
+    }
+    char *pointer = blocks_.back().data + offset_ + kHeader;
+    offset_ += needed;
+    used_ += needed;
+    last_ = pointer;
+    size_of(pointer) = size;
+    return pointer;
+}
+
+void *Arena::reallocate(void *pointer, size_t size) {
+    if (!pointer) return allocate(size);
+    size_t old_size = size_of(pointer);
+    if (pointer == last_) {
+        Block &block = blocks_.back();
+        size_t start = static_cast<size_t>(static_cast<char *>(pointer) - block.data);
+        size_t end = start + align_up(size ? size : 1);
+        if (end <= block.size) {
+            used_ = used_ + end - offset_;
+            offset_ = end;
+            size_of(pointer) = size;
+            return pointer;
+        }
+    } else if (size <= old_size) {
+        size_of(pointer) = size;
+        return pointer;
+    }
+    void *moved = allocate(size);
+    if (moved) memcpy(moved, pointer, std::min(old_size, size));
+    return moved;
+}
+
+void Arena::release(void *pointer) {
+    if (!pointer || pointer != last_) return;
+    size_t freed = offset_ - static_cast<size_t>(static_cast<char *>(pointer) - kHeader -
+                                                 blocks_.back().data);
+    offset_ -= freed;
+    used_ -= freed;
+    last_ = nullptr;
+}
+
+bool Arena::owns(const void *pointer) const {
+    const char *address = static_cast<const char *>(pointer);
+    // Blocks double in size, so the newest ones are the likeliest owners.
+    for (auto block = blocks_.rbegin(); block != blocks_.rend(); ++block) {
+        if (address >= block->data && address < block->data + block->size) return true;
+    }
+    return false;
+}
+
+bool Arena::owned_by_any(const void *pointer) {
+    BlockRegistry &blocks = registry();
+    if (!pointer || blocks.count.load(std::memory_order_relaxed) == 0) return false;
+    uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+    std::shared_lock<std::shared_mutex> lock(blocks.mutex);
+    auto after = blocks.ends.upper_bound(address);
+    if (after == blocks.ends.begin()) return false;
+    --after;
+    return address < after->second;
+}
+
+size_t Arena::allocation_size(const void *pointer) {
+    return size_of(const_cast<void *>(pointer));
+}
+
+void Arena::reset() {
+    if (!blocks_.empty()) {
+        auto largest = std::max_element(blocks_.begin(), blocks_.end(),
+                                        [](const Block &a, const Block &b) { return a.size < b.size; });
+        Block keep = *largest;
+        for (Block &block : blocks_) {
+            if (block.raw != keep.raw) drop(block);
+        }
+        blocks_.assign(1, keep);
+    }
+    offset_ = 0;
+    used_ = 0;
+    last_ = nullptr;
+}
+
+size_t Arena::bytes_reserved() const {
+    size_t total = 0;
+    for (const Block &block : blocks_) total += block.size;
+    return total;
+}
+
+ArenaScope::ArenaScope(Arena &arena) : previous_(current) {
+    current = &arena;
+}
+
+ArenaScope::~ArenaScope() {
+    current = previous_;
+}
+
+Arena *current_arena() {
+    return current;
+}
+
+} // namespace objecttext
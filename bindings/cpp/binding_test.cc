@@ -0,0 +1,535 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "objecttext/arena.h"
+#include "objecttext/expression.h"
+#include "objecttext/flat_tree.h"
+#include "objecttext/highlighter.h"
+#include "objecttext/metrics.h"
+#include "objecttext/numeric_export.h"
+#include "objecttext/parse_metrics.h"
+#include "objecttext/parser.h"
+#include "objecttext/path_match.h"
+#include "objecttext/queries.h"
+#include "objecttext/split.h"
+#include "objecttext/to_json.h"
+
+using namespace objecttext;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                  \
+    do {                                                                  \
+        if (!(condition)) {                                               \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+                    #condition);                                          \
+            failures++;                                                   \
+        }                                                                 \
+    } while (0)
+
+static const char SHIP[] =
+    "Ship\n"
+    "{\n"
+    "    Parts\n"
+    "    {\n"
+    "        Thruster\n"
+    "        {\n"
+    "            Type = Engine\n"
+    "            Components\n"
+    "            {\n"
+    "                Nozzle\n"
+    "                {\n"
+    "                    Cost = 150\n"
+    "                }\n"
+    "                Tank\n"
+    "                {\n"
+    "                    Cost = 40\n"
+    "                }\n"
+    "            }\n"
+    "        }\n"
+    "        Armor\n"
+    "        {\n"
+    "            Components\n"
+    "            [\n"
+    "                {\n"
+    "                    Cost = 5\n"
+    "                }\n"
+    "            ]\n"
+    "        }\n"
+    "    }\n"
+    "}\n";
+
+static void test_can_load_grammar() {
+    Parser parser;
+    Tree tree = parser.parse(SHIP);
+    CHECK(tree != nullptr);
+    CHECK(!ts_node_has_error(ts_tree_root_node(tree.get())));
+}
+
+static size_t count_matches(const char *path, std::string_view source) {
+    auto query = PathQuery::compile(path);
+    if (!query) return SIZE_MAX;
+    Parser parser;
+    Tree tree = parser.parse(source);
+    PathMatcher matcher(*query);
+    return matcher.collect(ts_tree_root_node(tree.get()), source).size();
+}
+
+static void test_path_match() {
+    CHECK(count_matches("Ship/Parts/*/Components/*/Cost", SHIP) == 3);
+    CHECK(count_matches("Ship/Parts/Thruster/Components/*/Cost", SHIP) == 2);
+    CHECK(count_matches("**/Cost", SHIP) == 3);
+    CHECK(count_matches("**/Cost[> 100]", SHIP) == 1);
+    CHECK(count_matches("Ship/Parts/*[Type = Engine]", SHIP) == 1);
+    CHECK(count_matches("Ship/Parts/Armor/Components/0/Cost", SHIP) == 1);
+    CHECK(count_matches("Ship/Missing/**", SHIP) == 0);
+}
+
+// Unnamed entries recovered into an ERROR node keep counting with the rest
+// of their list, so no index names two of them.
+static void test_path_match_in_errors() {
+    static const char BROKEN[] =
+        "Slots\n"
+        "[\n"
+        "    { Size = 1 }\n"
+        "    { Size = 2 } = =\n"
+        "    { Size = 3 }\n"
+        "    { Size = 4 ]\n"
+        "    { Size = 5 }\n"
+        "]\n";
+    Parser parser;
+    Tree tree = parser.parse(BROKEN);
+    CHECK(ts_node_has_error(ts_tree_root_node(tree.get())));
+
+    size_t indexed = 0;
+    for (int i = 0; i < 8; i++) {
+        std::string path = "**/Slots/" + std::to_string(i) + "/Size";
+        size_t matches = count_matches(path.c_str(), BROKEN);
+        CHECK(matches <= 1);
+        indexed += matches;
+    }
+    CHECK(count_matches("**/Slots/0/Size", BROKEN) == 1);
+    CHECK(indexed == count_matches("**/Slots/*/Size", BROKEN));
+}
+
+static void test_query_registry() {
+    QueryRegistry &registry = QueryRegistry::global();
+    for (QueryPack pack : {QueryPack::Highlights, QueryPack::Locals, QueryPack::Tags}) {
+        const TSQuery *query = registry.get(pack);
+        CHECK(query != nullptr);
+        CHECK(registry.get(pack) == query);
+    }
+
+    uint32_t error_offset = 0;
+    TSQueryError error_type = TSQueryErrorNone;
+    CHECK(registry.get("(group", &error_offset, &error_type) == nullptr);
+    CHECK(error_type != TSQueryErrorNone);
+
+    Parser parser;
+    Tree tree = parser.parse(SHIP);
+    QueryCursor cursor;
+    ts_query_cursor_exec(cursor.get(), registry.get(QueryPack::Highlights),
+                         ts_tree_root_node(tree.get()));
+    TSQueryMatch match;
+    uint32_t capture_index = 0;
+    size_t captures = 0;
+    while (ts_query_cursor_next_capture(cursor.get(), &match, &capture_index)) captures++;
+    CHECK(captures > 0);
+}
+
+static bool same_highlights(const Highlighter &a, const Highlighter &b) {
+    if (a.lines().size() != b.lines().size()) return false;
+    for (size_t row = 0; row < a.lines().size(); row++) {
+        const HighlightLine &x = a.lines()[row];
+        const HighlightLine &y = b.lines()[row];
+        if (x.size() != y.size()) return false;
+        for (size_t i = 0; i < x.size(); i++) {
+            if (x[i].start_column != y[i].start_column || x[i].end_column != y[i].end_column ||
+                x[i].highlight != y[i].highlight) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void test_highlighter() {
+    std::string source = SHIP;
+    Highlighter incremental;
+    incremental.reset(source);
+    CHECK(incremental.lines().size() == 31);
+
+    // Insert a digit, then a new line and an assignment, then remove both.
+    uint32_t cost = static_cast<uint32_t>(source.find("150"));
+    CHECK(!incremental.edit(cost + 3, cost + 3, "0").empty());
+    uint32_t line_end = static_cast<uint32_t>(source.find('\n', cost)) + 1;
+    auto diffs = incremental.edit(line_end + 1, line_end + 1, "                    Mass = 2\n");
+    CHECK(!diffs.empty());
+
+    Highlighter fresh;
+    fresh.reset(incremental.source());
+    CHECK(same_highlights(incremental, fresh));
+
+    incremental.edit(cost + 3, line_end + 1 + 29, "\n");
+    fresh.reset(source);
+    CHECK(incremental.source() == source);
+    CHECK(same_highlights(incremental, fresh));
+}
+
+static size_t count_captures(const TSQuery *query, TSNode root) {
+    QueryCursor cursor;
+    ts_query_cursor_exec(cursor.get(), query, root);
+    TSQueryMatch match;
+    uint32_t capture_index = 0;
+    size_t captures = 0;
+    while (ts_query_cursor_next_capture(cursor.get(), &match, &capture_index)) captures++;
+    return captures;
+}
+
+// The highlighter narrows its pooled cursor to the rows it redraws; a query
+// run after it on the same thread must still see the whole tree.
+static void test_cursor_after_highlighter() {
+    std::thread([] {
+        const TSQuery *query = QueryRegistry::global().get(QueryPack::Highlights);
+        Parser parser;
+        Tree tree = parser.parse(SHIP);
+        size_t captures = count_captures(query, ts_tree_root_node(tree.get()));
+        CHECK(captures > 0);
+
+        std::string source = SHIP;
+        Highlighter highlighter;
+        highlighter.reset(source);
+        uint32_t cost = static_cast<uint32_t>(source.find("150"));
+        CHECK(!highlighter.edit(cost + 3, cost + 3, "0").empty());
+        CHECK(count_captures(query, ts_tree_root_node(tree.get())) == captures);
+    }).join();
+}
+
+static std::vector<uint32_t> match_starts(const std::vector<PathMatch> &matches) {
+    std::vector<uint32_t> starts;
+    for (const PathMatch &match : matches) starts.push_back(match.start_byte);
+    return starts;
+}
+
+static void test_split_document() {
+    SplitOptions options;
+    options.threads = 2;
+    options.chunk_bytes = 1;
+    options.min_split_bytes = 0;
+    SplitDocument document = SplitDocument::parse(SHIP, options);
+    CHECK(document.chunks().size() > 1);
+    CHECK(!document.has_error());
+
+    Parser parser;
+    Tree tree = parser.parse(SHIP);
+    for (const char *path : {"**/Cost", "Ship/Parts/*", "Ship/Parts/Armor/Components/0/Cost",
+                             "Ship/Parts/Thruster/Components/1"}) {
+        auto query = PathQuery::compile(path);
+        CHECK(query.has_value());
+        PathMatcher matcher(*query);
+        std::vector<uint32_t> expected;
+        matcher.run(ts_tree_root_node(tree.get()), SHIP,
+                    [&](TSNode node) { expected.push_back(ts_node_start_byte(node)); });
+        CHECK(!expected.empty());
+        CHECK(match_starts(document.match(*query, 2)) == expected);
+    }
+
+    std::string_view source(SHIP);
+    for (const SplitChunk &chunk : document.chunks()) {
+        TSPoint point = chunk.body().start_point;
+        size_t line_start = source.rfind('\n', chunk.body().start_byte - 1) + 1;
+        CHECK(point.column == chunk.body().start_byte - line_start);
+    }
+}
+
+static void test_recover_document() {
+    static const char BROKEN[] =
+        "Ship\n"
+        "{\n"
+        "    Good = 1\n"
+        "    ..Stray = 2\n"
+        "    Broken\n"
+        "    {\n"
+        "    Parts\n"
+        "    {\n"
+        "        Cost = 3\n"
+        "    }\n"
+        "    Tail = 4\n"
+        "}\n";
+    RecoveryOptions options;
+    options.slice_bytes = 1;
+    SplitDocument document = SplitDocument::recover(BROKEN, options);
+    CHECK(document.chunks().size() == 4);
+    CHECK(document.has_error());
+    size_t clean = 0;
+    for (const SplitChunk &chunk : document.chunks()) {
+        if (chunk.tree && !ts_node_has_error(ts_tree_root_node(chunk.tree.get()))) clean++;
+    }
+    CHECK(clean == 2);
+    auto query = PathQuery::compile("Ship/Parts/Cost");
+    CHECK(query.has_value());
+    CHECK(document.match(*query).size() == 1);
+
+    // A string left open at the end of the file, in a buffer of exactly its
+    // size: resyncing indexes it without reading past the end.
+    std::string open = std::string(BROKEN) + "Name = \"unterminated";
+    std::unique_ptr<char[]> exact(new char[open.size()]);
+    memcpy(exact.get(), open.data(), open.size());
+    SplitDocument truncated =
+        SplitDocument::recover(std::string_view(exact.get(), open.size()), options);
+    CHECK(truncated.has_error() && !truncated.chunks().empty());
+    CHECK(truncated.match(*query).size() == 1);
+
+    // Valid input is kept whole, and a generous limit changes nothing.
+    CHECK(SplitDocument::recover(SHIP).chunks().size() == 1);
+    Parser parser;
+    Tree tree = parser.parse_with_recovery_limit(BROKEN, std::chrono::seconds(10));
+    CHECK(tree && ts_node_has_error(ts_tree_root_node(tree.get())));
+}
+
+static void test_parse_limits() {
+    std::string source = "Ship\n{\n";
+    for (int i = 0; i < 2000; i++) source += "    Part" + std::to_string(i) + " = " + std::to_string(i) + "\n";
+    source += "}\n";
+
+    // Cancelled before it starts, then resumed without limits.
+    Parser parser;
+    CancellationToken token;
+    token.cancel();
+    ParseLimits limits;
+    limits.cancel = &token;
+    ParseStatus status;
+    CHECK(!parser.parse(source, limits, &status));
+    CHECK(status == ParseStatus::Cancelled);
+    CHECK(parser.paused());
+    Tree tree = parser.parse(source, ParseLimits(), &status);
+    CHECK(tree && status == ParseStatus::Complete && !parser.paused());
+    CHECK(!ts_node_has_error(ts_tree_root_node(tree.get())));
+
+    // A byte budget per call parses the file in steps that make progress.
+    ParseLimits step;
+    step.bytes = 4096;
+    uint32_t reported = 0;
+    step.progress = [&](uint32_t byte) { reported = byte; };
+    int calls = 0;
+    uint32_t reached = 0;
+    Tree stepped;
+    while (!stepped && calls < 1000) {
+        stepped = parser.parse(source, step, &status);
+        calls++;
+        if (stepped) break;
+        CHECK(status == ParseStatus::OutOfBytes);
+        CHECK(parser.paused_at() > reached);
+        reached = parser.paused_at();
+    }
+    CHECK(stepped && calls > 1);
+    CHECK(reported > 0);
+    CHECK(ts_node_end_byte(ts_tree_root_node(stepped.get())) == ts_node_end_byte(ts_tree_root_node(tree.get())));
+
+    // A plain parse discards a paused one.
+    CHECK(!parser.parse(source, limits, &status));
+    Tree other = parser.parse(SHIP);
+    CHECK(other && !parser.paused());
+    CHECK(!ts_node_has_error(ts_tree_root_node(other.get())));
+}
+
+static void test_parse_metrics() {
+    Parser parser;
+    Tree tree = parser.parse(SHIP);
+    ParseStats stats = ParseStats::collect(tree.get(), 0.001, false);
+    CHECK(stats.bytes == strlen(SHIP));
+    CHECK(stats.nodes > 0 && stats.error_nodes == 0);
+    CHECK(stats.nodes_by_symbol[Symbols::get().group] > 0);
+
+    MetricsRegistry &registry = MetricsRegistry::global();
+    enable_parse_metrics();
+    registry.reset();
+    Tree first = parser.parse(SHIP);
+    parser.parse(SHIP, first.get());
+    enable_parse_metrics(false);
+    std::string text = registry.render();
+    CHECK(text.find("objecttext_parse_files_total 2\n") != std::string::npos);
+    CHECK(text.find("objecttext_parse_reparses_total 1\n") != std::string::npos);
+    CHECK(text.find("objecttext_parse_bytes_total " + std::to_string(2 * strlen(SHIP)) + "\n") !=
+          std::string::npos);
+    CHECK(text.find("objecttext_parse_nodes_total{symbol=\"group\"} " +
+                    std::to_string(2 * stats.nodes_by_symbol[Symbols::get().group]) + "\n") !=
+          std::string::npos);
+    CHECK(text.find("objecttext_parse_seconds_count 2\n") != std::string::npos);
+}
+
+// Installs process-wide hooks, so it runs last.
+static void test_arena_allocator() {
+    install_arena_allocator();
+    CHECK(arena_allocator_installed());
+    Parser outside;
+
+    Arena arena;
+    Tree kept;
+    {
+        ArenaScope scope(arena);
+        Parser parser;
+        Tree tree = parser.parse(SHIP);
+        CHECK(!ts_node_has_error(ts_tree_root_node(tree.get())));
+        CHECK(arena.bytes_used() > 0);
+        CHECK(count_matches("**/Cost", SHIP) == 3);
+        kept = parser.parse(SHIP);
+    }
+    // A tree kept past its scope, reused by a parse outside it and freed on
+    // another thread goes back to the arena, not to realloc() or free().
+    CHECK(Arena::owned_by_any(kept.get()));
+    Tree reparsed = outside.parse(SHIP, kept.get());
+    CHECK(reparsed && !ts_node_has_error(ts_tree_root_node(reparsed.get())));
+    reparsed.reset();
+    std::thread([&] { kept.reset(); }).join();
+    arena.reset();
+    CHECK(arena.bytes_used() == 0);
+
+    Tree tree = outside.parse(SHIP);
+    CHECK(!ts_node_has_error(ts_tree_root_node(tree.get())));
+}
+
+static void test_flat_tree() {
+    Parser parser;
+    Tree tree = parser.parse(SHIP);
+    TSNode root = ts_tree_root_node(tree.get());
+    FlatTree flat = FlatTree::build(root, SHIP);
+    CHECK(flat.node_count() > 0);
+    CHECK(flat.parents()[0] == kFlatNone && flat.ends()[0] == flat.node_count());
+    CHECK(flat.symbols()[0] == ts_node_symbol(root));
+    CHECK(flat.offset(FlatColumn::Symbol) % 2 == 0);
+
+    // Every `Cost` key shares one string, and every node lies inside its
+    // parent.
+    uint32_t costs = 0;
+    for (uint32_t i = 1; i < flat.node_count(); i++) {
+        uint32_t parent = flat.parents()[i];
+        CHECK(parent < i && flat.ends()[i] <= flat.ends()[parent]);
+        CHECK(flat.start_bytes()[i] >= flat.start_bytes()[parent]);
+        if (flat.texts()[i] != kFlatNone && flat.string(flat.texts()[i]) == "Cost") costs++;
+    }
+    CHECK(costs == 3);
+    uint32_t cost_strings = 0;
+    for (uint32_t id = 0; id < flat.string_count(); id++) cost_strings += flat.string(id) == "Cost";
+    CHECK(cost_strings == 1);
+
+    FlatTree named = FlatTree::build(root, SHIP, true);
+    uint32_t named_nodes = 0;
+    for (uint32_t i = 0; i < flat.node_count(); i++) named_nodes += flat.flags()[i] & kFlatNamed;
+    CHECK(named.node_count() == named_nodes);
+    for (uint32_t i = 0; i < named.node_count(); i++) CHECK(named.flags()[i] & kFlatNamed);
+}
+
+static void test_write_json() {
+    Parser parser;
+    Tree tree = parser.parse(SHIP);
+    std::string json;
+    write_json(ts_tree_root_node(tree.get()), SHIP, &json);
+    CHECK(json == "{\"Ship\":{\"Parts\":{\"Thruster\":{\"Type\":\"Engine\",\"Components\":{"
+                  "\"Nozzle\":{\"Cost\":150},\"Tank\":{\"Cost\":40}}},"
+                  "\"Armor\":{\"Components\":[{\"Cost\":5}]}}}}");
+
+    const char *values =
+        "Values\n"
+        "{\n"
+        "    Name = \"A \\\"big\\\" ship\"\n"
+        "    Path = @\"C:\\dir\"\n"
+        "    Scale = 50%\n"
+        "    Base : Parts/Base\n"
+        "    {\n"
+        "    }\n"
+        "    Items\n"
+        "    [\n"
+        "        Key = 1\n"
+        "    ]\n"
+        "}\n";
+    tree = parser.parse(values);
+    json.clear();
+    write_json(ts_tree_root_node(tree.get()), values, &json);
+    CHECK(json == "{\"Values\":{\"Name\":\"A \\\"big\\\" ship\",\"Path\":\"C:\\\\dir\","
+                  "\"Scale\":0.5,\"Base\":{\"$extends\":[\"Parts/Base\"]},"
+                  "\"Items\":[{\"Key\":1}]}}");
+
+    json.clear();
+    JsonOptions pretty;
+    pretty.indent = 2;
+    const char *nested = "A\n{\n    B = 1\n    C\n    {\n    }\n}\n";
+    tree = parser.parse(nested);
+    write_json(ts_tree_root_node(tree.get()), nested, &json, pretty);
+    CHECK(json == "{\n  \"A\": {\n    \"B\": 1,\n    \"C\": {}\n  }\n}");
+}
+
+// The value of the single assignment in |source|.
+static bool evaluate_assignment(Parser &parser, const char *source, double *result) {
+    Tree tree = parser.parse(source);
+    TSNode assignment = ts_node_named_child(ts_tree_root_node(tree.get()), 0);
+    return evaluate_expression(entry_value(assignment), source, result);
+}
+
+static void test_evaluate_expression() {
+    Parser parser;
+    double value = 0;
+    CHECK(evaluate_assignment(parser, "A = 2 * (10 + 50%)\n", &value) && value == 21);
+    CHECK(evaluate_assignment(parser, "A = 10 - 4 - 3\n", &value) && value == 3);
+    CHECK(evaluate_assignment(parser, "A = -(1.5)\n", &value) && value == -1.5);
+    CHECK(evaluate_assignment(parser, "A = 90d\n", &value) && value == 90);
+    value = 7;
+    CHECK(!evaluate_assignment(parser, "A = 1 / 0\n", &value) && value == 7);
+    CHECK(!evaluate_assignment(parser, "A = &Base/Cost * 2\n", &value) && value == 7);
+    CHECK(!evaluate_assignment(parser, "A = Engine\n", &value) && value == 7);
+}
+
+static void test_collect_numbers() {
+    const char *source =
+        "Part\n"
+        "{\n"
+        "    Cost = 150\n"
+        "    Scale = 50%\n"
+        "    Type = Engine\n"
+        "    Angle = 90d\n"
+        "    Thrust = 2 * (10 + 5)\n"
+        "    Base = &Base/Cost * 2\n"
+        "    Slots\n"
+        "    [\n"
+        "        {\n"
+        "            Size = 3\n"
+        "        }\n"
+        "    ]\n"
+        "}\n";
+    Parser parser;
+    Tree tree = parser.parse(source);
+    NumericTable table;
+    uint32_t file = table.add_file("part.rules");
+    CHECK(collect_numbers(ts_tree_root_node(tree.get()), source, file, &table) == 5);
+    CHECK(table.path(table.path_ids()[0]) == "Part/Cost" && table.values()[0] == 150);
+    CHECK(table.lines()[0] == 2 && table.file_ids()[0] == file);
+    CHECK(table.values()[1] == 0.5 && table.flags()[1] == kNumericPercent);
+    CHECK(table.values()[2] == 90 && table.flags()[2] == kNumericDegrees);
+    CHECK(table.values()[3] == 30 && table.flags()[3] == kNumericExpression);
+    CHECK(table.path(table.path_ids()[4]) == "Part/Slots/0/Size");
+}
+
+int main() {
+    test_can_load_grammar();
+    test_path_match();
+    test_path_match_in_errors();
+    test_query_registry();
+    test_highlighter();
+    test_cursor_after_highlighter();
+    test_split_document();
+    test_recover_document();
+    test_parse_limits();
+    test_parse_metrics();
+    test_flat_tree();
+    test_write_json();
+    test_evaluate_expression();
+    test_collect_numbers();
+    test_arena_allocator();
+    if (failures) fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,378 @@
+#include <clocale>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "objecttext/arena.h"
+#include "objecttext/json.h"
+#include "objecttext/metrics.h"
+#include "objecttext/numeric_table.h"
+#include "objecttext/path_query.h"
+#include "objecttext/structure.h"
+#include "objecttext/trace.h"
+#include "objecttext/value.h"
+
+using namespace objecttext;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                  \
+    do {                                                                  \
+        if (!(condition)) {                                               \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+                    #condition);                                          \
+            failures++;                                                   \
+        }                                                                 \
+    } while (0)
+
+static void test_parse_number() {
+    double value = 0;
+    unsigned suffix = 0;
+    CHECK(parse_number("-1.5", &value, &suffix) && value == -1.5 && suffix == kSuffixNone);
+    CHECK(parse_number("50%", &value, &suffix) && value == 0.5 && suffix == kSuffixPercent);
+    CHECK(parse_number("90d", &value, &suffix) && value == 90 && suffix == kSuffixDegrees);
+    CHECK(parse_number(".25", &value));
+    CHECK(!parse_number("inf", &value));
+    CHECK(!parse_number("12px", &value));
+    CHECK(!parse_number("0x10", &value));
+    CHECK(!parse_number("1 ", &value));
+    CHECK(!parse_number("1e999", &value));
+    CHECK(parse_number("2.5e2", &value) && value == 250);
+    // A locale with a decimal comma must not change how numbers read.
+    if (setlocale(LC_NUMERIC, "de_DE.UTF-8")) {
+        CHECK(parse_number("1.5", &value) && value == 1.5);
+        setlocale(LC_NUMERIC, "C");
+    }
+    CHECK(unquote(" \"Hi\" ") == "Hi");
+    CHECK(unquote("@\"C:\\path\"") == "C:\\path");
+}
+
+static void test_path_query_compile() {
+    auto query = PathQuery::compile("Parts/*/Components/**/Cost[> 100]");
+    CHECK(query.has_value());
+    CHECK(query->steps().size() == 5);
+    CHECK(query->steps()[1].kind == PathStepKind::Wildcard);
+    CHECK(query->steps()[3].kind == PathStepKind::Descendants);
+    CHECK(query->steps()[4].predicates.size() == 1);
+    CHECK(query->steps()[4].predicates[0].is_number);
+
+    uint32_t offset = 0;
+    PathQueryError error = PathQueryError::None;
+    CHECK(!PathQuery::compile("Parts/[", &offset, &error));
+    CHECK(error == PathQueryError::Syntax && offset == 6);
+    CHECK(!PathQuery::compile("**[Cost]", &offset, &error));
+    CHECK(!PathQuery::compile("Cost[\"unterminated]", &offset, &error));
+}
+
+static void test_path_query_advance() {
+    auto query = PathQuery::compile("Parts/**/Cost");
+    CHECK(query.has_value());
+    uint32_t parts = query->keys().find("Parts");
+    uint32_t cost = query->keys().find("Cost");
+    auto no_predicates = [](const PathStep &) { return true; };
+
+    uint64_t states = query->advance(query->start(), KeyTable::kNone, no_predicates);
+    CHECK(states == 0);
+
+    states = query->advance(query->start(), parts, no_predicates);
+    CHECK(states != 0 && !(states & query->accept()));
+    uint64_t deeper = query->advance(states, KeyTable::kNone, no_predicates);
+    CHECK(deeper != 0 && !(deeper & query->accept()));
+    CHECK(query->advance(deeper, cost, no_predicates) & query->accept());
+    CHECK(query->advance(states, cost, no_predicates) & query->accept());
+
+    PathPredicate greater;
+    greater.compare = PathCompare::Greater;
+    greater.number = 100;
+    greater.is_number = true;
+    CHECK(greater.test(" 150"));
+    CHECK(!greater.test("50"));
+    CHECK(!greater.test("abc"));
+    CHECK(!greater.test("\"Thruster\""));
+    greater.compare = PathCompare::LessEqual;
+    CHECK(!greater.test("abc"));
+    greater.compare = PathCompare::NotEqual;
+    CHECK(greater.test("abc"));
+
+    PathPredicate equal;
+    equal.compare = PathCompare::Equal;
+    equal.text = "Thruster";
+    CHECK(equal.test("\"Thruster\""));
+}
+
+static void test_structure_index() {
+    const char source[] =
+        "Root\n"
+        "{\n"
+        "    Name = \"has { brace\"\n"
+        "    Text = some {bare} words\n"
+        "    Path = @\"C:\\{x}\"\n"
+        "    // comment {\n"
+        "    /* block\n"
+        "       [ */\n"
+        "    Child : Base\n"
+        "    {\n"
+        "        Items\n"
+        "        [\n"
+        "            { A = 1 }\n"
+        "        ]\n"
+        "    }\n"
+        "    X = 5\n"
+        "    {\n"
+        "    }\n"
+        "}\n";
+    std::string_view text(source);
+    StructureIndex index = StructureIndex::build(text);
+    CHECK(index.balanced());
+    CHECK(index.blocks().size() == 5);
+    CHECK(index.comments().size() == 1);
+    CHECK(count_newlines(text) == 19);
+
+    const std::vector<StructureSpan> &blocks = index.blocks();
+    auto key = [&](const StructureSpan &span) {
+        return text.substr(span.key_start, span.key_end - span.key_start);
+    };
+    CHECK(key(blocks[0]) == "Root" && blocks[0].depth == 0);
+    CHECK(blocks[0].start_row == 1 && blocks[0].end_row == 18);
+    CHECK(key(blocks[1]) == "Child" && blocks[1].depth == 1);
+    CHECK(key(blocks[2]) == "Items" && blocks[2].kind == StructureKind::List);
+    CHECK(key(blocks[3]).empty() && blocks[3].depth == 3);
+    CHECK(key(blocks[4]).empty() && blocks[4].depth == 1);
+    CHECK(index.outline(1).size() == 3);
+    CHECK(index.folding_ranges().size() == 5);
+
+    CHECK(!StructureIndex::build("A { [ }").balanced());
+
+    // An escaped quote, a string across the 64-byte block boundary and an
+    // unterminated string, which stops at its newline.
+    std::string strings = "A\n{\n    B = \"x \\\" {\"\n" + std::string(30, ' ') +
+                          "C = \"crosses { the } block\"\n    D = \"open {\n}\n";
+    StructureIndex quoted = StructureIndex::build(strings);
+    CHECK(quoted.balanced() && quoted.blocks().size() == 1);
+    CHECK(quoted.structurals().size() == 5 && quoted.blocks()[0].end_row == 5);
+
+    // A string left open at the end of the source, in a buffer of exactly its
+    // size so that reading past it is caught by the sanitizers.
+    for (std::string text : {std::string("A = \"abc"), std::string(58, ' ') + "A = \"abc\\"}) {
+        std::unique_ptr<char[]> exact(new char[text.size()]);
+        memcpy(exact.get(), text.data(), text.size());
+        StructureIndex open = StructureIndex::build(std::string_view(exact.get(), text.size()));
+        CHECK(open.structurals().size() == 1 && open.blocks().empty());
+    }
+}
+
+static void test_arena() {
+    Arena arena(4096);
+    char *first = static_cast<char *>(arena.allocate(10));
+    CHECK(first && reinterpret_cast<uintptr_t>(first) % 16 == 0);
+    memcpy(first, "arena", 6);
+
+    // The latest allocation grows in place; older ones move.
+    char *grown = static_cast<char *>(arena.reallocate(first, 100));
+    CHECK(grown == first && strcmp(grown, "arena") == 0);
+    char *second = static_cast<char *>(arena.allocate(8));
+    char *moved = static_cast<char *>(arena.reallocate(grown, 200));
+    CHECK(moved != grown && strcmp(moved, "arena") == 0);
+
+    size_t used = arena.bytes_used();
+    void *last = arena.allocate(64);
+    arena.release(last);
+    CHECK(arena.bytes_used() == used);
+    arena.release(second);
+    CHECK(arena.bytes_used() == used);
+
+    void *large = arena.allocate(1 << 16);
+    CHECK(large && arena.owns(large) && arena.owns(second));
+    int outside = 0;
+    CHECK(!arena.owns(&outside));
+    size_t reserved = arena.bytes_reserved();
+    arena.reset();
+    CHECK(arena.bytes_used() == 0 && arena.bytes_reserved() < reserved);
+
+    CHECK(current_arena() == nullptr);
+    {
+        ArenaScope scope(arena);
+        Arena inner;
+        {
+            ArenaScope nested(inner);
+            CHECK(current_arena() == &inner);
+        }
+        CHECK(current_arena() == &arena);
+    }
+    CHECK(current_arena() == nullptr);
+
+    // Blocks of every live arena are known on every thread.
+    void *gone;
+    {
+        Arena other;
+        gone = other.allocate(24);
+        bool owned = false;
+        std::thread([&] { owned = Arena::owned_by_any(gone); }).join();
+        CHECK(owned && Arena::allocation_size(gone) == 24);
+        CHECK(!Arena::owned_by_any(&outside) && !Arena::owned_by_any(nullptr));
+    }
+    CHECK(!Arena::owned_by_any(gone));
+}
+
+static void test_trace() {
+    { TraceScope scope("before"); }
+    std::string path = (std::filesystem::temp_directory_path() / "objecttext-core-trace.json").string();
+    CHECK(start_tracing(path));
+    CHECK(!start_tracing(path));
+    {
+        TraceScope outer("outer", "a \"quoted\" detail");
+        { TraceScope scope("main"); }
+        // Threads that run one after another share a buffer.
+        for (int i = 0; i < 3; i++) {
+            std::thread worker([] { TraceScope scope("worker"); });
+            worker.join();
+        }
+    }
+    CHECK(stop_tracing());
+    CHECK(!stop_tracing());
+    { TraceScope scope("after"); }
+
+    std::ifstream file(path);
+    std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    CHECK(json.find("\"name\":\"outer\"") != std::string::npos);
+    CHECK(json.find("\"name\":\"worker\"") != std::string::npos);
+    CHECK(json.find("a \\\"quoted\\\" detail") != std::string::npos);
+    CHECK(json.find("\"ph\":\"X\"") != std::string::npos);
+    CHECK(json.find("\"tid\":2") != std::string::npos);
+    CHECK(json.find("\"tid\":3") == std::string::npos);
+    CHECK(json.find("before") == std::string::npos && json.find("after") == std::string::npos);
+    std::filesystem::remove(path);
+}
+
+static void test_metrics() {
+    MetricsRegistry &registry = MetricsRegistry::global();
+    Counter plain = registry.counter("test_events_total", "Events.");
+    Counter labelled = registry.counter("test_events_total", "Events.", "kind=\"a\"");
+    CHECK(registry.counter("test_events_total", "Events.").slot == plain.slot);
+    CHECK(labelled.slot != plain.slot);
+    Histogram seconds = registry.histogram("test_seconds", "Durations.", {0.5, 0.1});
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < 1000; j++) registry.add(plain);
+            registry.add(labelled, 5);
+            registry.observe(seconds, 0.25);
+        });
+    }
+    for (std::thread &thread : threads) thread.join();
+    registry.observe(seconds, 2);
+    CHECK(registry.value(plain) == 4000);
+    CHECK(registry.value(labelled) == 20);
+
+    std::string text = registry.render();
+    CHECK(text.find("# TYPE test_events_total counter\n") != std::string::npos);
+    CHECK(text.find("test_events_total 4000\n") != std::string::npos);
+    CHECK(text.find("test_events_total{kind=\"a\"} 20\n") != std::string::npos);
+    CHECK(text.find("# TYPE test_seconds histogram\n") != std::string::npos);
+    CHECK(text.find("test_seconds_bucket{le=\"0.1\"} 0\n") != std::string::npos);
+    CHECK(text.find("test_seconds_bucket{le=\"0.5\"} 4\n") != std::string::npos);
+    CHECK(text.find("test_seconds_bucket{le=\"+Inf\"} 5\n") != std::string::npos);
+    CHECK(text.find("test_seconds_sum 3\n") != std::string::npos);
+    CHECK(text.find("test_seconds_count 5\n") != std::string::npos);
+
+    registry.reset();
+    CHECK(registry.value(plain) == 0);
+    registry.add(plain, 2);
+    CHECK(registry.value(plain) == 2);
+}
+
+static void test_json_string() {
+    std::string out;
+    append_json_string(&out, "plain");
+    CHECK(out == "\"plain\"");
+
+    out.clear();
+    append_json_string(&out, "a \"quoted\" C:\\path\n\ttab\x01");
+    CHECK(out == "\"a \\\"quoted\\\" C:\\\\path\\n\\ttab\\u0001\"");
+
+    // Escapes on either side of the 16-byte blocks.
+    std::string text(40, 'x');
+    text[15] = '"';
+    text[16] = '\\';
+    text[39] = '\x1f';
+    out.clear();
+    append_json_string(&out, text);
+    CHECK(out == "\"" + std::string(15, 'x') + "\\\"\\\\" + std::string(22, 'x') + "\\u001f\"");
+
+    out.clear();
+    append_json_string(&out, "caf\xc3\xa9");
+    CHECK(out == "\"caf\xc3\xa9\"");
+
+    out.clear();
+    append_json_number(&out, 0.1);
+    out += ',';
+    append_json_number(&out, -150);
+    out += ',';
+    append_json_number(&out, 1.0 / 0.0);
+    out += ',';
+    append_json_number(&out, 1.0 / 3.0);
+    out += ',';
+    append_json_number(&out, 1e21);
+    CHECK(out == "0.1,-150,null,0.3333333333333333,1e+21");
+}
+
+static void test_numeric_table() {
+    NumericTable first;
+    uint32_t ships = first.add_file("ships.rules");
+    uint32_t cost = first.intern_path("Ship/Parts/Thruster/Cost");
+    first.add_row(cost, ships, 4, 150, 0);
+    first.add_row(first.intern_path("Ship/Parts/Thruster/Scale"), ships, 5, 0.5, kNumericPercent);
+
+    NumericTable second;
+    uint32_t parts = second.add_file("parts.rules");
+    second.add_row(second.intern_path("Part/Angle"), parts, 2, 90, kNumericDegrees);
+    second.add_row(second.intern_path("Ship/Parts/Thruster/Cost"), parts, 7, 30,
+                   kNumericExpression);
+    first.merge(second);
+    CHECK(first.row_count() == 4);
+    CHECK(first.path_count() == 3 && first.file_count() == 2);
+    CHECK(first.path_ids()[3] == cost);
+
+    std::string data;
+    first.serialize(&data);
+    auto view = NumericTableView::open(data.data(), data.size());
+    CHECK(view.has_value());
+    if (view) {
+        CHECK(view->row_count() == 4);
+        CHECK(view->values()[1] == 0.5 && view->flags()[1] == kNumericPercent);
+        CHECK(view->path(view->path_ids()[2]) == "Part/Angle");
+        CHECK(view->file(view->file_ids()[3]) == "parts.rules");
+        CHECK(view->lines()[3] == 7 && view->flags()[3] == kNumericExpression);
+    }
+    CHECK(!NumericTableView::open(data.data(), data.size() - 8));
+    data[0] = 'X';
+    CHECK(!NumericTableView::open(data.data(), data.size()));
+
+    std::string empty;
+    NumericTable().serialize(&empty);
+    view = NumericTableView::open(empty.data(), empty.size());
+    CHECK(view && view->row_count() == 0 && view->path_count() == 0);
+}
+
+int main() {
+    test_parse_number();
+    test_path_query_compile();
+    test_path_query_advance();
+    test_structure_index();
+    test_arena();
+    test_trace();
+    test_metrics();
+    test_json_string();
+    test_numeric_table();
+    if (failures) fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,57 @@
+#include "objecttext/expression.h"
+
+#include <cmath>
+
+#include "objecttext/parser.h"
+#include "objecttext/value.h"
+
+namespace objecttext {
+
+namespace {
+
+constexpr unsigned kMaxDepth = 256;
+
+bool evaluate(const Symbols &symbols, TSNode node, std::string_view source, unsigned depth,
+              double *result) {
+    if (ts_node_is_null(node) || ts_node_has_error(node) || depth > kMaxDepth) return false;
+    TSSymbol symbol = ts_node_symbol(node);
+    if (symbol == symbols.value || symbol == symbols.parenthesized_expression) {
+        if (ts_node_named_child_count(node) != 1) return false;
+        return evaluate(symbols, ts_node_named_child(node, 0), source, depth + 1, result);
+    }
+    if (symbol == symbols.number) return parse_number(node_text(node, source), result);
+    if (symbol == symbols.urinary_expression) {
+        double operand;
+        if (!evaluate(symbols, ts_node_named_child(node, 0), source, depth + 1, &operand)) {
+            return false;
+        }
+        *result = -operand;
+        return true;
+    }
+    if (symbol != symbols.binary_expression || ts_node_child_count(node) != 3) return false;
+
+    double left, right;
+    if (!evaluate(symbols, ts_node_child(node, 0), source, depth + 1, &left) ||
+        !evaluate(symbols, ts_node_child(node, 2), source, depth + 1, &right)) {
+        return false;
+    }
+    double value;
+    switch (ts_node_type(ts_node_child(node, 1))[0]) {
+    case '+': value = left + right; break;
+    case '-': value = left - right; break;
+    case '*': value = left * right; break;
+    case '/': value = left / right; break;
+    default: return false;
+    }
+    if (!std::isfinite(value)) return false;
+    *result = value;
+    return true;
+}
+
+} // namespace
+
+bool evaluate_expression(TSNode node, std::string_view source, double *result) {
+    return evaluate(Symbols::get(), node, source, 0, result);
+}
+
+} // namespace objecttext
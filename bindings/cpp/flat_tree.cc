@@ -0,0 +1,164 @@
+#include "objecttext/flat_tree.h"
+
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace objecttext {
+
+namespace {
+
+struct Columns {
+    std::vector<uint32_t> parents;
+    std::vector<uint32_t> ends;
+    std::vector<uint32_t> start_bytes;
+    std::vector<uint32_t> end_bytes;
+    std::vector<uint32_t> texts;
+    std::vector<uint16_t> symbols;
+    std::vector<uint8_t> flags;
+    std::vector<std::string_view> strings;
+    std::unordered_map<std::string_view, uint32_t> string_ids;
+
+    uint32_t intern(std::string_view text) {
+        auto inserted = string_ids.emplace(text, static_cast<uint32_t>(strings.size()));
+        if (inserted.second) strings.push_back(text);
+        return inserted.first->second;
+    }
+
+    uint32_t add(TSNode node, uint32_t parent, std::string_view source) {
+        uint32_t index = static_cast<uint32_t>(parents.size());
+        uint32_t start = ts_node_start_byte(node);
+        uint32_t end = ts_node_end_byte(node);
+        bool named = ts_node_is_named(node);
+        uint8_t bits = 0;
+        if (named) bits |= kFlatNamed;
+        if (ts_node_is_error(node)) bits |= kFlatError;
+        if (ts_node_is_missing(node)) bits |= kFlatMissing;
+        if (ts_node_is_extra(node)) bits |= kFlatExtra;
+        if (ts_node_has_error(node)) bits |= kFlatHasError;
+
+        uint32_t text = kFlatNone;
+        if (named && start < end && end <= source.size() && ts_node_named_child_count(node) == 0) {
+            text = intern(source.substr(start, end - start));
+        }
+        parents.push_back(parent);
+        ends.push_back(index + 1);
+        start_bytes.push_back(start);
+        end_bytes.push_back(end);
+        texts.push_back(text);
+        symbols.push_back(ts_node_symbol(node));
+        flags.push_back(bits);
+        return index;
+    }
+};
+
+template <typename T> void copy_column(uint8_t *data, size_t offset, const std::vector<T> &values) {
+    if (!values.empty()) memcpy(data + offset, values.data(), values.size() * sizeof(T));
+}
+
+} // namespace
+
+FlatTree FlatTree::build(TSNode root, std::string_view source, bool named_only) {
+    Columns columns;
+
+    // One level per cursor depth: the node added for it, if any, and the
+    // nearest added node at or above it, which becomes the parent of its
+    // children.
+    struct Level {
+        uint32_t self;
+        uint32_t owner;
+    };
+    std::vector<Level> levels;
+    TSTreeCursor cursor = ts_tree_cursor_new(root);
+    auto enter = [&] {
+        TSNode node = ts_tree_cursor_current_node(&cursor);
+        uint32_t parent = levels.empty() ? kFlatNone : levels.back().owner;
+        uint32_t self = named_only && !ts_node_is_named(node) ? kFlatNone
+                                                               : columns.add(node, parent, source);
+        levels.push_back({self, self != kFlatNone ? self : parent});
+    };
+    auto leave = [&] {
+        uint32_t self = levels.back().self;
+        if (self != kFlatNone) columns.ends[self] = static_cast<uint32_t>(columns.parents.size());
+        levels.pop_back();
+    };
+
+    enter();
+    for (bool done = false; !done;) {
+        if (ts_tree_cursor_goto_first_child(&cursor)) {
+            enter();
+            continue;
+        }
+        for (;;) {
+            leave();
+            if (ts_tree_cursor_goto_next_sibling(&cursor)) {
+                enter();
+                break;
+            }
+            if (!ts_tree_cursor_goto_parent(&cursor)) {
+                done = true;
+                break;
+            }
+        }
+    }
+    ts_tree_cursor_delete(&cursor);
+
+    FlatTree tree;
+    tree.node_count_ = static_cast<uint32_t>(columns.parents.size());
+    tree.string_count_ = static_cast<uint32_t>(columns.strings.size());
+    std::vector<uint32_t> string_offsets;
+    string_offsets.reserve(columns.strings.size() + 1);
+    uint32_t string_bytes = 0;
+    for (std::string_view text : columns.strings) {
+        string_offsets.push_back(string_bytes);
+        string_bytes += static_cast<uint32_t>(text.size());
+    }
+    string_offsets.push_back(string_bytes);
+
+    // Widest elements first, so every column stays aligned without padding.
+    size_t nodes = tree.node_count_;
+    size_t sizes[] = {
+        nodes * 4, // Parent
+        nodes * 4, // End
+        nodes * 4, // StartByte
+        nodes * 4, // EndByte
+        nodes * 4, // Text
+        string_offsets.size() * 4,
+        nodes * 2, // Symbol
+        nodes,     // Flags
+        string_bytes,
+    };
+    size_t offset = 0;
+    for (int i = 0; i <= static_cast<int>(FlatColumn::StringData); i++) {
+        tree.offsets_[i] = offset;
+        offset += sizes[i];
+    }
+    tree.size_ = offset;
+    tree.data_.reset(new uint8_t[offset ? offset : 1]);
+
+    uint8_t *data = tree.data_.get();
+    copy_column(data, tree.offset(FlatColumn::Parent), columns.parents);
+    copy_column(data, tree.offset(FlatColumn::End), columns.ends);
+    copy_column(data, tree.offset(FlatColumn::StartByte), columns.start_bytes);
+    copy_column(data, tree.offset(FlatColumn::EndByte), columns.end_bytes);
+    copy_column(data, tree.offset(FlatColumn::Text), columns.texts);
+    copy_column(data, tree.offset(FlatColumn::StringOffsets), string_offsets);
+    copy_column(data, tree.offset(FlatColumn::Symbol), columns.symbols);
+    copy_column(data, tree.offset(FlatColumn::Flags), columns.flags);
+    uint8_t *strings = data + tree.offset(FlatColumn::StringData);
+    for (std::string_view text : columns.strings) {
+        memcpy(strings, text.data(), text.size());
+        strings += text.size();
+    }
+    return tree;
+}
+
+std::string_view FlatTree::string(uint32_t id) const {
+    if (id >= string_count_) return {};
+    const uint32_t *offsets = string_offsets();
+    const char *bytes = reinterpret_cast<const char *>(data_.get() + offset(FlatColumn::StringData));
+    return std::string_view(bytes + offsets[id], offsets[id + 1] - offsets[id]);
+}
+
+} // namespace objecttext
@@ -0,0 +1,179 @@
+#include "objecttext/highlighter.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "objecttext/queries.h"
+
+namespace objecttext {
+
+namespace {
+
+struct RowRange {
+    uint32_t start;
+    uint32_t end;
+};
+
+} // namespace
+
+Highlighter::Highlighter() : query_(QueryRegistry::global().get(QueryPack::Highlights)) {
+    reset(std::string());
+}
+
+std::string_view Highlighter::highlight_name(uint32_t highlight) const {
+    uint32_t length = 0;
+    const char *name = ts_query_capture_name_for_id(query_, highlight, &length);
+    return std::string_view(name, length);
+}
+
+TSPoint Highlighter::point_for(uint32_t byte) const {
+    auto next = std::upper_bound(line_starts_.begin(), line_starts_.end(), byte);
+    uint32_t row = static_cast<uint32_t>(next - line_starts_.begin()) - 1;
+    return TSPoint{row, byte - line_starts_[row]};
+}
+
+uint32_t Highlighter::row_end_byte(uint32_t row) const {
+    return row + 1 < line_starts_.size()
+        ? line_starts_[row + 1]
+        : static_cast<uint32_t>(source_.size());
+}
+
+std::vector<HighlightDiff> Highlighter::reset(std::string source) {
+    source_ = std::move(source);
+    line_starts_.assign(1, 0);
+    for (size_t i = 0; i < source_.size(); i++) {
+        if (source_[i] == '\n') line_starts_.push_back(static_cast<uint32_t>(i + 1));
+    }
+    tree_ = parser_.parse(source_);
+
+    HighlightDiff diff;
+    diff.start_row = 0;
+    diff.old_row_count = static_cast<uint32_t>(lines_.size());
+    lines_ = highlight_rows(0, static_cast<uint32_t>(line_starts_.size()));
+    diff.lines = lines_;
+
+    std::vector<HighlightDiff> diffs;
+    diffs.push_back(std::move(diff));
+    return diffs;
+}
+
+std::vector<HighlightDiff> Highlighter::edit(uint32_t start_byte, uint32_t old_end_byte,
+                                             std::string_view text) {
+    TSInputEdit input;
+    input.start_byte = start_byte;
+    input.old_end_byte = old_end_byte;
+    input.new_end_byte = start_byte + static_cast<uint32_t>(text.size());
+    input.start_point = point_for(start_byte);
+    input.old_end_point = point_for(old_end_byte);
+    uint32_t start_row = input.start_point.row;
+    uint32_t old_end_row = input.old_end_point.row;
+
+    source_.replace(start_byte, old_end_byte - start_byte, text);
+
+    // Lines that started inside the replaced bytes are gone, the ones in
+    // |text| are new and everything after the edit shifts by the same amount.
+    std::vector<uint32_t> inserted;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '\n') inserted.push_back(start_byte + static_cast<uint32_t>(i + 1));
+    }
+    uint32_t delta = input.new_end_byte - old_end_byte;
+    for (size_t row = old_end_row + 1; row < line_starts_.size(); row++) {
+        line_starts_[row] += delta;
+    }
+    line_starts_.erase(line_starts_.begin() + start_row + 1,
+                       line_starts_.begin() + old_end_row + 1);
+    line_starts_.insert(line_starts_.begin() + start_row + 1, inserted.begin(), inserted.end());
+    uint32_t new_end_row = start_row + static_cast<uint32_t>(inserted.size());
+    input.new_end_point = point_for(input.new_end_byte);
+
+    Tree old_tree = std::move(tree_);
+    ts_tree_edit(old_tree.get(), &input);
+    tree_ = parser_.parse(source_, old_tree.get());
+
+    uint32_t range_count = 0;
+    TSRange *ranges = ts_tree_get_changed_ranges(old_tree.get(), tree_.get(), &range_count);
+    uint32_t row_count = static_cast<uint32_t>(line_starts_.size());
+    std::vector<RowRange> dirty;
+    dirty.push_back({start_row, new_end_row + 1});
+    for (uint32_t i = 0; i < range_count; i++) {
+        if (ranges[i].start_point.row >= row_count) continue;
+        uint32_t end = ranges[i].end_point.row + (ranges[i].end_point.column > 0 ? 1 : 0);
+        end = std::min(std::max(end, ranges[i].start_point.row + 1), row_count);
+        dirty.push_back({ranges[i].start_point.row, end});
+    }
+    free(ranges);
+
+    std::sort(dirty.begin(), dirty.end(), [](RowRange a, RowRange b) { return a.start < b.start; });
+    std::vector<RowRange> merged;
+    for (RowRange range : dirty) {
+        if (!merged.empty() && range.start <= merged.back().end) {
+            merged.back().end = std::max(merged.back().end, range.end);
+        } else {
+            merged.push_back(range);
+        }
+    }
+
+    std::vector<HighlightDiff> diffs;
+    for (RowRange range : merged) {
+        HighlightDiff diff;
+        diff.start_row = range.start;
+        diff.old_row_count = range.end - range.start;
+        if (range.start <= start_row && new_end_row < range.end) {
+            diff.old_row_count = diff.old_row_count - (new_end_row - start_row) + (old_end_row - start_row);
+        }
+        diff.lines = highlight_rows(range.start, range.end);
+
+        auto first = lines_.begin() + diff.start_row;
+        lines_.erase(first, first + diff.old_row_count);
+        lines_.insert(lines_.begin() + diff.start_row, diff.lines.begin(), diff.lines.end());
+        diffs.push_back(std::move(diff));
+    }
+    return diffs;
+}
+
+std::vector<HighlightLine> Highlighter::highlight_rows(uint32_t start_row, uint32_t end_row) const {
+    std::vector<HighlightLine> lines(end_row - start_row);
+    if (!query_ || !tree_ || start_row >= end_row) return lines;
+
+    uint32_t range_start = line_starts_[start_row];
+    uint32_t range_end = row_end_byte(end_row - 1);
+    QueryCursor cursor;
+    ts_query_cursor_set_byte_range(cursor.get(), range_start, range_end);
+    ts_query_cursor_exec(cursor.get(), query_, ts_tree_root_node(tree_.get()));
+
+    TSQueryMatch match;
+    uint32_t capture_index = 0;
+    TSNode previous = TSNode{};
+    while (ts_query_cursor_next_capture(cursor.get(), &match, &capture_index)) {
+        const TSQueryCapture &capture = match.captures[capture_index];
+        // When several patterns capture the same node the first one wins.
+        if (!ts_node_is_null(previous) && ts_node_eq(previous, capture.node)) continue;
+        previous = capture.node;
+
+        uint32_t start = std::max(ts_node_start_byte(capture.node), range_start);
+        uint32_t end = std::min(ts_node_end_byte(capture.node), range_end);
+        if (start >= end) continue;
+
+        for (uint32_t row = point_for(start).row; row < end_row; row++) {
+            uint32_t line_start = line_starts_[row];
+            if (line_start >= end) break;
+            uint32_t line_end = row_end_byte(row);
+            if (line_end > line_start && source_[line_end - 1] == '\n') line_end--;
+            uint32_t piece_start = std::max(start, line_start);
+            uint32_t piece_end = std::min(end, line_end);
+            if (piece_start >= piece_end) continue;
+            lines[row - start_row].push_back(
+                {piece_start - line_start, piece_end - line_start, capture.index});
+        }
+    }
+
+    for (HighlightLine &line : lines) {
+        std::stable_sort(line.begin(), line.end(), [](const HighlightSpan &a, const HighlightSpan &b) {
+            return a.start_column < b.start_column ||
+                   (a.start_column == b.start_column && a.end_column > b.end_column);
+        });
+    }
+    return lines;
+}
+
+} // namespace objecttext
@@ -0,0 +1,124 @@
+#include "objecttext/json.h"
+
+#include <clocale>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OBJECTTEXT_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define OBJECTTEXT_NEON 1
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace objecttext {
+
+namespace {
+
+inline bool needs_escape(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+// Length of the prefix of |text| that needs no escaping, checked 16 bytes
+// at a time while 16 bytes are left.
+inline size_t plain_prefix(const char *text, size_t size) {
+    size_t i = 0;
+#if OBJECTTEXT_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    for (; i + 16 <= size; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + i));
+        // max(b, 0x1F) == 0x1F exactly for the unsigned bytes below 0x20.
+        __m128i special = _mm_cmpeq_epi8(_mm_max_epu8(bytes, control), control);
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(bytes, quote));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(bytes, backslash));
+        int mask = _mm_movemask_epi8(special);
+        if (mask) {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward(&index, static_cast<unsigned long>(mask));
+            return i + index;
+#else
+            return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+#endif
+        }
+    }
+#elif OBJECTTEXT_NEON
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t control = vdupq_n_u8(0x20);
+    for (; i + 16 <= size; i += 16) {
+        uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t *>(text + i));
+        uint8x16_t special = vcltq_u8(bytes, control);
+        special = vorrq_u8(special, vceqq_u8(bytes, quote));
+        special = vorrq_u8(special, vceqq_u8(bytes, backslash));
+        if (vmaxvq_u8(special)) break; // find the byte below
+    }
+#endif
+    while (i < size && !needs_escape(static_cast<unsigned char>(text[i]))) i++;
+    return i;
+}
+
+} // namespace
+
+void append_json_string(std::string *out, std::string_view text) {
+    static const char kHex[] = "0123456789abcdef";
+    out->push_back('"');
+    const char *data = text.data();
+    size_t size = text.size();
+    while (size > 0) {
+        size_t plain = plain_prefix(data, size);
+        out->append(data, plain);
+        if (plain == size) break;
+        unsigned char c = static_cast<unsigned char>(data[plain]);
+        switch (c) {
+            case '"': out->append("\\\""); break;
+            case '\\': out->append("\\\\"); break;
+            case '\n': out->append("\\n"); break;
+            case '\r': out->append("\\r"); break;
+            case '\t': out->append("\\t"); break;
+            case '\b': out->append("\\b"); break;
+            case '\f': out->append("\\f"); break;
+            default: {
+                char escape[] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 15]};
+                out->append(escape, sizeof(escape));
+                break;
+            }
+        }
+        data += plain + 1;
+        size -= plain + 1;
+    }
+    out->push_back('"');
+}
+
+void append_json_number(std::string *out, double value) {
+    if (!std::isfinite(value)) {
+        out->append("null");
+        return;
+    }
+    // The shortest of 15, 16 and 17 significant digits that reads back as
+    // the same double; std::to_chars() would do this in one step, but Apple
+    // libc++ lacks it for double. Both calls use the locale's decimal
+    // point, which JSON wants as '.'.
+    char buffer[32];
+    int length = 0;
+    for (int precision = 15; precision <= 17; precision++) {
+        length = snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+        if (precision == 17 || strtod(buffer, nullptr) == value) break;
+    }
+    char point = *localeconv()->decimal_point;
+    for (int i = 0; i < length; i++) {
+        if (buffer[i] == point) buffer[i] = '.';
+    }
+    out->append(buffer, length);
+}
+
+} // namespace objecttext
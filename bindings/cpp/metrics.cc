@@ -0,0 +1,187 @@
+#include "objecttext/metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+
+namespace objecttext {
+
+namespace {
+
+// Registrations past the capacity all share this slot, which is never
+// rendered.
+constexpr uint32_t kOverflowSlot = MetricsRegistry::kCapacity - 1;
+
+void append_number(std::string *out, double value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.15g", value);
+    *out += buffer;
+}
+
+} // namespace
+
+// Returns the slab of a thread to the registry when the thread exits.
+struct SlabOwner {
+    MetricsRegistry::Slab *slab = nullptr;
+    ~SlabOwner() {
+        if (slab) MetricsRegistry::global().release(slab);
+    }
+};
+
+MetricsRegistry &MetricsRegistry::global() {
+    // Never destroyed, so that threads exiting after main() can still
+    // return their slabs.
+    static MetricsRegistry *registry = new MetricsRegistry;
+    return *registry;
+}
+
+MetricsRegistry::Slab *MetricsRegistry::thread_slab() {
+    thread_local SlabOwner owner;
+    if (!owner.slab) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_slabs_.empty()) {
+            owner.slab = free_slabs_.back();
+            free_slabs_.pop_back();
+        } else {
+            slabs_.push_back(std::make_unique<Slab>());
+            owner.slab = slabs_.back().get();
+        }
+    }
+    return owner.slab;
+}
+
+void MetricsRegistry::release(Slab *slab) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_slabs_.push_back(slab);
+}
+
+uint32_t MetricsRegistry::allocate(uint32_t slots) {
+    if (next_slot_ + slots > kOverflowSlot) return kOverflowSlot;
+    uint32_t first = next_slot_;
+    next_slot_ += slots;
+    return first;
+}
+
+MetricsRegistry::Family &MetricsRegistry::family(std::string_view name, std::string_view help,
+                                                 bool histogram) {
+    for (Family &family : families_) {
+        if (family.name == name) return family;
+    }
+    families_.push_back({std::string(name), std::string(help), histogram, nullptr, {}});
+    return families_.back();
+}
+
+Counter MetricsRegistry::counter(std::string_view name, std::string_view help,
+                                 std::string_view labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Family &counters = family(name, help, false);
+    for (const Series &series : counters.series) {
+        if (series.labels == labels) return {series.slot};
+    }
+    uint32_t slot = allocate(1);
+    if (slot != kOverflowSlot) counters.series.push_back({std::string(labels), slot});
+    return {slot};
+}
+
+Histogram MetricsRegistry::histogram(std::string_view name, std::string_view help,
+                                     std::vector<double> bounds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Family &histograms = family(name, help, true);
+    if (!histograms.series.empty()) return {histograms.series[0].slot, histograms.bounds};
+
+    std::sort(bounds.begin(), bounds.end());
+    bounds_.push_back(std::move(bounds));
+    histograms.bounds = &bounds_.back();
+    uint32_t slots = static_cast<uint32_t>(histograms.bounds->size()) + 3;
+    uint32_t first = allocate(slots);
+    if (first == kOverflowSlot) {
+        // Every bucket would land in the overflow slot.
+        static const std::vector<double> none;
+        return {kOverflowSlot, &none};
+    }
+    histograms.series.push_back({std::string(), first});
+    return {first, histograms.bounds};
+}
+
+void MetricsRegistry::observe(Histogram histogram, double value) {
+    if (histogram.first_slot == kOverflowSlot) {
+        bump(kOverflowSlot, 1);
+        return;
+    }
+    const std::vector<double> &bounds = *histogram.bounds;
+    uint32_t bucket = static_cast<uint32_t>(
+        std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin());
+    uint32_t buckets = static_cast<uint32_t>(bounds.size()) + 1;
+    bump(histogram.first_slot + bucket, 1);
+    uint64_t billionths = static_cast<uint64_t>(std::llround(std::max(value, 0.0) * 1e9));
+    bump(histogram.first_slot + buckets, billionths);
+    bump(histogram.first_slot + buckets + 1, 1);
+}
+
+uint64_t MetricsRegistry::sum(uint32_t slot) const {
+    uint64_t total = 0;
+    for (const auto &slab : slabs_) total += slab->values[slot].load(std::memory_order_relaxed);
+    return total - (slot < baseline_.size() ? baseline_[slot] : 0);
+}
+
+uint64_t MetricsRegistry::value(Counter counter) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sum(counter.slot);
+}
+
+std::string MetricsRegistry::render() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out;
+    for (const Family &family : families_) {
+        if (family.series.empty()) continue;
+        out += "# HELP " + family.name + " " + family.help + "\n";
+        out += "# TYPE " + family.name + (family.histogram ? " histogram\n" : " counter\n");
+        if (!family.histogram) {
+            for (const Series &series : family.series) {
+                out += family.name;
+                if (!series.labels.empty()) out += "{" + series.labels + "}";
+                out += " " + std::to_string(sum(series.slot)) + "\n";
+            }
+            continue;
+        }
+        const std::vector<double> &bounds = *family.bounds;
+        uint32_t first = family.series[0].slot;
+        uint64_t cumulative = 0;
+        for (size_t bucket = 0; bucket <= bounds.size(); bucket++) {
+            cumulative += sum(first + static_cast<uint32_t>(bucket));
+            out += family.name + "_bucket{le=\"";
+            if (bucket < bounds.size()) {
+                append_number(&out, bounds[bucket]);
+            } else {
+                out += "+Inf";
+            }
+            out += "\"} " + std::to_string(cumulative) + "\n";
+        }
+        uint32_t buckets = static_cast<uint32_t>(bounds.size()) + 1;
+        out += family.name + "_sum ";
+        append_number(&out, sum(first + buckets) / 1e9);
+        out += "\n" + family.name + "_count " + std::to_string(sum(first + buckets + 1)) + "\n";
+    }
+    return out;
+}
+
+bool MetricsRegistry::write(const std::string &path) const {
+    std::string text = render();
+    FILE *file = fopen(path.c_str(), "w");
+    if (!file) return false;
+    bool ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+    return fclose(file) == 0 && ok;
+}
+
+void MetricsRegistry::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    baseline_.assign(kCapacity, 0);
+    for (const auto &slab : slabs_) {
+        for (uint32_t slot = 0; slot < kCapacity; slot++) {
+            baseline_[slot] += slab->values[slot].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+} // namespace objecttext
@@ -0,0 +1,130 @@
+#include "objecttext/numeric_export.h"
+
+#include <algorithm>
+#include <charconv>
+
+#include "objecttext/expression.h"
+#include "objecttext/parallel.h"
+#include "objecttext/parser.h"
+#include "objecttext/trace.h"
+#include "objecttext/value.h"
+
+namespace objecttext {
+
+namespace {
+
+class NumberCollector {
+public:
+    NumberCollector(TSNode root, std::string_view source, uint32_t file, NumericTable *table)
+        : symbols_(Symbols::get()), source_(source), file_(file), table_(table),
+          cursor_(ts_tree_cursor_new(root)) {}
+    ~NumberCollector() { ts_tree_cursor_delete(&cursor_); }
+
+    size_t run() {
+        TSNode root = ts_tree_cursor_current_node(&cursor_);
+        if (ts_node_symbol(root) == symbols_.source_file) {
+            block();
+        } else if (is_entry(symbols_, ts_node_symbol(root))) {
+            entry(entry_key(root, source_));
+        }
+        return rows_;
+    }
+
+private:
+    const Symbols &symbols_;
+    std::string_view source_;
+    uint32_t file_;
+    NumericTable *table_;
+    TSTreeCursor cursor_;
+    std::string path_;
+    size_t rows_ = 0;
+
+    // The cursor is on an entry stored under |key|.
+    void entry(std::string_view key) {
+        size_t length = path_.size();
+        if (length) path_.push_back('/');
+        path_.append(key);
+        TSNode node = ts_tree_cursor_current_node(&cursor_);
+        if (ts_node_symbol(node) == symbols_.assignment) {
+            number(node);
+        } else {
+            block();
+        }
+        path_.resize(length);
+    }
+
+    void block() {
+        if (!ts_tree_cursor_goto_first_child(&cursor_)) return;
+        uint32_t index = 0;
+        do {
+            TSNode child = ts_tree_cursor_current_node(&cursor_);
+            if (!is_entry(symbols_, ts_node_symbol(child))) continue;
+            std::string_view key = entry_key(child, source_);
+            char digits[16];
+            if (key.empty()) {
+                char *end = std::to_chars(digits, digits + sizeof(digits), index).ptr;
+                key = std::string_view(digits, static_cast<size_t>(end - digits));
+            }
+            entry(key);
+            index++;
+        } while (ts_tree_cursor_goto_next_sibling(&cursor_));
+        ts_tree_cursor_goto_parent(&cursor_);
+    }
+
+    void number(TSNode assignment) {
+        TSNode value = entry_value(assignment);
+        if (ts_node_is_null(value)) return;
+        TSNode literal = ts_node_named_child(value, 0);
+        if (ts_node_is_null(literal)) return;
+        TSSymbol symbol = ts_node_symbol(literal);
+
+        double number;
+        uint8_t flags = 0;
+        if (symbol == symbols_.number) {
+            unsigned suffix;
+            if (!parse_number(node_text(literal, source_), &number, &suffix)) return;
+            if (suffix & kSuffixPercent) flags |= kNumericPercent;
+            if (suffix & kSuffixDegrees) flags |= kNumericDegrees;
+        } else if (symbol == symbols_.binary_expression || symbol == symbols_.urinary_expression ||
+                   symbol == symbols_.parenthesized_expression) {
+            if (!evaluate_expression(literal, source_, &number)) return;
+            flags |= kNumericExpression;
+        } else {
+            return;
+        }
+        table_->add_row(table_->intern_path(path_), file_, ts_node_start_point(assignment).row,
+                        number, flags);
+        rows_++;
+    }
+};
+
+} // namespace
+
+size_t collect_numbers(TSNode root, std::string_view source, uint32_t file, NumericTable *table) {
+    return NumberCollector(root, source, file, table).run();
+}
+
+NumericTable collect_numbers(const std::vector<std::string> &paths, unsigned threads) {
+    // Each file gets a table of its own so the workers share nothing; the
+    // tables are merged in order afterwards, which keeps the output the same
+    // for any thread count.
+    std::vector<NumericTable> tables(paths.size());
+    unsigned workers = threads ? threads : default_threads();
+    std::vector<Parser> parsers(std::min<size_t>(workers, paths.size()));
+    parallel_for(paths.size(), workers, [&](size_t index, unsigned worker) {
+        TraceScope scope("collect_numbers", paths[index]);
+        std::string source;
+        if (!read_file(paths[index], &source)) return;
+        Tree tree = parsers[worker].parse(source);
+        if (!tree) return;
+        NumericTable &table = tables[index];
+        collect_numbers(ts_tree_root_node(tree.get()), source, table.add_file(paths[index]),
+                        &table);
+    });
+
+    NumericTable result;
+    for (const NumericTable &table : tables) result.merge(table);
+    return result;
+}
+
+} // namespace objecttext
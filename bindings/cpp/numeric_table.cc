@@ -0,0 +1,178 @@
+#include "objecttext/numeric_table.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace objecttext {
+
+namespace {
+
+constexpr char kMagic[8] = {'O', 'T', 'N', 'U', 'M', 'C', 'O', 'L'};
+
+size_t align8(size_t offset) {
+    return (offset + 7) & ~size_t(7);
+}
+
+void append_bytes(std::string *out, const void *data, size_t size) {
+    out->append(static_cast<const char *>(data), size);
+    out->append(align8(out->size()) - out->size(), '\0');
+}
+
+// Offsets and back-to-back bytes of the names in |table|.
+void string_columns(const KeyTable &table, std::vector<uint32_t> *offsets, std::string *data) {
+    offsets->reserve(table.size() + 1);
+    for (uint32_t id = 0; id < table.size(); id++) {
+        offsets->push_back(static_cast<uint32_t>(data->size()));
+        data->append(table.name(id));
+    }
+    offsets->push_back(static_cast<uint32_t>(data->size()));
+}
+
+} // namespace
+
+void NumericTable::add_row(uint32_t path, uint32_t file, uint32_t line, double value,
+                           uint8_t flags) {
+    path_ids_.push_back(path);
+    file_ids_.push_back(file);
+    lines_.push_back(line);
+    values_.push_back(value);
+    flags_.push_back(flags);
+}
+
+void NumericTable::merge(const NumericTable &other) {
+    std::vector<uint32_t> path_map(other.path_count());
+    for (uint32_t id = 0; id < path_map.size(); id++) path_map[id] = intern_path(other.path(id));
+    std::vector<uint32_t> file_map(other.file_count());
+    for (uint32_t id = 0; id < file_map.size(); id++) file_map[id] = add_file(other.file(id));
+
+    size_t count = other.row_count();
+    values_.insert(values_.end(), other.values_.begin(), other.values_.end());
+    lines_.insert(lines_.end(), other.lines_.begin(), other.lines_.end());
+    flags_.insert(flags_.end(), other.flags_.begin(), other.flags_.end());
+    path_ids_.reserve(path_ids_.size() + count);
+    file_ids_.reserve(file_ids_.size() + count);
+    for (size_t row = 0; row < count; row++) {
+        path_ids_.push_back(path_map[other.path_ids_[row]]);
+        file_ids_.push_back(file_map[other.file_ids_[row]]);
+    }
+}
+
+void NumericTable::serialize(std::string *out) const {
+    std::vector<uint32_t> path_offsets, file_offsets;
+    std::string path_data, file_data;
+    string_columns(paths_, &path_offsets, &path_data);
+    string_columns(files_, &file_offsets, &file_data);
+
+    size_t rows = row_count();
+    const std::pair<const void *, size_t> columns[kNumericColumnCount] = {
+        {values_.data(), rows * sizeof(double)},
+        {path_ids_.data(), rows * sizeof(uint32_t)},
+        {file_ids_.data(), rows * sizeof(uint32_t)},
+        {lines_.data(), rows * sizeof(uint32_t)},
+        {flags_.data(), rows},
+        {path_offsets.data(), path_offsets.size() * sizeof(uint32_t)},
+        {path_data.data(), path_data.size()},
+        {file_offsets.data(), file_offsets.size() * sizeof(uint32_t)},
+        {file_data.data(), file_data.size()},
+    };
+
+    NumericFileHeader header = {};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kNumericVersion;
+    header.byte_order = kNumericByteOrder;
+    header.row_count = rows;
+    header.path_count = static_cast<uint32_t>(paths_.size());
+    header.file_count = static_cast<uint32_t>(files_.size());
+    size_t base = align8(out->size());
+    size_t offset = sizeof(header);
+    for (size_t i = 0; i < kNumericColumnCount; i++) {
+        header.columns[i].offset = offset;
+        header.columns[i].size = columns[i].second;
+        offset = align8(offset + columns[i].second);
+    }
+
+    out->reserve(base + offset);
+    out->resize(base);
+    append_bytes(out, &header, sizeof(header));
+    for (const auto &column : columns) append_bytes(out, column.first, column.second);
+}
+
+bool NumericTable::write(const std::string &path) const {
+    std::string data;
+    serialize(&data);
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) return false;
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    return fclose(file) == 0 && written;
+}
+
+std::optional<NumericTableView> NumericTableView::open(const void *data, size_t size) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    if (size < sizeof(NumericFileHeader) || reinterpret_cast<uintptr_t>(bytes) % 8 != 0) {
+        return std::nullopt;
+    }
+    const NumericFileHeader *header = reinterpret_cast<const NumericFileHeader *>(bytes);
+    if (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kNumericVersion ||
+        header->byte_order != kNumericByteOrder) {
+        return std::nullopt;
+    }
+
+    // Each column must fit in the file and hold as many elements as the
+    // header claims; string offsets must be ordered and inside their data.
+    uint64_t rows = header->row_count;
+    uint64_t expected[kNumericColumnCount] = {
+        rows * sizeof(double),
+        rows * sizeof(uint32_t),
+        rows * sizeof(uint32_t),
+        rows * sizeof(uint32_t),
+        rows,
+        (uint64_t(header->path_count) + 1) * sizeof(uint32_t),
+        0,
+        (uint64_t(header->file_count) + 1) * sizeof(uint32_t),
+        0,
+    };
+    if (rows > size) return std::nullopt;
+    for (size_t i = 0; i < kNumericColumnCount; i++) {
+        uint64_t offset = header->columns[i].offset;
+        uint64_t column_size = header->columns[i].size;
+        if (offset % 8 != 0 || offset > size || column_size > size - offset) return std::nullopt;
+        if (expected[i] && column_size != expected[i]) return std::nullopt;
+    }
+    NumericTableView view(bytes);
+    const std::pair<NumericColumn, NumericColumn> tables[] = {
+        {NumericColumn::PathOffsets, NumericColumn::PathData},
+        {NumericColumn::FileOffsets, NumericColumn::FileData},
+    };
+    for (const auto &table : tables) {
+        const uint32_t *offsets = view.column<uint32_t>(table.first);
+        size_t count = header->columns[static_cast<size_t>(table.first)].size / sizeof(uint32_t);
+        uint64_t data_size = header->columns[static_cast<size_t>(table.second)].size;
+        for (size_t i = 0; i < count; i++) {
+            if (offsets[i] > data_size || (i && offsets[i] < offsets[i - 1])) return std::nullopt;
+        }
+    }
+    const uint32_t *path_ids = view.path_ids();
+    const uint32_t *file_ids = view.file_ids();
+    for (uint64_t row = 0; row < rows; row++) {
+        if (path_ids[row] >= header->path_count || file_ids[row] >= header->file_count) {
+            return std::nullopt;
+        }
+    }
+    return view;
+}
+
+std::string_view NumericTableView::string(NumericColumn offsets, NumericColumn data,
+                                          uint32_t id) const {
+    const uint32_t *starts = column<uint32_t>(offsets);
+    return std::string_view(column<char>(data) + starts[id], starts[id + 1] - starts[id]);
+}
+
+std::string_view NumericTableView::path(uint32_t id) const {
+    return string(NumericColumn::PathOffsets, NumericColumn::PathData, id);
+}
+
+std::string_view NumericTableView::file(uint32_t id) const {
+    return string(NumericColumn::FileOffsets, NumericColumn::FileData, id);
+}
+
+} // namespace objecttext
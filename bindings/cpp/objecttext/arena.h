@@ -0,0 +1,82 @@
+#ifndef OBJECTTEXT_ARENA_H_
+#define OBJECTTEXT_ARENA_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace objecttext {
+
+// A bump allocator for everything tree-sitter allocates while parsing one
+// file.
+//
+// Allocations are 16-byte aligned and prefixed with their size so that
+// realloc can copy. Freeing or growing the most recent allocation is done in
+// place; any other free is a no-op, and reset() drops everything at once
+// while keeping the largest block for the next file.
+class Arena {
+public:
+    explicit Arena(size_t block_size = 1 << 20);
+    ~Arena();
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t size);
+    void *reallocate(void *pointer, size_t size);
+    void release(void *pointer);
+    bool owns(const void *pointer) const;
+
+    void reset();
+
+    size_t bytes_used() const { return used_; }
+    size_t bytes_reserved() const;
+
+    // True if |pointer| lies in a block of any live arena, on any thread.
+    static bool owned_by_any(const void *pointer);
+
+    // The size |pointer|, from any arena, was allocated or last grown to.
+    static size_t allocation_size(const void *pointer);
+
+private:
+    struct Block {
+        void *raw;
+        char *data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks_;
+    size_t block_size_;
+    size_t offset_ = 0; // in blocks_.back()
+    size_t used_ = 0;
+    char *last_ = nullptr;
+
+    bool grow(size_t size);
+    void drop(const Block &block);
+};
+
+// Makes |arena| serve the tree-sitter allocation hooks on this thread for
+// the lifetime of the scope. Scopes nest.
+//
+// Everything tree-sitter allocates inside the scope lives in the arena, so
+// the parser, its trees and cursors should be created and destroyed (or
+// simply abandoned) within it, on this thread. Memory allocated before the
+// scope, such as a TSParser created earlier, is still freed through malloc.
+// Arena memory freed outside its scope or on another thread is left to the
+// arena's next reset() and reallocated by copying, but it must not outlive
+// the reset or the arena itself.
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena &arena);
+    ~ArenaScope();
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+
+private:
+    Arena *previous_;
+};
+
+// The arena of the innermost ArenaScope on this thread, or null.
+Arena *current_arena();
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_ARENA_H_
@@ -0,0 +1,23 @@
+#ifndef OBJECTTEXT_EXPRESSION_H_
+#define OBJECTTEXT_EXPRESSION_H_
+
+#include <string_view>
+
+#include <tree_sitter/api.h>
+
+namespace objecttext {
+
+// Evaluates the arithmetic under |node|: a `value`, a `number`, or a unary,
+// binary or parenthesized expression over numbers (`2 * (10 + 50%)`).
+// Number literals follow parse_number(), so `50%` is 0.5.
+//
+// Returns false, leaving |result| alone, for anything that is not plain
+// arithmetic: references (`&Base/Cost`) need the rest of the document and
+// other files to resolve, and bare words and strings are not numbers. A
+// division by zero or an overflow also returns false rather than producing
+// an infinity, as does nesting deeper than 256 levels.
+bool evaluate_expression(TSNode node, std::string_view source, double *result);
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_EXPRESSION_H_
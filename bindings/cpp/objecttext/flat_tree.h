@@ -0,0 +1,90 @@
+#ifndef OBJECTTEXT_FLAT_TREE_H_
+#define OBJECTTEXT_FLAT_TREE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include <tree_sitter/api.h>
+
+namespace objecttext {
+
+enum FlatNodeFlags : uint8_t {
+    kFlatNamed = 1 << 0,
+    kFlatError = 1 << 1,   // an ERROR node
+    kFlatMissing = 1 << 2, // inserted by the parser to recover
+    kFlatExtra = 1 << 3,   // a comment
+    kFlatHasError = 1 << 4, // the node or a descendant is an error
+};
+
+// Columns of a FlatTree, in the order they are laid out.
+enum class FlatColumn {
+    Parent,        // uint32 per node, kFlatNone for the root
+    End,           // uint32 per node, one past its last descendant
+    StartByte,     // uint32 per node
+    EndByte,       // uint32 per node
+    Text,          // uint32 per node, a string id or kFlatNone
+    StringOffsets, // uint32 per string, plus one for the end of the last
+    Symbol,        // uint16 per node
+    Flags,         // uint8 per node, FlatNodeFlags
+    StringData,    // the UTF-8 bytes of every string, back to back
+};
+
+constexpr uint32_t kFlatNone = UINT32_MAX;
+
+// A tree packed into one buffer of parallel arrays, for handing to another
+// runtime in one piece instead of node by node.
+//
+// Nodes are in preorder, so the descendants of node |i| are the nodes from
+// i + 1 up to end[i]: its first child is i + 1 when end[i] > i + 1, and the
+// sibling after it is end[i] when that is below end[parent[i]]. Named nodes
+// without named children (keys, numbers, strings, bare words, comments)
+// carry their source text as an id into a table of interned strings, so
+// the thousand `Cost` keys of a file share one string.
+//
+// Every column starts at a multiple of its element size, so typed arrays
+// can view the buffer directly.
+class FlatTree {
+public:
+    // Flattens the subtree of |root|. With |named_only|, anonymous nodes are
+    // left out and their children are attached to the nearest named
+    // ancestor.
+    static FlatTree build(TSNode root, std::string_view source, bool named_only = false);
+
+    uint32_t node_count() const { return node_count_; }
+    uint32_t string_count() const { return string_count_; }
+
+    const uint32_t *parents() const { return column<uint32_t>(FlatColumn::Parent); }
+    const uint32_t *ends() const { return column<uint32_t>(FlatColumn::End); }
+    const uint32_t *start_bytes() const { return column<uint32_t>(FlatColumn::StartByte); }
+    const uint32_t *end_bytes() const { return column<uint32_t>(FlatColumn::EndByte); }
+    const uint32_t *texts() const { return column<uint32_t>(FlatColumn::Text); }
+    const uint32_t *string_offsets() const { return column<uint32_t>(FlatColumn::StringOffsets); }
+    const uint16_t *symbols() const { return column<uint16_t>(FlatColumn::Symbol); }
+    const uint8_t *flags() const { return column<uint8_t>(FlatColumn::Flags); }
+
+    std::string_view string(uint32_t id) const;
+
+    // Byte offset of |column| in data().
+    size_t offset(FlatColumn column) const { return offsets_[static_cast<int>(column)]; }
+
+    const uint8_t *data() const { return data_.get(); }
+    uint8_t *data() { return data_.get(); }
+    size_t size() const { return size_; }
+
+private:
+    std::unique_ptr<uint8_t[]> data_;
+    size_t size_ = 0;
+    size_t offsets_[static_cast<int>(FlatColumn::StringData) + 1] = {};
+    uint32_t node_count_ = 0;
+    uint32_t string_count_ = 0;
+
+    template <typename T> const T *column(FlatColumn column) const {
+        return reinterpret_cast<const T *>(data_.get() + offset(column));
+    }
+};
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_FLAT_TREE_H_
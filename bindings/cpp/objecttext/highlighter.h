@@ -0,0 +1,70 @@
+#ifndef OBJECTTEXT_HIGHLIGHTER_H_
+#define OBJECTTEXT_HIGHLIGHTER_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <tree_sitter/api.h>
+
+#include "objecttext/parser.h"
+
+namespace objecttext {
+
+// A highlighted column range on one line. |highlight| is a capture id of the
+// highlights query; spans are sorted by start column and may nest, in which
+// case the inner span comes after the outer one.
+struct HighlightSpan {
+    uint32_t start_column;
+    uint32_t end_column;
+    uint32_t highlight;
+};
+
+using HighlightLine = std::vector<HighlightSpan>;
+
+// Replace |old_row_count| lines starting at |start_row| with |lines|. Diffs
+// returned together are ordered by row and meant to be applied in order;
+// each |start_row| is already in the coordinates of the edited document.
+struct HighlightDiff {
+    uint32_t start_row;
+    uint32_t old_row_count;
+    std::vector<HighlightLine> lines;
+};
+
+// Keeps a document, its tree and its highlight spans per line in sync.
+//
+// After an edit the tree is reparsed incrementally and the highlights query
+// is only run over the lines touched by the edit plus the ranges reported by
+// ts_tree_get_changed_ranges. Everything else stays cached.
+class Highlighter {
+public:
+    Highlighter();
+
+    // Replaces the whole document and highlights it from scratch.
+    std::vector<HighlightDiff> reset(std::string source);
+
+    // Replaces the bytes [start_byte, old_end_byte) with |text|.
+    std::vector<HighlightDiff> edit(uint32_t start_byte, uint32_t old_end_byte,
+                                    std::string_view text);
+
+    const std::string &source() const { return source_; }
+    const TSTree *tree() const { return tree_.get(); }
+    const std::vector<HighlightLine> &lines() const { return lines_; }
+    std::string_view highlight_name(uint32_t highlight) const;
+
+private:
+    Parser parser_;
+    const TSQuery *query_;
+    std::string source_;
+    Tree tree_;
+    std::vector<uint32_t> line_starts_;
+    std::vector<HighlightLine> lines_;
+
+    TSPoint point_for(uint32_t byte) const;
+    uint32_t row_end_byte(uint32_t row) const;
+    std::vector<HighlightLine> highlight_rows(uint32_t start_row, uint32_t end_row) const;
+};
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_HIGHLIGHTER_H_
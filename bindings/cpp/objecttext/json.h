@@ -0,0 +1,22 @@
+#ifndef OBJECTTEXT_JSON_H_
+#define OBJECTTEXT_JSON_H_
+
+#include <string>
+#include <string_view>
+
+namespace objecttext {
+
+// Appends |text| to |out| as a JSON string literal, quotes included.
+//
+// Quotes, backslashes and control characters are escaped; every other byte
+// is copied as is, so |text| should be UTF-8. Runs of bytes that need no
+// escaping, which is nearly all of them in practice, are found 16 bytes at
+// a time with SIMD compares and appended in one piece.
+void append_json_string(std::string *out, std::string_view text);
+
+// Appends |value| as a JSON number, or `null` if it is not finite.
+void append_json_number(std::string *out, double value);
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_JSON_H_
@@ -0,0 +1,104 @@
+#ifndef OBJECTTEXT_METRICS_H_
+#define OBJECTTEXT_METRICS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace objecttext {
+
+struct Counter {
+    uint32_t slot;
+};
+
+struct Histogram {
+    uint32_t first_slot; // one per bucket, then +Inf, the sum and the count
+    const std::vector<double> *bounds;
+};
+
+// Process-wide counters and histograms, rendered in the Prometheus text
+// format on demand.
+//
+// Every thread adds to its own slab of counters with relaxed stores, so
+// recording never contends; render() and value() sum the slabs. Slabs of
+// threads that exit are handed to the next new thread, so their counts are
+// kept. Registration takes a lock and is meant to happen once per metric.
+class MetricsRegistry {
+public:
+    static MetricsRegistry &global();
+
+    // Registers a counter, or returns the existing one with the same name and
+    // labels. |labels| are Prometheus label pairs without braces, e.g.
+    // `symbol="group"`, and must already be escaped.
+    Counter counter(std::string_view name, std::string_view help, std::string_view labels = {});
+
+    // Registers a histogram with the given ascending bucket bounds. Observed
+    // values are typically seconds; their sum keeps nine decimal places.
+    Histogram histogram(std::string_view name, std::string_view help, std::vector<double> bounds);
+
+    void add(Counter counter, uint64_t value = 1) { bump(counter.slot, value); }
+    void observe(Histogram histogram, double value);
+
+    // The sum over all threads since the last reset().
+    uint64_t value(Counter counter) const;
+
+    std::string render() const;
+    bool write(const std::string &path) const;
+
+    // Zeroes every metric as seen by value() and render(). Counters that
+    // threads add to concurrently are not lost.
+    void reset();
+
+    static constexpr uint32_t kCapacity = 4096;
+
+private:
+    struct Slab {
+        std::atomic<uint64_t> values[kCapacity];
+    };
+
+    struct Series {
+        std::string labels;
+        uint32_t slot;
+    };
+
+    struct Family {
+        std::string name;
+        std::string help;
+        bool histogram;
+        const std::vector<double> *bounds;
+        std::vector<Series> series;
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<Family> families_;
+    std::deque<std::vector<double>> bounds_; // stable addresses for Histogram
+    std::vector<std::unique_ptr<Slab>> slabs_;
+    std::vector<Slab *> free_slabs_;
+    std::vector<uint64_t> baseline_;
+    uint32_t next_slot_ = 0;
+
+    MetricsRegistry() = default;
+
+    uint32_t allocate(uint32_t slots);
+    Family &family(std::string_view name, std::string_view help, bool histogram);
+    uint64_t sum(uint32_t slot) const; // with mutex_ held
+
+    Slab *thread_slab();
+    void release(Slab *slab);
+
+    void bump(uint32_t slot, uint64_t value) {
+        std::atomic<uint64_t> &cell = thread_slab()->values[slot];
+        cell.store(cell.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    friend struct SlabOwner;
+};
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_METRICS_H_
@@ -0,0 +1,30 @@
+#ifndef OBJECTTEXT_NUMERIC_EXPORT_H_
+#define OBJECTTEXT_NUMERIC_EXPORT_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <tree_sitter/api.h>
+
+#include "objecttext/numeric_table.h"
+
+namespace objecttext {
+
+// Adds a row to |table| for every `assignment` under |root| whose value is a
+// number literal or an expression that evaluate_expression() can fold.
+// Paths are the keys from the top of the document joined with `/`, with
+// unnamed blocks written as their index, as path queries address them:
+// `Ship/Parts/Thruster/Components/0/Cost`. Values with references, bare
+// words and strings are skipped. Returns the number of rows added.
+size_t collect_numbers(TSNode root, std::string_view source, uint32_t file, NumericTable *table);
+
+// Parses |paths| on |threads| workers (0 for one per core) and collects the
+// numbers of each into one table, in the order of |paths|. Files that
+// cannot be read are left out.
+NumericTable collect_numbers(const std::vector<std::string> &paths, unsigned threads = 0);
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_NUMERIC_EXPORT_H_
@@ -0,0 +1,145 @@
+#ifndef OBJECTTEXT_NUMERIC_TABLE_H_
+#define OBJECTTEXT_NUMERIC_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "objecttext/path_query.h"
+
+namespace objecttext {
+
+enum NumericFlags : uint8_t {
+    kNumericPercent = 1 << 0,    // written with `%`; the value is already divided by 100
+    kNumericDegrees = 1 << 1,    // written with `d`
+    kNumericExpression = 1 << 2, // folded from an expression such as `2 * 50%`
+};
+
+// Columns of a numeric table file, in the order they are laid out.
+enum class NumericColumn : uint32_t {
+    Value,       // float64 per row
+    Path,        // uint32 per row, an id into the path strings
+    File,        // uint32 per row, an id into the file strings
+    Line,        // uint32 per row, zero-based line of the assignment
+    Flags,       // uint8 per row, NumericFlags
+    PathOffsets, // uint32 per path, plus one for the end of the last
+    PathData,    // UTF-8 of every path, back to back
+    FileOffsets, // uint32 per file, plus one for the end of the last
+    FileData,    // UTF-8 of every file name, back to back
+};
+
+constexpr size_t kNumericColumnCount = static_cast<size_t>(NumericColumn::FileData) + 1;
+
+// The file starts with this header. Every column starts at a multiple of 8
+// bytes from the start of the file, so a reader can map the file and view
+// the columns as arrays in place: numpy.frombuffer(mapped, "<f8", rows,
+// columns[0].offset) gives the values.
+//
+// Integers and floats are little-endian. The writer stores host order and
+// the reader refuses files whose |byte_order| does not read back as
+// kNumericByteOrder, which only happens on a big-endian host.
+struct NumericFileHeader {
+    char magic[8];       // "OTNUMCOL"
+    uint32_t version;    // kNumericVersion
+    uint32_t byte_order; // kNumericByteOrder
+    uint64_t row_count;
+    uint32_t path_count;
+    uint32_t file_count;
+    struct {
+        uint64_t offset; // from the start of the header
+        uint64_t size;   // in bytes
+    } columns[kNumericColumnCount];
+};
+static_assert(sizeof(NumericFileHeader) == 32 + 16 * kNumericColumnCount,
+              "NumericFileHeader must not contain padding");
+
+constexpr uint32_t kNumericVersion = 1;
+constexpr uint32_t kNumericByteOrder = 0x01020304;
+
+// Rows of (path, file, line, value, flags) for the numeric assignments of a
+// set of files, such as `Ship/Parts/Thruster/Cost` = 150 in
+// `ships/default.rules`. Paths and file names are interned, so a column of
+// a thousand parts holds a thousand uint32 ids of one `Cost` path string.
+//
+// Filled by collect_numbers() (numeric_export.h) and written with
+// serialize() or write().
+class NumericTable {
+public:
+    uint32_t add_file(std::string_view name) { return files_.intern(name); }
+    uint32_t intern_path(std::string_view path) { return paths_.intern(path); }
+    void add_row(uint32_t path, uint32_t file, uint32_t line, double value, uint8_t flags);
+
+    // Appends the rows of |other|, mapping its path and file ids to this
+    // table's.
+    void merge(const NumericTable &other);
+
+    size_t row_count() const { return values_.size(); }
+    const std::vector<double> &values() const { return values_; }
+    const std::vector<uint32_t> &path_ids() const { return path_ids_; }
+    const std::vector<uint32_t> &file_ids() const { return file_ids_; }
+    const std::vector<uint32_t> &lines() const { return lines_; }
+    const std::vector<uint8_t> &flags() const { return flags_; }
+
+    size_t path_count() const { return paths_.size(); }
+    size_t file_count() const { return files_.size(); }
+    std::string_view path(uint32_t id) const { return paths_.name(id); }
+    std::string_view file(uint32_t id) const { return files_.name(id); }
+
+    // Appends the file format described by NumericFileHeader to |out|,
+    // after padding |out| to a multiple of 8 bytes.
+    void serialize(std::string *out) const;
+    bool write(const std::string &path) const;
+
+private:
+    KeyTable paths_;
+    KeyTable files_;
+    std::vector<double> values_;
+    std::vector<uint32_t> path_ids_;
+    std::vector<uint32_t> file_ids_;
+    std::vector<uint32_t> lines_;
+    std::vector<uint8_t> flags_;
+};
+
+// A read-only view of a serialized NumericTable, e.g. a mapped file. The
+// view does not copy; |data| must outlive it and be 8-byte aligned, as
+// mmap and the std::string allocator both are.
+class NumericTableView {
+public:
+    // Checks the header and that every column lies inside |size| bytes.
+    static std::optional<NumericTableView> open(const void *data, size_t size);
+
+    size_t row_count() const { return static_cast<size_t>(header_->row_count); }
+    size_t path_count() const { return header_->path_count; }
+    size_t file_count() const { return header_->file_count; }
+
+    const double *values() const { return column<double>(NumericColumn::Value); }
+    const uint32_t *path_ids() const { return column<uint32_t>(NumericColumn::Path); }
+    const uint32_t *file_ids() const { return column<uint32_t>(NumericColumn::File); }
+    const uint32_t *lines() const { return column<uint32_t>(NumericColumn::Line); }
+    const uint8_t *flags() const { return column<uint8_t>(NumericColumn::Flags); }
+
+    std::string_view path(uint32_t id) const;
+    std::string_view file(uint32_t id) const;
+
+private:
+    explicit NumericTableView(const uint8_t *data)
+        : data_(data), header_(reinterpret_cast<const NumericFileHeader *>(data)) {}
+
+    template <typename T>
+    const T *column(NumericColumn column) const {
+        return reinterpret_cast<const T *>(data_ +
+                                           header_->columns[static_cast<size_t>(column)].offset);
+    }
+
+    std::string_view string(NumericColumn offsets, NumericColumn data, uint32_t id) const;
+
+    const uint8_t *data_;
+    const NumericFileHeader *header_;
+};
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_NUMERIC_TABLE_H_
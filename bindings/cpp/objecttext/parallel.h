@@ -0,0 +1,47 @@
+#ifndef OBJECTTEXT_PARALLEL_H_
+#define OBJECTTEXT_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace objecttext {
+
+// Number of worker threads to use when the caller asks for 0.
+inline unsigned default_threads() {
+    unsigned count = std::thread::hardware_concurrency();
+    return count ? count : 1;
+}
+
+// Calls |body(index, worker)| for every index in [0, count) on up to
+// |threads| threads. Indices are handed out one at a time, so uneven work
+// items such as files of different sizes balance themselves. |worker| is in
+// [0, threads) and lets callers keep per-thread state like a Parser.
+template <typename Body>
+void parallel_for(size_t count, unsigned threads, Body &&body) {
+    if (threads == 0) threads = default_threads();
+    threads = static_cast<unsigned>(std::min<size_t>(threads, count));
+    if (threads <= 1) {
+        for (size_t index = 0; index < count; index++) body(index, 0u);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    auto run = [&](unsigned worker) {
+        for (size_t index; (index = next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+            body(index, worker);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned worker = 1; worker < threads; worker++) workers.emplace_back(run, worker);
+    run(0);
+    for (std::thread &worker : workers) worker.join();
+}
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_PARALLEL_H_
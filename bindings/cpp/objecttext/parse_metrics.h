@@ -0,0 +1,41 @@
+#ifndef OBJECTTEXT_PARSE_METRICS_H_
+#define OBJECTTEXT_PARSE_METRICS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <tree_sitter/api.h>
+
+namespace objecttext {
+
+// What one parse produced, for per-file reports.
+struct ParseStats {
+    size_t bytes = 0;
+    size_t nodes = 0;
+    size_t error_nodes = 0;   // ERROR nodes
+    size_t missing_nodes = 0; // nodes the parser inserted to recover
+    double seconds = 0;
+    bool reparse = false;     // parsed incrementally from an old tree
+    std::vector<uint64_t> nodes_by_symbol; // indexed by TSSymbol
+
+    // Walks |tree| once to count its nodes. Without |by_symbol|,
+    // nodes_by_symbol is left empty.
+    static ParseStats collect(const TSTree *tree, double seconds, bool reparse,
+                              bool by_symbol = true);
+};
+
+// Adds |stats| to the objecttext_parse_* metrics of the global
+// MetricsRegistry: files, reparses, bytes, nodes by symbol (anonymous nodes
+// are counted under `_anonymous`), error and missing nodes, files with
+// errors and a histogram of parse seconds.
+void record_parse(const ParseStats &stats);
+
+// Makes every Parser time its parses and record them with record_parse().
+// Collecting the stats walks each tree once, so this is opt-in.
+void enable_parse_metrics(bool enabled = true);
+bool parse_metrics_enabled();
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_PARSE_METRICS_H_
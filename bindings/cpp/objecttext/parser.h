@@ -0,0 +1,145 @@
+#ifndef OBJECTTEXT_PARSER_H_
+#define OBJECTTEXT_PARSER_H_
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <tree_sitter/api.h>
+#include <tree_sitter/tree-sitter-objecttext.h>
+
+namespace objecttext {
+
+struct TreeDeleter {
+    void operator()(TSTree *tree) const { ts_tree_delete(tree); }
+};
+
+using Tree = std::unique_ptr<TSTree, TreeDeleter>;
+
+// Symbol ids of the named nodes the C++ API looks at, resolved once.
+struct Symbols {
+    TSSymbol source_file;
+    TSSymbol identifier;
+    TSSymbol comment;
+    TSSymbol assignment;
+    TSSymbol group;
+    TSSymbol list;
+    TSSymbol value;
+    TSSymbol string;
+    TSSymbol verbatim;
+    TSSymbol bare_word;
+    TSSymbol number;
+    TSSymbol reference;
+    TSSymbol extension;
+    TSSymbol binary_expression;
+    TSSymbol urinary_expression;
+    TSSymbol parenthesized_expression;
+
+    static const Symbols &get();
+};
+
+// Lets another thread stop a parse, e.g. when the user switches away from
+// the file being parsed. The parse notices at its next progress check, a few
+// hundred parse operations later.
+class CancellationToken {
+public:
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+    void reset() { cancelled_.store(false, std::memory_order_relaxed); }
+    bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> cancelled_{false};
+};
+
+// When a parse should stop early. Zero means no limit. The time and byte
+// limits apply to each call, so a resumed parse gets a fresh allowance.
+struct ParseLimits {
+    const CancellationToken *cancel = nullptr;
+    std::chrono::nanoseconds time{0};
+    uint32_t bytes = 0;                      // bytes to advance past where the call started
+    std::chrono::nanoseconds recovery_time{0}; // time spent after the first syntax error
+
+    // Called at every progress check with the offset the parser has reached.
+    std::function<void(uint32_t byte_offset)> progress;
+};
+
+enum class ParseStatus : uint8_t {
+    Complete,
+    Cancelled,
+    OutOfTime,
+    OutOfBytes,
+    OutOfRecoveryTime,
+};
+
+// A TSParser with the objecttext language already set.
+class Parser {
+public:
+    Parser();
+    ~Parser();
+    Parser(const Parser &) = delete;
+    Parser &operator=(const Parser &) = delete;
+
+    Tree parse(std::string_view source, const TSTree *old_tree = nullptr);
+
+    // Parses under |limits|. If one of them stops the parse, the tree is
+    // null, |status| says which, and the parser keeps its partial state:
+    // calling this again with the same source buffer and old tree (and the
+    // same included ranges) resumes where it stopped. Any other parse, or
+    // reset(), discards that state.
+    Tree parse(std::string_view source, const ParseLimits &limits, ParseStatus *status,
+               const TSTree *old_tree = nullptr);
+
+    // Like parse(), but gives up and returns null once the parser has spent
+    // more than |limit| since it first hit a syntax error. Valid input is
+    // never cut short; a broken file cannot stall the caller in recovery.
+    Tree parse_with_recovery_limit(std::string_view source, std::chrono::nanoseconds limit,
+                                   const TSTree *old_tree = nullptr);
+
+    // Whether a parse was stopped and can be resumed, and how far it got.
+    bool paused() const { return paused_; }
+    uint32_t paused_at() const { return paused_at_; }
+
+    void reset();
+
+    TSParser *get() const { return parser_; }
+
+private:
+    TSParser *parser_;
+    bool paused_ = false;
+    uint32_t paused_at_ = 0;
+    std::string_view paused_source_;
+    const TSTree *paused_old_tree_ = nullptr;
+};
+
+// Whether |symbol| is an `assignment`, `group` or `list`, i.e. a keyed entry.
+inline bool is_entry(const Symbols &symbols, TSSymbol symbol) {
+    return symbol == symbols.assignment || symbol == symbols.group || symbol == symbols.list;
+}
+
+// The key of an `assignment`, `group` or `list`, or an empty view for the
+// unnamed groups and lists that appear inside blocks.
+std::string_view entry_key(TSNode entry, std::string_view source);
+
+// The `value` child of an `assignment`, or a null node.
+TSNode entry_value(TSNode entry);
+
+inline std::string_view node_text(TSNode node, std::string_view source) {
+    uint32_t start = ts_node_start_byte(node);
+    return source.substr(start, ts_node_end_byte(node) - start);
+}
+
+bool read_file(const std::string &path, std::string *contents);
+
+// Points tree-sitter's allocator at the Arena of the current ArenaScope,
+// falling back to malloc on threads without one. The hooks are process-wide
+// (ts_set_allocator, which the grammar library also follows when built with
+// TREE_SITTER_REUSE_ALLOCATOR), so this is opt-in and idempotent.
+void install_arena_allocator();
+bool arena_allocator_installed();
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_PARSER_H_
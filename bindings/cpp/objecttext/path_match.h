@@ -0,0 +1,145 @@
+#ifndef OBJECTTEXT_PATH_MATCH_H_
+#define OBJECTTEXT_PATH_MATCH_H_
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <tree_sitter/api.h>
+
+#include "objecttext/parser.h"
+#include "objecttext/path_query.h"
+
+namespace objecttext {
+
+// Runs a PathQuery over a syntax tree with a TSTreeCursor.
+//
+// Only `assignment`, `group` and `list` nodes consume a path step. A subtree
+// is skipped as soon as no step can match below it, and key text is only
+// looked up in the query's key table while a literal step is pending.
+class PathMatcher {
+public:
+    explicit PathMatcher(const PathQuery &query) : query_(query), symbols_(Symbols::get()) {}
+
+    // Calls |on_match(TSNode)| for every entry below |root| that the query
+    // reaches. Steps are relative to |root|, which is usually the
+    // `source_file` node. Returns the number of matches.
+    template <typename OnMatch>
+    size_t run(TSNode root, std::string_view source, OnMatch &&on_match);
+
+    std::vector<TSNode> collect(TSNode root, std::string_view source);
+
+    // Index of the first entry at each depth below the root, for trees that
+    // hold only a slice of a document. Unnamed entries are matched by index,
+    // so a slice that starts at entry 7 of a list must count from 7.
+    void set_index_bases(std::vector<uint32_t> bases) { index_bases_ = std::move(bases); }
+
+private:
+    struct Frame {
+        uint64_t states;
+        uint32_t index;
+        bool error; // an ERROR node, which counts on with its block's index
+    };
+
+    const PathQuery &query_;
+    const Symbols &symbols_;
+    std::vector<Frame> stack_;
+    std::vector<uint32_t> index_bases_;
+
+    uint32_t index_base(size_t depth) const {
+        return depth < index_bases_.size() ? index_bases_[depth] : 0;
+    }
+
+    uint32_t key_id(TSNode entry, uint32_t index, std::string_view source) const;
+    bool check(const PathStep &step, TSNode entry, std::string_view source) const;
+};
+
+struct PathMatch {
+    uint32_t start_byte;
+    uint32_t end_byte;
+    TSPoint start_point;
+    std::string key;
+    std::string value; // raw text of the `value` node, empty for groups and lists
+};
+
+struct FileMatches {
+    std::string path;
+    bool ok = false; // false if the file could not be read
+    std::vector<PathMatch> matches;
+};
+
+PathMatch make_path_match(TSNode entry, std::string_view source);
+
+// Reads, parses and queries every file in |paths| on up to |threads| threads
+// (0 picks the hardware concurrency). Results keep the order of |paths|.
+std::vector<FileMatches> match_files(const PathQuery &query,
+                                     const std::vector<std::string> &paths,
+                                     unsigned threads = 0);
+
+template <typename OnMatch>
+size_t PathMatcher::run(TSNode root, std::string_view source, OnMatch &&on_match) {
+    size_t matches = 0;
+    uint64_t accept = query_.accept();
+    TSTreeCursor cursor = ts_tree_cursor_new(root);
+    if (!ts_tree_cursor_goto_first_child(&cursor)) {
+        ts_tree_cursor_delete(&cursor);
+        return 0;
+    }
+
+    stack_.clear();
+    stack_.push_back({query_.start(), index_base(0), false});
+    size_t blocks = 1; // frames that are not ERROR nodes
+    for (;;) {
+        TSNode node = ts_tree_cursor_current_node(&cursor);
+        TSSymbol symbol = ts_node_symbol(node);
+        Frame &frame = stack_.back();
+
+        uint64_t descend = 0;
+        if (is_entry(symbols_, symbol)) {
+            uint32_t key = query_.needs_key(frame.states)
+                ? key_id(node, frame.index, source)
+                : KeyTable::kNone;
+            frame.index++;
+            uint64_t next = query_.advance(frame.states, key, [&](const PathStep &step) {
+                return check(step, node, source);
+            });
+            if (next & accept) {
+                on_match(node);
+                matches++;
+            }
+            if (symbol != symbols_.assignment) descend = next & ~accept;
+        } else if (ts_node_is_error(node)) {
+            // Entries recovered inside an ERROR node still belong to the
+            // enclosing block, and so does its entry index.
+            descend = frame.states;
+        }
+
+        if (descend && ts_tree_cursor_goto_first_child(&cursor)) {
+            if (is_entry(symbols_, symbol)) {
+                stack_.push_back({descend, index_base(blocks++), false});
+            } else {
+                stack_.push_back({descend, frame.index, true});
+            }
+            continue;
+        }
+        while (!ts_tree_cursor_goto_next_sibling(&cursor)) {
+            Frame done = stack_.back();
+            stack_.pop_back();
+            if (stack_.empty()) {
+                ts_tree_cursor_delete(&cursor);
+                return matches;
+            }
+            if (done.error) {
+                stack_.back().index = done.index;
+            } else {
+                blocks--;
+            }
+            ts_tree_cursor_goto_parent(&cursor);
+        }
+    }
+}
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_PATH_MATCH_H_
@@ -0,0 +1,139 @@
+#ifndef OBJECTTEXT_PATH_QUERY_H_
+#define OBJECTTEXT_PATH_QUERY_H_
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace objecttext {
+
+// Maps key strings to dense ids, so path steps compare integers instead of
+// text while walking a tree.
+class KeyTable {
+public:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    KeyTable() = default;
+    KeyTable(const KeyTable &other);
+    KeyTable &operator=(const KeyTable &other);
+    KeyTable(KeyTable &&) = default;
+    KeyTable &operator=(KeyTable &&) = default;
+
+    uint32_t intern(std::string_view key);
+    uint32_t find(std::string_view key) const;
+    std::string_view name(uint32_t id) const { return names_[id]; }
+    size_t size() const { return names_.size(); }
+
+private:
+    std::deque<std::string> names_;
+    std::unordered_map<std::string_view, uint32_t> ids_;
+};
+
+enum class PathCompare : uint8_t {
+    Exists,
+    Equal,
+    NotEqual,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+};
+
+// A bracketed condition on a step: `[Key]`, `[Key > 5]` or `[= "text"]`.
+struct PathPredicate {
+    uint32_t key = KeyTable::kNone; // child key, or kNone for the step's own value
+    PathCompare compare = PathCompare::Exists;
+    std::string text;
+    double number = 0;
+    bool is_number = false;
+
+    // Tests the raw source text of a `value` node.
+    bool test(std::string_view value) const;
+};
+
+enum class PathStepKind : uint8_t {
+    Key,         // `Name`
+    Wildcard,    // `*`
+    Descendants, // `**`
+};
+
+struct PathStep {
+    PathStepKind kind = PathStepKind::Key;
+    uint32_t key = KeyTable::kNone;
+    std::vector<PathPredicate> predicates;
+};
+
+enum class PathQueryError {
+    None,
+    Syntax,
+    TooManySteps,
+};
+
+// A compiled path such as `Parts/*/Components/**/Cost[> 100]`.
+//
+// Steps are separated by `/`. A step is a key, `*` for any single key or
+// `**` for any number of levels. Unnamed groups and lists are addressed by
+// their index in the enclosing block. Predicates in brackets either test a
+// child (`[Key]`, `[Key op literal]`) or the step's own value
+// (`[op literal]`), with op one of `= != < <= > >=`. A numeric literal
+// compares numerically, and values that are not numbers fail `< <= > >=`.
+//
+// Matching runs a small NFA whose state set is a bitmask: bit `i` means the
+// first `i` steps have matched, so a query holds at most kMaxSteps steps.
+class PathQuery {
+public:
+    static constexpr size_t kMaxSteps = 63;
+
+    static std::optional<PathQuery> compile(std::string_view source,
+                                            uint32_t *error_offset = nullptr,
+                                            PathQueryError *error = nullptr);
+
+    const std::vector<PathStep> &steps() const { return steps_; }
+    const KeyTable &keys() const { return keys_; }
+    const std::string &source() const { return source_; }
+
+    // State set before any key has been consumed.
+    uint64_t start() const { return closure_[0]; }
+
+    // Bit that is set once every step has matched.
+    uint64_t accept() const { return uint64_t(1) << steps_.size(); }
+
+    // Whether any state in |states| needs the interned id of the next key.
+    bool needs_key(uint64_t states) const { return states & key_states_; }
+
+    // Consumes one key. |check| is called as `bool(const PathStep &)` to
+    // evaluate predicates of steps that matched by key. Returns an empty set
+    // when the subtree below the key cannot match and can be skipped.
+    template <typename Check>
+    uint64_t advance(uint64_t states, uint32_t key, Check &&check) const {
+        uint64_t next = 0;
+        for (size_t index = 0; index < steps_.size(); index++) {
+            if (!(states >> index & 1)) continue;
+            const PathStep &step = steps_[index];
+            if (step.kind == PathStepKind::Descendants) {
+                next |= closure_[index];
+                continue;
+            }
+            if (step.kind == PathStepKind::Key && step.key != key) continue;
+            if (step.predicates.empty() || check(step)) next |= closure_[index + 1];
+        }
+        return next;
+    }
+
+private:
+    std::string source_;
+    std::vector<PathStep> steps_;
+    std::vector<uint64_t> closure_;
+    uint64_t key_states_ = 0;
+    KeyTable keys_;
+
+    friend class PathQueryParser;
+};
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_PATH_QUERY_H_
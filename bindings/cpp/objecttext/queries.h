@@ -0,0 +1,80 @@
+#ifndef OBJECTTEXT_QUERIES_H_
+#define OBJECTTEXT_QUERIES_H_
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <tree_sitter/api.h>
+
+namespace objecttext {
+
+// The query files shipped in queries/, embedded at build time.
+enum class QueryPack {
+    Highlights,
+    Locals,
+    Tags,
+};
+
+std::string_view query_pack_source(QueryPack pack);
+
+// Process-wide cache of compiled queries.
+//
+// Each query is compiled once, on first use, and then shared read-only by
+// every thread; TSQuery is immutable after ts_query_new, so concurrent
+// QueryCursor executions against it are safe. Queries live until exit.
+class QueryRegistry {
+public:
+    static QueryRegistry &global();
+
+    // Returns the compiled pack, or null if it failed to compile.
+    const TSQuery *get(QueryPack pack);
+
+    // Returns the compiled query for |source|, compiling it on the first call
+    // with that text. Returns null and fills the error out-parameters if the
+    // query is invalid; failures are cached as well.
+    const TSQuery *get(std::string_view source,
+                       uint32_t *error_offset = nullptr,
+                       TSQueryError *error_type = nullptr);
+
+private:
+    struct Entry {
+        TSQuery *query = nullptr;
+        uint32_t error_offset = 0;
+        TSQueryError error_type = TSQueryErrorNone;
+        ~Entry() { if (query) ts_query_delete(query); }
+    };
+
+    std::shared_mutex mutex_;
+    std::unordered_map<std::string, std::unique_ptr<Entry>> entries_;
+    const TSQuery *packs_[3] = {};
+    std::once_flag pack_once_[3];
+};
+
+// A TSQueryCursor borrowed from a per-thread pool.
+//
+// Cursors keep their internal buffers between executions, so reusing them
+// avoids the allocations of ts_query_cursor_new on every query. Byte and
+// point ranges, the match limit and the start depth are reset when a cursor
+// goes back to the pool. Nesting is fine: each live QueryCursor holds a
+// distinct cursor.
+class QueryCursor {
+public:
+    QueryCursor();
+    ~QueryCursor();
+    QueryCursor(const QueryCursor &) = delete;
+    QueryCursor &operator=(const QueryCursor &) = delete;
+
+    TSQueryCursor *get() const { return cursor_; }
+
+private:
+    TSQueryCursor *cursor_;
+};
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_QUERIES_H_
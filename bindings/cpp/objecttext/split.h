@@ -0,0 +1,87 @@
+#ifndef OBJECTTEXT_SPLIT_H_
+#define OBJECTTEXT_SPLIT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <tree_sitter/api.h>
+
+#include "objecttext/parser.h"
+#include "objecttext/path_match.h"
+#include "objecttext/path_query.h"
+
+namespace objecttext {
+
+struct SplitOptions {
+    unsigned threads = 0;            // 0 picks the hardware concurrency
+    size_t chunk_bytes = 0;          // 0 aims for a few chunks per thread
+    size_t min_split_bytes = 8 << 20; // smaller inputs are parsed in one piece
+    const CancellationToken *cancel = nullptr; // cancelled chunks are left without a tree
+};
+
+struct RecoveryOptions {
+    unsigned threads = 0;              // 0 picks the hardware concurrency
+    size_t slice_bytes = 16 << 10;     // top-level entries are batched up to this size
+    double recovery_ns_per_byte = 1000; // error recovery allowed per byte of a slice
+    double recovery_fixed_ms = 5;       // and in total, before the slice is abandoned
+};
+
+// One parsed slice of a split document.
+//
+// |ranges| are the included ranges the slice was parsed with: the headers of
+// the |spine| blocks that enclose the slice (`Root {`, `Parts {`, ...), the
+// body, then their closing brackets. Since the ranges point into the shared
+// buffer, every node already carries its offset and point in the whole
+// document.
+struct SplitChunk {
+    std::vector<TSRange> ranges;
+    uint32_t spine = 0;
+    Tree tree;
+
+    // Index of each spine block among the entries of its parent, outermost
+    // first, then the index of the first entry of the body.
+    std::vector<uint32_t> index_bases;
+
+    const TSRange &body() const { return ranges[spine]; }
+};
+
+// A document too large for one TSParser, parsed as independent slices.
+//
+// The StructureIndex pre-scan finds the blocks; any block larger than the
+// chunk size is cut between its child blocks, recursively, and runs of
+// consecutive children become chunks. Chunks are parsed on a thread pool
+// with one TSParser per worker. Files without a single balanced top-level
+// block, or smaller than |min_split_bytes|, end up as one chunk.
+class SplitDocument {
+public:
+    // |source| must outlive the document.
+    static SplitDocument parse(std::string_view source, const SplitOptions &options = {});
+
+    // Parses a possibly broken file so that one bad entry cannot cost more
+    // than its own slice. The file is parsed whole first; if that has errors
+    // or overruns the recovery limit, it is parsed again in slices that
+    // start at the top-level entries of the root block, found by their
+    // indentation since the brackets of a broken file cannot be trusted.
+    // Slices that overrun the limit are left without a tree.
+    static SplitDocument recover(std::string_view source, const RecoveryOptions &options = {});
+
+    const std::vector<SplitChunk> &chunks() const { return chunks_; }
+    std::string_view source() const { return source_; }
+
+    bool has_error() const;
+
+    // Runs |query| over every chunk as if it were one tree. Enclosing blocks
+    // that several chunks repeat are reported once; predicates on them only
+    // see the children within a single chunk. Results are in document order.
+    std::vector<PathMatch> match(const PathQuery &query, unsigned threads = 0) const;
+
+private:
+    std::string_view source_;
+    std::vector<SplitChunk> chunks_;
+};
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_SPLIT_H_
@@ -0,0 +1,76 @@
+#ifndef OBJECTTEXT_STRUCTURE_H_
+#define OBJECTTEXT_STRUCTURE_H_
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace objecttext {
+
+enum class StructureKind : uint8_t {
+    Group,
+    List,
+    Comment,
+};
+
+// A `{...}` or `[...]` block, or a `/* */` comment. |key_start| and
+// |key_end| delimit the identifier that names the block and are equal for
+// unnamed blocks and comments. |end_byte| is one past the closing bracket,
+// or the end of the input for an unclosed block.
+struct StructureSpan {
+    uint32_t start_byte;
+    uint32_t end_byte;
+    uint32_t start_row;
+    uint32_t end_row;
+    uint32_t key_start;
+    uint32_t key_end;
+    uint32_t depth;
+    StructureKind kind;
+};
+
+// A structural index of a document built without parsing it.
+//
+// Each 64-byte block is classified with SIMD compares into bitmasks of
+// `{ } [ ] = :`, `@`, `/`, quotes and newlines. Strings are masked off
+// without branches by a prefix XOR over the quote bits (a carry-less multiply
+// where the target has one); only the remaining set bits are visited, to
+// skip verbatim strings, comments and bare words (which may contain
+// brackets) and to match brackets on a stack. Rows come from popcounts of
+// the newline mask. This is enough to show an outline and
+// folding ranges for a huge file while the real parse runs in the
+// background, and to find safe places to split a file.
+class StructureIndex {
+public:
+    static StructureIndex build(std::string_view source);
+
+    // Offsets of `{ } [ ] = :` outside strings, comments and bare words.
+    const std::vector<uint32_t> &structurals() const { return structurals_; }
+
+    // Groups and lists, ordered by their opening bracket.
+    const std::vector<StructureSpan> &blocks() const { return blocks_; }
+
+    // Block comments, in source order.
+    const std::vector<StructureSpan> &comments() const { return comments_; }
+
+    // False if a bracket was unmatched or a block was never closed.
+    bool balanced() const { return balanced_; }
+
+    // Blocks nested at most |max_depth| levels deep, the first being 0.
+    std::vector<StructureSpan> outline(uint32_t max_depth) const;
+
+    // Blocks and comments that span more than one line, by start row.
+    std::vector<StructureSpan> folding_ranges() const;
+
+private:
+    std::vector<uint32_t> structurals_;
+    std::vector<StructureSpan> blocks_;
+    std::vector<StructureSpan> comments_;
+    bool balanced_ = true;
+};
+
+// Number of `\n` bytes in |text|.
+size_t count_newlines(std::string_view text);
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_STRUCTURE_H_
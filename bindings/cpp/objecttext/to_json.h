@@ -0,0 +1,34 @@
+#ifndef OBJECTTEXT_TO_JSON_H_
+#define OBJECTTEXT_TO_JSON_H_
+
+#include <string>
+#include <string_view>
+
+#include <tree_sitter/api.h>
+
+namespace objecttext {
+
+struct JsonOptions {
+    // Spaces per nesting level; 0 writes the document on one line.
+    unsigned indent = 0;
+};
+
+// Appends the document under |root| (a `source_file`) to |out| as JSON.
+//
+// Groups become objects and lists become arrays. Keyed entries inside a list
+// become objects with a single member, and unnamed blocks inside a group are
+// written under their index, as path queries address them. Keys keep their
+// order, duplicates included. Numbers become JSON numbers (`50%` is 0.5),
+// strings lose their quotes and `\"` escapes, and every other value
+// (bare words, references, expressions) is written as its trimmed text.
+// The extensions of a group (`Thruster : BaseThruster`) are listed under
+// `"$extends"`. Comments and ERROR nodes are left out.
+//
+// The tree is walked with one cursor and written into |out| directly, so
+// the cost is one pass over the tree and amortized appends.
+void write_json(TSNode root, std::string_view source, std::string *out,
+                const JsonOptions &options = {});
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_TO_JSON_H_
@@ -0,0 +1,58 @@
+#ifndef OBJECTTEXT_TRACE_H_
+#define OBJECTTEXT_TRACE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace objecttext {
+
+namespace detail {
+extern std::atomic<bool> trace_enabled;
+} // namespace detail
+
+// Starts recording trace events from every thread, to be written to |path|
+// as Chrome trace_event JSON (loadable in Perfetto or chrome://tracing) by
+// stop_tracing(). Returns false if tracing is already on.
+bool start_tracing(const std::string &path);
+
+// Starts tracing if the OBJECTTEXT_TRACE environment variable names a file.
+bool start_tracing_from_environment();
+
+// Stops recording and writes the file. Returns false if tracing was off or
+// the file could not be written.
+bool stop_tracing();
+
+inline bool tracing() {
+    return detail::trace_enabled.load(std::memory_order_relaxed);
+}
+
+// Records the time from construction to destruction as one complete event
+// on the calling thread. |name| must be a string literal; |detail|, such as
+// a file path, is copied and shown as an argument of the event. When tracing
+// is off this costs one relaxed load and a branch.
+class TraceScope {
+public:
+    explicit TraceScope(const char *name, std::string_view detail = {}) : name_(name) {
+        if (tracing()) begin(detail);
+    }
+    ~TraceScope() {
+        if (active_) end();
+    }
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *name_;
+    bool active_ = false;
+    uint64_t start_ns_ = 0;
+    std::string detail_;
+
+    void begin(std::string_view detail);
+    void end();
+};
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_TRACE_H_
@@ -0,0 +1,25 @@
+#ifndef OBJECTTEXT_VALUE_H_
+#define OBJECTTEXT_VALUE_H_
+
+#include <string_view>
+
+namespace objecttext {
+
+// Suffix flags of a number literal, e.g. `50%` or `90d`.
+enum NumberSuffix : unsigned {
+    kSuffixNone = 0,
+    kSuffixPercent = 1 << 0,
+    kSuffixDegrees = 1 << 1,
+};
+
+// Parses a `number` literal. `%` scales the value by 1/100, `d` is kept as
+// written. Returns false if |text| is not a complete number literal.
+bool parse_number(std::string_view text, double *value, unsigned *suffix = nullptr);
+
+// Strips the quotes from a `string` or `verbatim` literal and surrounding
+// whitespace from anything else. Escapes are left as written.
+std::string_view unquote(std::string_view text);
+
+} // namespace objecttext
+
+#endif // OBJECTTEXT_VALUE_H_
@@ -0,0 +1,132 @@
+#include "objecttext/parse_metrics.h"
+
+#include <atomic>
+#include <string>
+
+#include <tree_sitter/tree-sitter-objecttext.h>
+
+#include "objecttext/metrics.h"
+
+namespace objecttext {
+
+namespace {
+
+std::atomic<bool> metrics_enabled{false};
+
+struct ParseCounters {
+    Counter files;
+    Counter reparses;
+    Counter bytes;
+    Counter error_nodes;
+    Counter missing_nodes;
+    Counter files_with_errors;
+    Counter anonymous_nodes;
+    std::vector<Counter> named_nodes; // indexed by TSSymbol
+    std::vector<bool> named;
+    Histogram seconds;
+
+    static const ParseCounters &get() {
+        static const ParseCounters counters = [] {
+            MetricsRegistry &registry = MetricsRegistry::global();
+            ParseCounters result;
+            result.files = registry.counter("objecttext_parse_files_total", "Parses completed.");
+            result.reparses = registry.counter("objecttext_parse_reparses_total",
+                                               "Parses that reused an old tree.");
+            result.bytes = registry.counter("objecttext_parse_bytes_total", "Bytes parsed.");
+            result.error_nodes = registry.counter("objecttext_parse_error_nodes_total",
+                                                  "ERROR nodes in parsed trees.");
+            result.missing_nodes = registry.counter("objecttext_parse_missing_nodes_total",
+                                                    "MISSING nodes in parsed trees.");
+            result.files_with_errors = registry.counter("objecttext_parse_files_with_errors_total",
+                                                        "Parses whose tree has errors.");
+
+            const char *nodes_name = "objecttext_parse_nodes_total";
+            const char *nodes_help = "Nodes in parsed trees by symbol.";
+            const TSLanguage *language = tree_sitter_objecttext();
+            uint32_t symbols = ts_language_symbol_count(language);
+            result.named_nodes.resize(symbols);
+            result.named.resize(symbols);
+            for (TSSymbol symbol = 0; symbol < symbols; symbol++) {
+                if (ts_language_symbol_type(language, symbol) != TSSymbolTypeRegular) continue;
+                result.named[symbol] = true;
+                // Named symbols are plain identifiers and need no escaping.
+                std::string labels = "symbol=\"";
+                labels += ts_language_symbol_name(language, symbol);
+                labels += '"';
+                result.named_nodes[symbol] = registry.counter(nodes_name, nodes_help, labels);
+            }
+            result.anonymous_nodes = registry.counter(nodes_name, nodes_help, "symbol=\"_anonymous\"");
+
+            result.seconds = registry.histogram(
+                "objecttext_parse_seconds", "Wall time of each parse.",
+                {0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1, 5, 10});
+            return result;
+        }();
+        return counters;
+    }
+};
+
+} // namespace
+
+ParseStats ParseStats::collect(const TSTree *tree, double seconds, bool reparse,
+                               bool by_symbol) {
+    ParseStats stats;
+    stats.seconds = seconds;
+    stats.reparse = reparse;
+    if (by_symbol) {
+        stats.nodes_by_symbol.assign(ts_language_symbol_count(ts_tree_language(tree)), 0);
+    }
+    TSNode root = ts_tree_root_node(tree);
+    stats.bytes = ts_node_end_byte(root);
+
+    TSTreeCursor cursor = ts_tree_cursor_new(root);
+    for (;;) {
+        TSNode node = ts_tree_cursor_current_node(&cursor);
+        stats.nodes++;
+        TSSymbol symbol = ts_node_symbol(node);
+        if (symbol < stats.nodes_by_symbol.size()) stats.nodes_by_symbol[symbol]++;
+        if (ts_node_is_error(node)) stats.error_nodes++;
+        if (ts_node_is_missing(node)) stats.missing_nodes++;
+        if (ts_tree_cursor_goto_first_child(&cursor)) continue;
+        while (!ts_tree_cursor_goto_next_sibling(&cursor)) {
+            if (!ts_tree_cursor_goto_parent(&cursor)) {
+                ts_tree_cursor_delete(&cursor);
+                return stats;
+            }
+        }
+    }
+}
+
+void record_parse(const ParseStats &stats) {
+    const ParseCounters &counters = ParseCounters::get();
+    MetricsRegistry &registry = MetricsRegistry::global();
+    registry.add(counters.files);
+    if (stats.reparse) registry.add(counters.reparses);
+    registry.add(counters.bytes, stats.bytes);
+    registry.add(counters.error_nodes, stats.error_nodes);
+    registry.add(counters.missing_nodes, stats.missing_nodes);
+    if (stats.error_nodes || stats.missing_nodes) registry.add(counters.files_with_errors);
+
+    uint64_t anonymous = 0;
+    for (size_t symbol = 0; symbol < stats.nodes_by_symbol.size(); symbol++) {
+        uint64_t count = stats.nodes_by_symbol[symbol];
+        if (!count) continue;
+        if (symbol < counters.named.size() && counters.named[symbol]) {
+            registry.add(counters.named_nodes[symbol], count);
+        } else {
+            anonymous += count;
+        }
+    }
+    if (anonymous) registry.add(counters.anonymous_nodes, anonymous);
+    registry.observe(counters.seconds, stats.seconds);
+}
+
+void enable_parse_metrics(bool enabled) {
+    metrics_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool parse_metrics_enabled() {
+    return metrics_enabled.load(std::memory_order_relaxed);
+}
+
+} // namespace objecttext
@@ -0,0 +1,269 @@
+#include "objecttext/parser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#include "objecttext/arena.h"
+#include "objecttext/parse_metrics.h"
+
+namespace objecttext {
+
+namespace {
+
+std::atomic<bool> arena_installed{false};
+
+void *arena_malloc(size_t size) {
+    Arena *arena = current_arena();
+    return arena ? arena->allocate(size) : malloc(size);
+}
+
+void *arena_calloc(size_t count, size_t size) {
+    Arena *arena = current_arena();
+    if (!arena) return calloc(count, size);
+    if (size && count > SIZE_MAX / size) return nullptr;
+    void *pointer = arena->allocate(count * size);
+    if (pointer) memset(pointer, 0, count * size);
+    return pointer;
+}
+
+void *arena_realloc(void *pointer, size_t size) {
+    Arena *arena = current_arena();
+    if (arena && (!pointer || arena->owns(pointer))) return arena->reallocate(pointer, size);
+    if (Arena::owned_by_any(pointer)) {
+        // Another arena's memory, such as a tree kept past its scope: copy
+        // it out rather than hand it to realloc().
+        void *moved = arena_malloc(size);
+        if (moved) memcpy(moved, pointer, std::min(Arena::allocation_size(pointer), size));
+        return moved;
+    }
+    return realloc(pointer, size);
+}
+
+void arena_free(void *pointer) {
+    Arena *arena = current_arena();
+    if (arena && arena->owns(pointer)) {
+        arena->release(pointer);
+    } else if (!Arena::owned_by_any(pointer)) {
+        free(pointer);
+    }
+    // Otherwise the owning arena takes it back when it resets.
+}
+
+struct ProgressState {
+    const ParseLimits *limits;
+    std::chrono::steady_clock::time_point deadline;
+    std::chrono::steady_clock::time_point first_error;
+    bool in_error = false;
+    uint32_t byte_limit = UINT32_MAX;
+    uint32_t byte = 0;
+    ParseStatus status = ParseStatus::Complete;
+};
+
+// Called every hundred or so parse operations. Returning true stops the
+// parse; tree-sitter keeps its stack so that the next call can resume.
+bool parse_progress(TSParseState *parse_state) {
+    ProgressState *state = static_cast<ProgressState *>(parse_state->payload);
+    const ParseLimits &limits = *state->limits;
+    state->byte = parse_state->current_byte_offset;
+    if (limits.progress) limits.progress(state->byte);
+    if (limits.cancel && limits.cancel->cancelled()) {
+        state->status = ParseStatus::Cancelled;
+        return true;
+    }
+    if (state->byte >= state->byte_limit) {
+        state->status = ParseStatus::OutOfBytes;
+        return true;
+    }
+    bool timed_recovery = limits.recovery_time.count() > 0 && parse_state->has_error;
+    if (limits.time.count() <= 0 && !timed_recovery) return false;
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (limits.time.count() > 0 && now > state->deadline) {
+        state->status = ParseStatus::OutOfTime;
+        return true;
+    }
+    if (timed_recovery) {
+        if (!state->in_error) {
+            state->in_error = true;
+            state->first_error = now;
+        } else if (now - state->first_error > limits.recovery_time) {
+            state->status = ParseStatus::OutOfRecoveryTime;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *read_string(void *payload, uint32_t byte, TSPoint, uint32_t *bytes_read) {
+    std::string_view *source = static_cast<std::string_view *>(payload);
+    if (byte >= source->size()) {
+        *bytes_read = 0;
+        return "";
+    }
+    *bytes_read = static_cast<uint32_t>(source->size() - byte);
+    return source->data() + byte;
+}
+
+void record_metrics(const Tree &tree, std::chrono::steady_clock::time_point start,
+                    const TSTree *old_tree) {
+    if (!tree) return;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    record_parse(ParseStats::collect(tree.get(), seconds, old_tree != nullptr));
+}
+
+} // namespace
+
+static TSSymbol named_symbol(const TSLanguage *language, const char *name) {
+    return ts_language_symbol_for_name(language, name, static_cast<uint32_t>(strlen(name)), true);
+}
+
+const Symbols &Symbols::get() {
+    static const Symbols symbols = [] {
+        const TSLanguage *language = tree_sitter_objecttext();
+        Symbols result;
+        result.source_file = named_symbol(language, "source_file");
+        result.identifier = named_symbol(language, "identifier");
+        result.comment = named_symbol(language, "comment");
+        result.assignment = named_symbol(language, "assignment");
+        result.group = named_symbol(language, "group");
+        result.list = named_symbol(language, "list");
+        result.value = named_symbol(language, "value");
+        result.string = named_symbol(language, "string");
+        result.verbatim = named_symbol(language, "verbatim");
+        result.bare_word = named_symbol(language, "bare_word");
+        result.number = named_symbol(language, "number");
+        result.reference = named_symbol(language, "reference");
+        result.extension = named_symbol(language, "extension");
+        result.binary_expression = named_symbol(language, "binary_expression");
+        result.urinary_expression = named_symbol(language, "urinary_expression");
+        result.parenthesized_expression = named_symbol(language, "parenthesized_expression");
+        return result;
+    }();
+    return symbols;
+}
+
+Parser::Parser() : parser_(ts_parser_new()) {
+    ts_parser_set_language(parser_, tree_sitter_objecttext());
+}
+
+Parser::~Parser() {
+    ts_parser_delete(parser_);
+}
+
+Tree Parser::parse(std::string_view source, const TSTree *old_tree) {
+    if (paused_) reset();
+    bool metrics = parse_metrics_enabled();
+    std::chrono::steady_clock::time_point start;
+    if (metrics) start = std::chrono::steady_clock::now();
+    Tree tree(ts_parser_parse_string(parser_, old_tree, source.data(),
+                                     static_cast<uint32_t>(source.size())));
+    if (metrics) record_metrics(tree, start, old_tree);
+    return tree;
+}
+
+Tree Parser::parse(std::string_view source, const ParseLimits &limits, ParseStatus *status,
+                   const TSTree *old_tree) {
+    bool resuming = paused_ && paused_source_.data() == source.data() &&
+                    paused_source_.size() == source.size() && paused_old_tree_ == old_tree;
+    if (paused_ && !resuming) reset();
+
+    ProgressState state;
+    state.limits = &limits;
+    if (limits.time.count() > 0) {
+        state.deadline = std::chrono::steady_clock::now() +
+                         std::chrono::duration_cast<std::chrono::steady_clock::duration>(limits.time);
+    }
+    if (limits.bytes) {
+        uint32_t start = resuming ? paused_at_ : 0;
+        state.byte_limit = limits.bytes > UINT32_MAX - start ? UINT32_MAX : start + limits.bytes;
+    }
+
+    // A resumed parse is timed from the call that completes it.
+    bool metrics = parse_metrics_enabled();
+    std::chrono::steady_clock::time_point start;
+    if (metrics) start = std::chrono::steady_clock::now();
+    TSInput input = {&source, read_string, TSInputEncodingUTF8, nullptr};
+    TSParseOptions options = {&state, parse_progress};
+    Tree tree(ts_parser_parse_with_options(parser_, old_tree, input, options));
+    if (metrics) record_metrics(tree, start, old_tree);
+    paused_ = !tree;
+    if (paused_) {
+        paused_at_ = state.byte;
+        paused_source_ = source;
+        paused_old_tree_ = old_tree;
+    }
+    *status = tree ? ParseStatus::Complete : state.status;
+    return tree;
+}
+
+Tree Parser::parse_with_recovery_limit(std::string_view source, std::chrono::nanoseconds limit,
+                                       const TSTree *old_tree) {
+    ParseLimits limits;
+    limits.recovery_time = limit;
+    ParseStatus status;
+    Tree tree = parse(source, limits, &status, old_tree);
+    if (!tree) reset();
+    return tree;
+}
+
+void Parser::reset() {
+    ts_parser_reset(parser_);
+    paused_ = false;
+    paused_at_ = 0;
+    paused_source_ = {};
+    paused_old_tree_ = nullptr;
+}
+
+std::string_view entry_key(TSNode entry, std::string_view source) {
+    TSNode first = ts_node_child(entry, 0);
+    if (ts_node_is_null(first) || ts_node_symbol(first) != Symbols::get().identifier) return {};
+    return node_text(first, source);
+}
+
+TSNode entry_value(TSNode entry) {
+    TSSymbol value = Symbols::get().value;
+    uint32_t count = ts_node_child_count(entry);
+    for (uint32_t i = 0; i < count; i++) {
+        TSNode child = ts_node_child(entry, i);
+        if (ts_node_symbol(child) == value) return child;
+    }
+    return TSNode{};
+}
+
+bool read_file(const std::string &path, std::string *contents) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    contents->clear();
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long size = ftell(file);
+        if (size > 0) contents->reserve(static_cast<size_t>(size));
+        fseek(file, 0, SEEK_SET);
+    }
+    char buffer[1 << 16];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        contents->append(buffer, count);
+    }
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+void install_arena_allocator() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        ts_set_allocator(arena_malloc, arena_calloc, arena_realloc, arena_free);
+        arena_installed.store(true, std::memory_order_release);
+    });
+}
+
+bool arena_allocator_installed() {
+    return arena_installed.load(std::memory_order_acquire);
+}
+
+} // namespace objecttext
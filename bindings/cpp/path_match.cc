@@ -0,0 +1,114 @@
+#include "objecttext/path_match.h"
+
+#include <algorithm>
+#include <charconv>
+
+#include "objecttext/arena.h"
+#include "objecttext/parallel.h"
+#include "objecttext/trace.h"
+
+namespace objecttext {
+
+uint32_t PathMatcher::key_id(TSNode entry, uint32_t index, std::string_view source) const {
+    std::string_view key = entry_key(entry, source);
+    if (!key.empty()) return query_.keys().find(key);
+
+    char digits[16];
+    char *end = std::to_chars(digits, digits + sizeof(digits), index).ptr;
+    return query_.keys().find(std::string_view(digits, end - digits));
+}
+
+bool PathMatcher::check(const PathStep &step, TSNode entry, std::string_view source) const {
+    for (const PathPredicate &predicate : step.predicates) {
+        bool passed = false;
+        if (predicate.key == KeyTable::kNone) {
+            TSNode value = entry_value(entry);
+            passed = !ts_node_is_null(value) && predicate.test(node_text(value, source));
+        } else {
+            uint32_t count = ts_node_child_count(entry);
+            for (uint32_t i = 0; i < count && !passed; i++) {
+                TSNode child = ts_node_child(entry, i);
+                if (!is_entry(symbols_, ts_node_symbol(child))) continue;
+                if (query_.keys().find(entry_key(child, source)) != predicate.key) continue;
+                if (predicate.compare == PathCompare::Exists) {
+                    passed = true;
+                } else {
+                    TSNode value = entry_value(child);
+                    passed = !ts_node_is_null(value) && predicate.test(node_text(value, source));
+                }
+            }
+        }
+        if (!passed) return false;
+    }
+    return true;
+}
+
+std::vector<TSNode> PathMatcher::collect(TSNode root, std::string_view source) {
+    std::vector<TSNode> nodes;
+    run(root, source, [&](TSNode node) { nodes.push_back(node); });
+    return nodes;
+}
+
+PathMatch make_path_match(TSNode entry, std::string_view source) {
+    PathMatch match;
+    match.start_byte = ts_node_start_byte(entry);
+    match.end_byte = ts_node_end_byte(entry);
+    match.start_point = ts_node_start_point(entry);
+    match.key = std::string(entry_key(entry, source));
+    TSNode value = entry_value(entry);
+    if (!ts_node_is_null(value)) match.value = std::string(node_text(value, source));
+    return match;
+}
+
+std::vector<FileMatches> match_files(const PathQuery &query,
+                                     const std::vector<std::string> &paths,
+                                     unsigned threads) {
+    std::vector<FileMatches> results(paths.size());
+    if (threads == 0) threads = default_threads();
+    size_t workers = std::min<size_t>(threads, paths.size());
+
+    // With the arena allocator each file gets a fresh parser inside its
+    // worker's arena, which is dropped wholesale once the matches are copied
+    // out. Otherwise parsers are reused across files.
+    bool use_arena = arena_allocator_installed();
+    std::vector<Parser> parsers(use_arena ? 0 : workers);
+    std::vector<Arena> arenas(use_arena ? workers : 0);
+
+    parallel_for(paths.size(), threads, [&](size_t index, unsigned worker) {
+        FileMatches &result = results[index];
+        result.path = paths[index];
+        TraceScope file_scope("file", paths[index]);
+        std::string source;
+        {
+            TraceScope scope("read");
+            if (!read_file(paths[index], &source)) return;
+        }
+        result.ok = true;
+
+        auto collect = [&](Parser &parser) {
+            Tree tree;
+            {
+                TraceScope scope("parse");
+                tree = parser.parse(source);
+            }
+            TraceScope scope("match");
+            PathMatcher matcher(query);
+            matcher.run(ts_tree_root_node(tree.get()), source, [&](TSNode node) {
+                result.matches.push_back(make_path_match(node, source));
+            });
+        };
+        if (use_arena) {
+            {
+                ArenaScope scope(arenas[worker]);
+                Parser parser;
+                collect(parser);
+            }
+            arenas[worker].reset();
+        } else {
+            collect(parsers[worker]);
+        }
+    });
+    return results;
+}
+
+} // namespace objecttext
@@ -0,0 +1,240 @@
+#include "objecttext/path_query.h"
+
+#include "objecttext/value.h"
+
+namespace objecttext {
+
+KeyTable::KeyTable(const KeyTable &other) {
+    for (const std::string &name : other.names_) intern(name);
+}
+
+KeyTable &KeyTable::operator=(const KeyTable &other) {
+    if (this != &other) {
+        names_.clear();
+        ids_.clear();
+        for (const std::string &name : other.names_) intern(name);
+    }
+    return *this;
+}
+
+uint32_t KeyTable::intern(std::string_view key) {
+    auto found = ids_.find(key);
+    if (found != ids_.end()) return found->second;
+    uint32_t id = static_cast<uint32_t>(names_.size());
+    names_.emplace_back(key);
+    ids_.emplace(names_.back(), id);
+    return id;
+}
+
+uint32_t KeyTable::find(std::string_view key) const {
+    auto found = ids_.find(key);
+    return found == ids_.end() ? kNone : found->second;
+}
+
+bool PathPredicate::test(std::string_view value) const {
+    if (compare == PathCompare::Exists) return true;
+
+    std::string_view text_value = unquote(value);
+    double number_value = 0;
+    if (is_number) {
+        if (parse_number(text_value, &number_value)) {
+            switch (compare) {
+                case PathCompare::Equal: return number_value == number;
+                case PathCompare::NotEqual: return number_value != number;
+                case PathCompare::Less: return number_value < number;
+                case PathCompare::LessEqual: return number_value <= number;
+                case PathCompare::Greater: return number_value > number;
+                case PathCompare::GreaterEqual: return number_value >= number;
+                case PathCompare::Exists: break;
+            }
+            return true;
+        }
+        // A number only orders against numbers: `[> 100]` never matches
+        // `Name = abc`. `=` and `!=` still compare the text below.
+        if (compare != PathCompare::Equal && compare != PathCompare::NotEqual) return false;
+    }
+
+    int order = text_value.compare(text);
+    switch (compare) {
+        case PathCompare::Equal: return order == 0;
+        case PathCompare::NotEqual: return order != 0;
+        case PathCompare::Less: return order < 0;
+        case PathCompare::LessEqual: return order <= 0;
+        case PathCompare::Greater: return order > 0;
+        case PathCompare::GreaterEqual: return order >= 0;
+        case PathCompare::Exists: break;
+    }
+    return true;
+}
+
+static bool is_key_char(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+           (c >= '0' && c <= '9') || c == '_' || c == '.';
+}
+
+class PathQueryParser {
+public:
+    PathQueryParser(std::string_view source, PathQuery *query)
+        : source_(source), query_(query) {}
+
+    bool parse() {
+        skip_space();
+        if (peek() == '/') position_++;
+        do {
+            if (!parse_step()) return false;
+            skip_space();
+        } while (eat('/'));
+        if (position_ != source_.size()) return fail(PathQueryError::Syntax);
+        return true;
+    }
+
+    uint32_t position() const { return static_cast<uint32_t>(position_); }
+    PathQueryError error() const { return error_; }
+
+private:
+    std::string_view source_;
+    size_t position_ = 0;
+    PathQuery *query_;
+    PathQueryError error_ = PathQueryError::None;
+
+    char peek() const { return position_ < source_.size() ? source_[position_] : '\0'; }
+
+    bool eat(char c) {
+        if (peek() != c) return false;
+        position_++;
+        return true;
+    }
+
+    void skip_space() {
+        while (peek() == ' ' || peek() == '\t') position_++;
+    }
+
+    bool fail(PathQueryError error) {
+        error_ = error;
+        return false;
+    }
+
+    bool parse_key(std::string *key) {
+        if (eat('"')) {
+            size_t end = source_.find('"', position_);
+            if (end == std::string_view::npos) return fail(PathQueryError::Syntax);
+            key->assign(source_.substr(position_, end - position_));
+            position_ = end + 1;
+            return true;
+        }
+        size_t start = position_;
+        while (is_key_char(peek())) position_++;
+        if (position_ == start) return fail(PathQueryError::Syntax);
+        key->assign(source_.substr(start, position_ - start));
+        return true;
+    }
+
+    bool parse_compare(PathCompare *compare) {
+        if (eat('=')) *compare = PathCompare::Equal;
+        else if (eat('!')) {
+            if (!eat('=')) return fail(PathQueryError::Syntax);
+            *compare = PathCompare::NotEqual;
+        } else if (eat('<')) *compare = eat('=') ? PathCompare::LessEqual : PathCompare::Less;
+        else if (eat('>')) *compare = eat('=') ? PathCompare::GreaterEqual : PathCompare::Greater;
+        else *compare = PathCompare::Exists;
+        return true;
+    }
+
+    bool parse_literal(PathPredicate *predicate) {
+        if (eat('"')) {
+            size_t end = source_.find('"', position_);
+            if (end == std::string_view::npos) return fail(PathQueryError::Syntax);
+            predicate->text.assign(source_.substr(position_, end - position_));
+            position_ = end + 1;
+            return true;
+        }
+        size_t start = position_;
+        while (position_ < source_.size() && source_[position_] != ']') position_++;
+        std::string_view literal = source_.substr(start, position_ - start);
+        while (!literal.empty() && (literal.back() == ' ' || literal.back() == '\t')) {
+            literal.remove_suffix(1);
+        }
+        if (literal.empty()) return fail(PathQueryError::Syntax);
+        predicate->text.assign(literal);
+        predicate->is_number = parse_number(literal, &predicate->number);
+        return true;
+    }
+
+    bool parse_predicate(PathStep *step) {
+        PathPredicate predicate;
+        skip_space();
+        if (is_key_char(peek()) || peek() == '"') {
+            std::string key;
+            if (!parse_key(&key)) return false;
+            predicate.key = query_->keys_.intern(key);
+            skip_space();
+        }
+        if (!parse_compare(&predicate.compare)) return false;
+        if (predicate.compare == PathCompare::Exists) {
+            if (predicate.key == KeyTable::kNone) return fail(PathQueryError::Syntax);
+        } else {
+            skip_space();
+            if (!parse_literal(&predicate)) return false;
+        }
+        skip_space();
+        if (!eat(']')) return fail(PathQueryError::Syntax);
+        step->predicates.push_back(std::move(predicate));
+        return true;
+    }
+
+    bool parse_step() {
+        skip_space();
+        if (query_->steps_.size() == PathQuery::kMaxSteps) {
+            return fail(PathQueryError::TooManySteps);
+        }
+
+        PathStep step;
+        if (eat('*')) {
+            step.kind = eat('*') ? PathStepKind::Descendants : PathStepKind::Wildcard;
+        } else {
+            std::string key;
+            if (!parse_key(&key)) return false;
+            step.kind = PathStepKind::Key;
+            step.key = query_->keys_.intern(key);
+        }
+
+        skip_space();
+        while (eat('[')) {
+            if (step.kind == PathStepKind::Descendants) return fail(PathQueryError::Syntax);
+            if (!parse_predicate(&step)) return false;
+            skip_space();
+        }
+        query_->steps_.push_back(std::move(step));
+        return true;
+    }
+};
+
+std::optional<PathQuery> PathQuery::compile(std::string_view source,
+                                            uint32_t *error_offset,
+                                            PathQueryError *error) {
+    PathQuery query;
+    query.source_.assign(source);
+    PathQueryParser parser(source, &query);
+    bool ok = parser.parse();
+    if (error_offset) *error_offset = ok ? 0 : parser.position();
+    if (error) *error = parser.error();
+    if (!ok) return std::nullopt;
+
+    // closure_[i] is state i plus every state reachable from it without
+    // consuming a key, i.e. by letting a run of `**` steps match nothing.
+    size_t count = query.steps_.size();
+    query.closure_.assign(count + 1, 0);
+    query.closure_[count] = uint64_t(1) << count;
+    for (size_t i = count; i-- > 0;) {
+        query.closure_[i] = uint64_t(1) << i;
+        if (query.steps_[i].kind == PathStepKind::Descendants) {
+            query.closure_[i] |= query.closure_[i + 1];
+        }
+        if (query.steps_[i].kind == PathStepKind::Key) {
+            query.key_states_ |= uint64_t(1) << i;
+        }
+    }
+    return query;
+}
+
+} // namespace objecttext
@@ -0,0 +1,78 @@
+#include "objecttext/queries.h"
+
+#include <tree_sitter/tree-sitter-objecttext.h>
+
+namespace objecttext {
+
+QueryRegistry &QueryRegistry::global() {
+    static QueryRegistry registry;
+    return registry;
+}
+
+const TSQuery *QueryRegistry::get(QueryPack pack) {
+    size_t index = static_cast<size_t>(pack);
+    std::call_once(pack_once_[index], [&] { packs_[index] = get(query_pack_source(pack)); });
+    return packs_[index];
+}
+
+const TSQuery *QueryRegistry::get(std::string_view source,
+                                  uint32_t *error_offset,
+                                  TSQueryError *error_type) {
+    const Entry *entry = nullptr;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto found = entries_.find(std::string(source));
+        if (found != entries_.end()) entry = found->second.get();
+    }
+
+    if (!entry) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        std::unique_ptr<Entry> &slot = entries_[std::string(source)];
+        if (!slot) {
+            slot = std::make_unique<Entry>();
+            slot->query = ts_query_new(tree_sitter_objecttext(), source.data(),
+                                       static_cast<uint32_t>(source.size()),
+                                       &slot->error_offset, &slot->error_type);
+        }
+        entry = slot.get();
+    }
+
+    if (error_offset) *error_offset = entry->error_offset;
+    if (error_type) *error_type = entry->error_type;
+    return entry->query;
+}
+
+namespace {
+
+struct CursorPool {
+    std::vector<TSQueryCursor *> cursors;
+
+    ~CursorPool() {
+        for (TSQueryCursor *cursor : cursors) ts_query_cursor_delete(cursor);
+    }
+};
+
+thread_local CursorPool cursor_pool;
+
+} // namespace
+
+QueryCursor::QueryCursor() {
+    if (cursor_pool.cursors.empty()) {
+        cursor_ = ts_query_cursor_new();
+    } else {
+        cursor_ = cursor_pool.cursors.back();
+        cursor_pool.cursors.pop_back();
+    }
+}
+
+QueryCursor::~QueryCursor() {
+    // ts_query_cursor_exec keeps the ranges and limits of the last user, so
+    // put back the defaults of ts_query_cursor_new before the next borrower.
+    ts_query_cursor_set_byte_range(cursor_, 0, UINT32_MAX);
+    ts_query_cursor_set_point_range(cursor_, {0, 0}, {UINT32_MAX, UINT32_MAX});
+    ts_query_cursor_set_match_limit(cursor_, UINT32_MAX);
+    ts_query_cursor_set_max_start_depth(cursor_, UINT32_MAX);
+    cursor_pool.cursors.push_back(cursor_);
+}
+
+} // namespace objecttext
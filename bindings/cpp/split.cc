@@ -0,0 +1,408 @@
+#include "objecttext/split.h"
+
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "objecttext/parallel.h"
+#include "objecttext/structure.h"
+#include "objecttext/trace.h"
+
+namespace objecttext {
+
+namespace {
+
+using ByteRange = std::pair<uint32_t, uint32_t>;
+
+// A chunk before it is parsed.
+struct Piece {
+    std::vector<ByteRange> ranges;
+    uint32_t spine;
+};
+
+bool is_blank(std::string_view text) {
+    return text.find_first_not_of(" \t\r\n") == std::string_view::npos;
+}
+
+class Splitter {
+public:
+    Splitter(std::string_view source, const StructureIndex &index, size_t chunk_bytes)
+        : source_(source), blocks_(index.blocks()), chunk_bytes_(chunk_bytes) {}
+
+    // Splits the body of |block|, whose header and closing bracket (and
+    // those of its ancestors) are already in |prefix| and |suffix|.
+    void split(size_t block, std::vector<ByteRange> prefix, std::vector<ByteRange> suffix) {
+        const StructureSpan &span = blocks_[block];
+        uint32_t run_start = span.start_byte + 1;
+        size_t child = block + 1;
+        while (child < blocks_.size() && blocks_[child].start_byte < span.end_byte) {
+            const StructureSpan &current = blocks_[child];
+            size_t next = next_sibling(child);
+            uint32_t start = statement_start(current);
+            if (next > child + 1 && start != UINT32_MAX &&
+                current.end_byte - start > chunk_bytes_) {
+                emit(prefix, run_start, start, suffix);
+                std::vector<ByteRange> inner_prefix = prefix;
+                inner_prefix.emplace_back(start, current.start_byte + 1);
+                std::vector<ByteRange> inner_suffix{{current.end_byte - 1, current.end_byte}};
+                inner_suffix.insert(inner_suffix.end(), suffix.begin(), suffix.end());
+                split(child, std::move(inner_prefix), std::move(inner_suffix));
+                run_start = current.end_byte;
+            } else if (current.end_byte - run_start >= chunk_bytes_) {
+                emit(prefix, run_start, current.end_byte, suffix);
+                run_start = current.end_byte;
+            }
+            child = next;
+        }
+        emit(prefix, run_start, span.end_byte - 1, suffix);
+    }
+
+    std::vector<Piece> pieces;
+
+private:
+    std::string_view source_;
+    const std::vector<StructureSpan> &blocks_;
+    size_t chunk_bytes_;
+
+    size_t next_sibling(size_t block) const {
+        size_t next = block + 1;
+        while (next < blocks_.size() && blocks_[next].depth > blocks_[block].depth) next++;
+        return next;
+    }
+
+    // Where the statement holding |span| starts, or UINT32_MAX if that is not
+    // certain, e.g. for an unnamed block that may follow `: extension`.
+    uint32_t statement_start(const StructureSpan &span) const {
+        if (span.key_start != span.start_byte) return span.key_start;
+        size_t before = source_.find_last_not_of(" \t\r\n", span.start_byte - 1);
+        if (before == std::string_view::npos) return UINT32_MAX;
+        char c = source_[before];
+        return c == '{' || c == '[' || c == '}' || c == ']' ? span.start_byte : UINT32_MAX;
+    }
+
+    void emit(const std::vector<ByteRange> &prefix, uint32_t start, uint32_t end,
+              const std::vector<ByteRange> &suffix) {
+        if (start >= end || is_blank(source_.substr(start, end - start))) return;
+        Piece piece;
+        piece.spine = static_cast<uint32_t>(prefix.size());
+        piece.ranges = prefix;
+        piece.ranges.emplace_back(start, end);
+        piece.ranges.insert(piece.ranges.end(), suffix.begin(), suffix.end());
+        pieces.push_back(std::move(piece));
+    }
+};
+
+bool is_identifier_start(std::string_view text) {
+    auto word = [](char c) {
+        return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+    };
+    if (text.empty()) return false;
+    if (text[0] == '.') return text.size() > 1 && word(text[1]);
+    return word(text[0]);
+}
+
+// Slices of a broken file, each a run of top-level entries of about
+// |slice_bytes| with the root header and, if the file ends with one, its
+// closing bracket. An entry starts on a line outside block comments that is
+// indented like the first entry of the root block and begins with an
+// identifier. Returns nothing if there is no root block to slice.
+std::vector<Piece> resync_pieces(std::string_view source, size_t slice_bytes) {
+    StructureIndex index = StructureIndex::build(source);
+    if (index.blocks().empty()) return {};
+    const uint32_t size = static_cast<uint32_t>(source.size());
+    const uint32_t body_start = index.blocks()[0].start_byte + 1;
+
+    std::vector<ByteRange> suffix;
+    uint32_t body_end = size;
+    size_t last = source.find_last_not_of(" \t\r\n");
+    if (last != std::string_view::npos && last >= body_start &&
+        (source[last] == '}' || source[last] == ']')) {
+        body_end = static_cast<uint32_t>(last);
+        suffix.emplace_back(body_end, size);
+    }
+
+    const std::vector<StructureSpan> &comments = index.comments();
+    size_t comment = 0;
+    auto in_comment = [&](uint32_t offset) {
+        while (comment < comments.size() && comments[comment].end_byte <= offset) comment++;
+        return comment < comments.size() && comments[comment].start_byte < offset;
+    };
+
+    std::vector<uint32_t> starts;
+    std::string_view indent;
+    bool have_indent = false;
+    for (size_t line = source.find('\n', body_start); line < body_end;
+         line = source.find('\n', line)) {
+        uint32_t start = static_cast<uint32_t>(++line);
+        if (start >= body_end || in_comment(start)) continue;
+        std::string_view rest = source.substr(start, body_end - start);
+        size_t text = rest.find_first_not_of(" \t");
+        if (text == std::string_view::npos) break;
+        if (!have_indent) {
+            if (!is_identifier_start(rest.substr(text))) continue;
+            indent = rest.substr(0, text);
+            have_indent = true;
+        }
+        if (text == indent.size() && rest.substr(0, text) == indent &&
+            is_identifier_start(rest.substr(text))) {
+            starts.push_back(start);
+        }
+    }
+
+    std::vector<Piece> pieces;
+    auto emit = [&](uint32_t start, uint32_t end) {
+        Piece piece;
+        piece.spine = 1;
+        piece.ranges = {{0, body_start}, {start, end}};
+        piece.ranges.insert(piece.ranges.end(), suffix.begin(), suffix.end());
+        pieces.push_back(std::move(piece));
+    };
+    uint32_t run_start = body_start;
+    for (uint32_t start : starts) {
+        if (start - run_start >= slice_bytes &&
+            !is_blank(source.substr(run_start, start - run_start))) {
+            emit(run_start, start);
+            run_start = start;
+        }
+    }
+    if (run_start < body_end) emit(run_start, body_end);
+    return pieces;
+}
+
+// Resolves the points of every range boundary in one pass over the source.
+std::vector<SplitChunk> to_chunks(std::string_view source, std::vector<Piece> pieces) {
+    std::vector<uint32_t> offsets;
+    for (const Piece &piece : pieces) {
+        for (const ByteRange &range : piece.ranges) {
+            offsets.push_back(range.first);
+            offsets.push_back(range.second);
+        }
+    }
+    std::sort(offsets.begin(), offsets.end());
+    offsets.erase(std::unique(offsets.begin(), offsets.end()), offsets.end());
+
+    std::vector<TSPoint> points(offsets.size());
+    uint32_t row = 0;
+    size_t line_start = 0;
+    size_t previous = 0;
+    for (size_t i = 0; i < offsets.size(); i++) {
+        std::string_view between = source.substr(previous, offsets[i] - previous);
+        size_t newlines = count_newlines(between);
+        if (newlines) {
+            row += static_cast<uint32_t>(newlines);
+            line_start = previous + between.rfind('\n') + 1;
+        }
+        points[i] = {row, static_cast<uint32_t>(offsets[i] - line_start)};
+        previous = offsets[i];
+    }
+    auto point_at = [&](uint32_t offset) {
+        return points[std::lower_bound(offsets.begin(), offsets.end(), offset) - offsets.begin()];
+    };
+
+    std::vector<SplitChunk> chunks(pieces.size());
+    for (size_t i = 0; i < pieces.size(); i++) {
+        chunks[i].spine = pieces[i].spine;
+        for (const ByteRange &range : pieces[i].ranges) {
+            chunks[i].ranges.push_back(
+                {point_at(range.first), point_at(range.second), range.first, range.second});
+        }
+    }
+    return chunks;
+}
+
+// The block whose body a chunk holds, or the `source_file` node.
+TSNode body_container(const SplitChunk &chunk) {
+    const Symbols &symbols = Symbols::get();
+    TSNode node = ts_tree_root_node(chunk.tree.get());
+    uint32_t body_start = chunk.body().start_byte;
+    for (uint32_t level = 0; level < chunk.spine; level++) {
+        uint32_t count = ts_node_child_count(node);
+        TSNode next = {};
+        for (uint32_t i = 0; i < count; i++) {
+            TSNode child = ts_node_child(node, i);
+            if (is_entry(symbols, ts_node_symbol(child)) && ts_node_start_byte(child) < body_start &&
+                ts_node_end_byte(child) > body_start) {
+                next = child;
+                break;
+            }
+        }
+        if (ts_node_is_null(next)) break;
+        node = next;
+    }
+    return node;
+}
+
+uint32_t count_body_entries(const SplitChunk &chunk) {
+    if (!chunk.tree) return 0;
+    const Symbols &symbols = Symbols::get();
+    TSNode container = body_container(chunk);
+    const TSRange &body = chunk.body();
+    uint32_t entries = 0;
+    uint32_t count = ts_node_child_count(container);
+    for (uint32_t i = 0; i < count; i++) {
+        TSNode child = ts_node_child(container, i);
+        uint32_t start = ts_node_start_byte(child);
+        if (start >= body.start_byte && start < body.end_byte &&
+            is_entry(symbols, ts_node_symbol(child))) {
+            entries++;
+        }
+    }
+    return entries;
+}
+
+// Chunks are in document order, so counting the entries of every container
+// as chunks go by gives each spine block and each body its index.
+void assign_index_bases(std::vector<SplitChunk> &chunks) {
+    const uint32_t kSourceFile = UINT32_MAX;
+    std::unordered_map<uint32_t, uint32_t> seen;     // container -> entries so far
+    std::unordered_map<uint32_t, uint32_t> indices;  // spine block -> its index
+    for (SplitChunk &chunk : chunks) {
+        chunk.index_bases.clear();
+        uint32_t parent = kSourceFile;
+        for (uint32_t level = 0; level < chunk.spine; level++) {
+            uint32_t block = chunk.ranges[level].start_byte;
+            auto inserted = indices.emplace(block, 0);
+            if (inserted.second) inserted.first->second = seen[parent]++;
+            chunk.index_bases.push_back(inserted.first->second);
+            parent = block;
+        }
+        chunk.index_bases.push_back(seen[parent]);
+        seen[parent] += count_body_entries(chunk);
+    }
+}
+
+} // namespace
+
+SplitDocument SplitDocument::parse(std::string_view source, const SplitOptions &options) {
+    unsigned threads = options.threads ? options.threads : default_threads();
+    size_t chunk_bytes = options.chunk_bytes
+        ? options.chunk_bytes
+        : std::max<size_t>(source.size() / (size_t(threads) * 4), 256 << 10);
+
+    std::vector<Piece> pieces;
+    if (source.size() >= options.min_split_bytes) {
+        TraceScope scope("prescan");
+        StructureIndex index = StructureIndex::build(source);
+        const std::vector<StructureSpan> &blocks = index.blocks();
+        bool single_root = !blocks.empty() &&
+            std::none_of(blocks.begin() + 1, blocks.end(),
+                         [](const StructureSpan &span) { return span.depth == 0; });
+        if (index.balanced() && single_root) {
+            // Whatever surrounds the root block, such as leading comments,
+            // goes into every chunk with its header and closing bracket.
+            Splitter splitter(source, index, chunk_bytes);
+            uint32_t end = static_cast<uint32_t>(source.size());
+            splitter.split(0, {{0, blocks[0].start_byte + 1}}, {{blocks[0].end_byte - 1, end}});
+            pieces = std::move(splitter.pieces);
+        }
+    }
+    if (pieces.empty()) pieces.push_back({{{0, static_cast<uint32_t>(source.size())}}, 0});
+
+    SplitDocument document;
+    document.source_ = source;
+    document.chunks_ = to_chunks(source, std::move(pieces));
+
+    std::vector<Parser> parsers(std::min<size_t>(threads, document.chunks_.size()));
+    parallel_for(document.chunks_.size(), threads, [&](size_t index, unsigned worker) {
+        SplitChunk &chunk = document.chunks_[index];
+        TraceScope scope("parse chunk");
+        TSParser *parser = parsers[worker].get();
+        if (chunk.spine == 0) {
+            ts_parser_set_included_ranges(parser, nullptr, 0);
+        } else {
+            ts_parser_set_included_ranges(parser, chunk.ranges.data(),
+                                          static_cast<uint32_t>(chunk.ranges.size()));
+        }
+        ParseLimits limits;
+        limits.cancel = options.cancel;
+        ParseStatus status;
+        chunk.tree = parsers[worker].parse(source, limits, &status);
+        if (!chunk.tree) parsers[worker].reset();
+    });
+    TraceScope scope("index bases");
+    assign_index_bases(document.chunks_);
+    return document;
+}
+
+SplitDocument SplitDocument::recover(std::string_view source, const RecoveryOptions &options) {
+    unsigned threads = options.threads ? options.threads : default_threads();
+    auto limit = [&](size_t bytes) {
+        return std::chrono::nanoseconds(static_cast<int64_t>(
+            options.recovery_fixed_ms * 1e6 + options.recovery_ns_per_byte * double(bytes)));
+    };
+
+    SplitDocument document;
+    document.source_ = source;
+    Tree whole;
+    {
+        TraceScope scope("parse whole");
+        Parser parser;
+        whole = parser.parse_with_recovery_limit(source, limit(source.size()));
+    }
+    std::vector<Piece> pieces;
+    if (!whole || ts_node_has_error(ts_tree_root_node(whole.get()))) {
+        TraceScope scope("resync");
+        pieces = resync_pieces(source, options.slice_bytes);
+    }
+    if (pieces.size() <= 1) {
+        document.chunks_ = to_chunks(source, {{{{0, static_cast<uint32_t>(source.size())}}, 0}});
+        document.chunks_[0].tree = std::move(whole);
+        assign_index_bases(document.chunks_);
+        return document;
+    }
+    whole.reset();
+
+    document.chunks_ = to_chunks(source, std::move(pieces));
+    std::vector<Parser> parsers(std::min<size_t>(threads, document.chunks_.size()));
+    parallel_for(document.chunks_.size(), threads, [&](size_t index, unsigned worker) {
+        SplitChunk &chunk = document.chunks_[index];
+        TraceScope scope("parse slice");
+        Parser &parser = parsers[worker];
+        ts_parser_set_included_ranges(parser.get(), chunk.ranges.data(),
+                                      static_cast<uint32_t>(chunk.ranges.size()));
+        chunk.tree = parser.parse_with_recovery_limit(source, limit(chunk.body().end_byte -
+                                                                    chunk.body().start_byte));
+    });
+    assign_index_bases(document.chunks_);
+    return document;
+}
+
+bool SplitDocument::has_error() const {
+    return std::any_of(chunks_.begin(), chunks_.end(), [](const SplitChunk &chunk) {
+        return !chunk.tree || ts_node_has_error(ts_tree_root_node(chunk.tree.get()));
+    });
+}
+
+std::vector<PathMatch> SplitDocument::match(const PathQuery &query, unsigned threads) const {
+    std::vector<std::vector<PathMatch>> per_chunk(chunks_.size());
+    parallel_for(chunks_.size(), threads, [&](size_t index, unsigned) {
+        const SplitChunk &chunk = chunks_[index];
+        if (!chunk.tree) return;
+        PathMatcher matcher(query);
+        matcher.set_index_bases(chunk.index_bases);
+        matcher.run(ts_tree_root_node(chunk.tree.get()), source_, [&](TSNode node) {
+            per_chunk[index].push_back(make_path_match(node, source_));
+        });
+    });
+
+    // Spine blocks start before the body of every chunk that repeats them.
+    std::vector<PathMatch> matches;
+    std::unordered_set<uint32_t> spine_matches;
+    for (size_t index = 0; index < chunks_.size(); index++) {
+        uint32_t body_start = chunks_[index].body().start_byte;
+        for (PathMatch &match : per_chunk[index]) {
+            if (match.start_byte < body_start && !spine_matches.insert(match.start_byte).second) {
+                continue;
+            }
+            matches.push_back(std::move(match));
+        }
+    }
+    std::stable_sort(matches.begin(), matches.end(), [](const PathMatch &a, const PathMatch &b) {
+        return a.start_byte < b.start_byte;
+    });
+    return matches;
+}
+
+} // namespace objecttext
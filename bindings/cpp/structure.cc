@@ -0,0 +1,539 @@
+#include "objecttext/structure.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OBJECTTEXT_SSE2 1
+#if defined(__PCLMUL__)
+#include <wmmintrin.h>
+#endif
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define OBJECTTEXT_NEON 1
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace objecttext {
+
+namespace {
+
+inline unsigned lowest_bit(uint64_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return index;
+#else
+    return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+}
+
+inline unsigned popcount(uint64_t mask) {
+#ifdef _MSC_VER
+    return static_cast<unsigned>(__popcnt64(mask));
+#else
+    return static_cast<unsigned>(__builtin_popcountll(mask));
+#endif
+}
+
+// Bitmasks for one 64-byte block: bit i is set if byte i is of the class.
+struct BlockMasks {
+    uint64_t interesting; // { } [ ] = : @ /
+    uint64_t quote;
+    uint64_t backslash;   // left empty when the block has no backslash
+    uint64_t newline;
+};
+
+#if OBJECTTEXT_SSE2
+
+inline uint64_t movemask4(__m128i a, __m128i b, __m128i c, __m128i d) {
+    return static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(a))) |
+           static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(b))) << 16 |
+           static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(c))) << 32 |
+           static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(d))) << 48;
+}
+
+inline __m128i classify16(__m128i bytes) {
+    __m128i result = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('{'));
+    result = _mm_or_si128(result, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('}')));
+    result = _mm_or_si128(result, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('[')));
+    result = _mm_or_si128(result, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(']')));
+    result = _mm_or_si128(result, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('=')));
+    result = _mm_or_si128(result, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(':')));
+    result = _mm_or_si128(result, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('@')));
+    result = _mm_or_si128(result, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('/')));
+    return result;
+}
+
+inline BlockMasks classify(const char *block) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16));
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 32));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 48));
+    __m128i quote = _mm_set1_epi8('"');
+    __m128i backslash = _mm_set1_epi8('\\');
+    __m128i newline = _mm_set1_epi8('\n');
+    __m128i backslash_a = _mm_cmpeq_epi8(a, backslash), backslash_b = _mm_cmpeq_epi8(b, backslash);
+    __m128i backslash_c = _mm_cmpeq_epi8(c, backslash), backslash_d = _mm_cmpeq_epi8(d, backslash);
+    bool any_backslash = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(backslash_a, backslash_b),
+                                                        _mm_or_si128(backslash_c, backslash_d)));
+    return BlockMasks{
+        movemask4(classify16(a), classify16(b), classify16(c), classify16(d)),
+        movemask4(_mm_cmpeq_epi8(a, quote), _mm_cmpeq_epi8(b, quote),
+                  _mm_cmpeq_epi8(c, quote), _mm_cmpeq_epi8(d, quote)),
+        any_backslash ? movemask4(backslash_a, backslash_b, backslash_c, backslash_d) : 0,
+        movemask4(_mm_cmpeq_epi8(a, newline), _mm_cmpeq_epi8(b, newline),
+                  _mm_cmpeq_epi8(c, newline), _mm_cmpeq_epi8(d, newline)),
+    };
+}
+
+inline uint64_t newline_mask(const char *block) {
+    __m128i newline = _mm_set1_epi8('\n');
+    return movemask4(
+        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(block)), newline),
+        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16)), newline),
+        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 32)), newline),
+        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 48)), newline));
+}
+
+#elif OBJECTTEXT_NEON
+
+inline uint64_t movemask4(uint8x16_t a, uint8x16_t b, uint8x16_t c, uint8x16_t d) {
+    const uint8x16_t bits = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t sum_ab = vpaddq_u8(vandq_u8(a, bits), vandq_u8(b, bits));
+    uint8x16_t sum_cd = vpaddq_u8(vandq_u8(c, bits), vandq_u8(d, bits));
+    uint8x16_t sum = vpaddq_u8(sum_ab, sum_cd);
+    sum = vpaddq_u8(sum, sum);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(sum), 0);
+}
+
+inline uint8x16_t classify16(uint8x16_t bytes) {
+    uint8x16_t result = vceqq_u8(bytes, vdupq_n_u8('{'));
+    result = vorrq_u8(result, vceqq_u8(bytes, vdupq_n_u8('}')));
+    result = vorrq_u8(result, vceqq_u8(bytes, vdupq_n_u8('[')));
+    result = vorrq_u8(result, vceqq_u8(bytes, vdupq_n_u8(']')));
+    result = vorrq_u8(result, vceqq_u8(bytes, vdupq_n_u8('=')));
+    result = vorrq_u8(result, vceqq_u8(bytes, vdupq_n_u8(':')));
+    result = vorrq_u8(result, vceqq_u8(bytes, vdupq_n_u8('@')));
+    result = vorrq_u8(result, vceqq_u8(bytes, vdupq_n_u8('/')));
+    return result;
+}
+
+inline BlockMasks classify(const char *block) {
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(block);
+    uint8x16_t a = vld1q_u8(bytes), b = vld1q_u8(bytes + 16);
+    uint8x16_t c = vld1q_u8(bytes + 32), d = vld1q_u8(bytes + 48);
+    uint8x16_t quote = vdupq_n_u8('"');
+    uint8x16_t backslash = vdupq_n_u8('\\');
+    uint8x16_t newline = vdupq_n_u8('\n');
+    uint8x16_t backslash_a = vceqq_u8(a, backslash), backslash_b = vceqq_u8(b, backslash);
+    uint8x16_t backslash_c = vceqq_u8(c, backslash), backslash_d = vceqq_u8(d, backslash);
+    bool any_backslash = vmaxvq_u8(vorrq_u8(vorrq_u8(backslash_a, backslash_b),
+                                            vorrq_u8(backslash_c, backslash_d)));
+    return BlockMasks{
+        movemask4(classify16(a), classify16(b), classify16(c), classify16(d)),
+        movemask4(vceqq_u8(a, quote), vceqq_u8(b, quote), vceqq_u8(c, quote), vceqq_u8(d, quote)),
+        any_backslash ? movemask4(backslash_a, backslash_b, backslash_c, backslash_d) : 0,
+        movemask4(vceqq_u8(a, newline), vceqq_u8(b, newline),
+                  vceqq_u8(c, newline), vceqq_u8(d, newline)),
+    };
+}
+
+inline uint64_t newline_mask(const char *block) {
+    return classify(block).newline;
+}
+
+#else
+
+inline BlockMasks classify(const char *block) {
+    BlockMasks masks{0, 0, 0, 0};
+    for (unsigned i = 0; i < 64; i++) {
+        switch (block[i]) {
+            case '{': case '}': case '[': case ']': case '=': case ':':
+            case '@': case '/':
+                masks.interesting |= uint64_t(1) << i;
+                break;
+            case '"':
+                masks.quote |= uint64_t(1) << i;
+                break;
+            case '\\':
+                masks.backslash |= uint64_t(1) << i;
+                break;
+            case '\n':
+                masks.newline |= uint64_t(1) << i;
+                break;
+            default:
+                break;
+        }
+    }
+    return masks;
+}
+
+inline uint64_t newline_mask(const char *block) {
+    return classify(block).newline;
+}
+
+#endif
+
+// Bit i of the result is the XOR of bits 0..i of |bits|: given the quotes
+// that open and close strings, the bytes from each opening quote up to its
+// closing one. A carry-less multiply by all ones computes it in one step.
+inline uint64_t prefix_xor(uint64_t bits) {
+#if defined(__PCLMUL__) && defined(__x86_64__)
+    __m128i product = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<int64_t>(bits)),
+                                           _mm_set1_epi8(-1), 0);
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(product));
+#elif OBJECTTEXT_NEON && defined(__ARM_FEATURE_AES)
+    return vgetq_lane_u64(vreinterpretq_u64_p128(vmull_p64(bits, ~uint64_t(0))), 0);
+#else
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+#endif
+}
+
+// Classifies the 64-byte block at |offset|, padding past the end of the
+// input with spaces.
+inline BlockMasks classify_at(std::string_view source, size_t offset) {
+    if (offset + 64 <= source.size()) return classify(source.data() + offset);
+    char padded[64];
+    memset(padded, ' ', sizeof(padded));
+    memcpy(padded, source.data() + offset, source.size() - offset);
+    return classify(padded);
+}
+
+// Byte classes for the scans around keys and values, looked up in a table.
+enum : uint8_t { kSpace = 1, kBlank = 2, kKey = 4, kEndsStatement = 8, kNotBare = 16 };
+
+struct ByteClasses {
+    uint8_t table[256] = {};
+
+    ByteClasses() {
+        for (unsigned char c : {' ', '\t'}) table[c] |= kSpace | kBlank;
+        for (unsigned char c : {'\r', '\n'}) table[c] |= kSpace | kEndsStatement;
+        for (unsigned char c : {'{', '}', '[', ']', '/'}) table[c] |= kEndsStatement;
+        for (unsigned c = 'A'; c <= 'Z'; c++) table[c] |= kKey;
+        for (unsigned c = 'a'; c <= 'z'; c++) table[c] |= kKey;
+        for (unsigned c = '0'; c <= '9'; c++) table[c] |= kKey | kNotBare;
+        table[static_cast<unsigned char>('_')] |= kKey;
+        table[static_cast<unsigned char>('.')] |= kKey;
+        for (unsigned char c : {'\0', '\r', '\n', '[', '{', '"', '@', '&', '(', '-', '.', '/'}) {
+            table[c] |= kNotBare;
+        }
+    }
+};
+
+const ByteClasses byte_classes;
+
+inline bool is(char c, uint8_t classes) {
+    return byte_classes.table[static_cast<unsigned char>(c)] & classes;
+}
+
+// Steps back from |end| over bytes of |classes|, eight spaces of
+// indentation at a time.
+inline size_t skip_back(std::string_view source, size_t end, uint8_t classes) {
+    const uint64_t spaces = 0x2020202020202020;
+    uint64_t word;
+    while (end >= 8 && (memcpy(&word, source.data() + end - 8, 8), word == spaces)) end -= 8;
+    while (end > 0 && is(source[end - 1], classes)) end--;
+    return end;
+}
+
+size_t find_byte(std::string_view source, size_t from, char c) {
+    if (from >= source.size()) return source.size();
+    const void *found = memchr(source.data() + from, c, source.size() - from);
+    return found ? static_cast<const char *>(found) - source.data() : source.size();
+}
+
+// Offset just past a `"` string starting after |from|. Strings cannot span
+// lines, so an unterminated one ends at the newline.
+size_t skip_string(std::string_view source, size_t from) {
+    for (size_t i = from; i < source.size(); i++) {
+        char c = source[i];
+        if (c == '"') return i + 1;
+        if (c == '\n') return i;
+        if (c == '\\' && i + 1 < source.size() && source[i + 1] == '"') i++;
+    }
+    return source.size();
+}
+
+size_t skip_block_comment(std::string_view source, size_t from) {
+    for (size_t i = find_byte(source, from, '*'); i < source.size(); i = find_byte(source, i + 1, '*')) {
+        if (i + 1 < source.size() && source[i + 1] == '/') return i + 2;
+    }
+    return source.size();
+}
+
+// After `=`, a value that is not a bracket, string, verbatim or expression
+// is a bare word running to the end of the line, brackets included.
+bool starts_bare_word(std::string_view source, size_t from) {
+    size_t i = from;
+    while (i < source.size() && (source[i] == ' ' || source[i] == '\t')) i++;
+    return i < source.size() && !is(source[i], kNotBare);
+}
+
+// The key naming the block opened at |offset|: the identifier before the
+// bracket, or before the `=` or `:` at |previous|, the structural before it.
+// Only a key that starts its own statement counts, not the tail of a value
+// such as `X = 5` on the line before an unnamed block.
+void block_key(std::string_view source, size_t offset, size_t previous,
+               size_t *key_start, size_t *key_end) {
+    size_t end = offset;
+    if (previous < offset) {
+        char before = source[previous];
+        if (before == ':') {
+            end = previous;
+        } else if (before == '=') {
+            size_t i = previous + 1;
+            while (i < offset && is(source[i], kSpace)) i++;
+            if (i == offset) end = previous;
+        }
+    }
+    end = skip_back(source, end, kSpace);
+    size_t start = end;
+    while (start > 0 && is(source[start - 1], kKey)) start--;
+
+    size_t before_key = skip_back(source, start, kBlank);
+    bool standalone = before_key == 0 || is(source[before_key - 1], kEndsStatement);
+    if (!standalone || start == end) start = end = offset;
+    *key_start = start;
+    *key_end = end;
+}
+
+// Indexes the blocks of a source in order. |skip_until_| carries state from
+// one block to the next: bytes before it belong to a string, comment or
+// bare word that an earlier block started.
+class Scanner {
+public:
+    Scanner(std::string_view source, std::vector<uint32_t> *structurals,
+            std::vector<StructureSpan> *blocks, std::vector<StructureSpan> *comments)
+        : source_(source), structurals_(*structurals), blocks_(*blocks), comments_(*comments) {}
+
+    // Indexes the block at |block|, whose first row is |row_base|.
+    void scan(size_t block, const BlockMasks &masks, uint32_t row_base) {
+        block_ = block;
+        newline_ = masks.newline;
+        row_base_ = row_base;
+        uint64_t live = ~uint64_t(0);
+        if (skip_until_ > block) {
+            if (skip_until_ - block >= 64) return;
+            live <<= skip_until_ - block;
+        }
+
+        // Strings are masked off with a prefix XOR over their quotes rather
+        // than skipped byte by byte. Verbatim strings, comments and bare
+        // words are skipped by hand, after which the strings are worked out
+        // again for the rest of the block.
+        uint64_t preceded = block > 0 && source_[block - 1] == '\\';
+        uint64_t escaped = masks.quote & (masks.backslash << 1 | preceded);
+        for (;;) {
+            uint64_t in_string = prefix_xor(masks.quote & ~escaped & live);
+            // An unterminated string stops at its newline, and a quote after
+            // a backslash still opens a string outside one: leave those
+            // blocks to the exact scan.
+            if ((masks.newline & in_string) || (escaped & live & ~in_string)) {
+                scan_exact(masks, live);
+                return;
+            }
+            uint64_t mask = masks.interesting & live & ~in_string;
+            size_t resume = visit(&mask);
+            if (!resume) {
+                // A backslash at the end of the block escapes a quote after it.
+                // The last block is padded, so a string still open there runs
+                // to the end of the source.
+                size_t end = block + 64;
+                if (!(in_string >> 63)) return;
+                if (end > source_.size()) {
+                    skip_until_ = source_.size();
+                } else {
+                    skip_until_ = skip_string(source_, source_[end - 1] == '\\' ? end - 1 : end);
+                }
+                return;
+            }
+            skip_until_ = resume;
+            if (resume - block >= 64) return;
+            live = ~uint64_t(0) << (resume - block);
+        }
+    }
+
+    bool balanced() const { return balanced_; }
+    const std::vector<size_t> &open() const { return open_; }
+
+private:
+    uint32_t row(unsigned bit) const {
+        return row_base_ + popcount(newline_ & ((uint64_t(1) << bit) - 1));
+    }
+
+    // Offset of the newline ending the line of |bit|, or the source size.
+    size_t line_end(unsigned bit) const {
+        uint64_t after = newline_ & (~uint64_t(0) << bit);
+        return after ? block_ + lowest_bit(after) : find_byte(source_, block_ + 64, '\n');
+    }
+
+    // Visits the bits of |*mask| in order, clearing them, until one starts a
+    // string, comment or bare word. Returns the offset just past that, or 0
+    // once the mask runs out.
+    size_t visit(uint64_t *mask) {
+        while (*mask) {
+            unsigned bit = lowest_bit(*mask);
+            *mask &= *mask - 1;
+            size_t i = block_ + bit;
+            switch (source_[i]) {
+                case '"':
+                    return skip_string(source_, i + 1);
+                case '@':
+                    if (i + 1 >= source_.size() || source_[i + 1] != '"') continue;
+                    return std::min(find_byte(source_, i + 2, '"') + 1, source_.size());
+                case '/': {
+                    if (i + 1 >= source_.size()) continue;
+                    if (source_[i + 1] == '/') return line_end(bit);
+                    if (source_[i + 1] != '*') continue;
+                    size_t resume = skip_block_comment(source_, i + 2);
+                    StructureSpan comment{};
+                    comment.start_byte = static_cast<uint32_t>(i);
+                    comment.end_byte = static_cast<uint32_t>(resume);
+                    comment.start_row = row(bit);
+                    comment.key_start = comment.key_end = comment.start_byte;
+                    comment.kind = StructureKind::Comment;
+                    comments_.push_back(comment);
+                    return resume;
+                }
+                case '=':
+                    structurals_.push_back(static_cast<uint32_t>(i));
+                    if (!starts_bare_word(source_, i + 1)) continue;
+                    return line_end(bit);
+                case '{':
+                case '[':
+                    open_block(i, bit);
+                    continue;
+                case '}':
+                case ']':
+                    close_block(i, bit);
+                    continue;
+                default:
+                    structurals_.push_back(static_cast<uint32_t>(i));
+                    continue;
+            }
+        }
+        return 0;
+    }
+
+    // Skips strings byte by byte, for the blocks whose quotes the prefix
+    // XOR would get wrong.
+    void scan_exact(const BlockMasks &masks, uint64_t live) {
+        uint64_t mask = (masks.interesting | masks.quote) & live;
+        while (size_t resume = visit(&mask)) {
+            skip_until_ = resume;
+            if (resume - block_ >= 64) return;
+            mask &= ~uint64_t(0) << (resume - block_);
+        }
+    }
+
+    void open_block(size_t i, unsigned bit) {
+        StructureSpan span{};
+        span.start_byte = static_cast<uint32_t>(i);
+        span.end_byte = static_cast<uint32_t>(source_.size());
+        span.start_row = row(bit);
+        span.depth = static_cast<uint32_t>(open_.size());
+        span.kind = source_[i] == '{' ? StructureKind::Group : StructureKind::List;
+        size_t key_start, key_end;
+        block_key(source_, i, structurals_.empty() ? i : structurals_.back(), &key_start, &key_end);
+        span.key_start = static_cast<uint32_t>(key_start);
+        span.key_end = static_cast<uint32_t>(key_end);
+        structurals_.push_back(static_cast<uint32_t>(i));
+        open_.push_back(blocks_.size());
+        blocks_.push_back(span);
+    }
+
+    void close_block(size_t i, unsigned bit) {
+        structurals_.push_back(static_cast<uint32_t>(i));
+        StructureKind kind = source_[i] == '}' ? StructureKind::Group : StructureKind::List;
+        if (open_.empty() || blocks_[open_.back()].kind != kind) {
+            balanced_ = false;
+            return;
+        }
+        StructureSpan &span = blocks_[open_.back()];
+        span.end_byte = static_cast<uint32_t>(i + 1);
+        span.end_row = row(bit);
+        open_.pop_back();
+    }
+
+    std::string_view source_;
+    std::vector<uint32_t> &structurals_;
+    std::vector<StructureSpan> &blocks_;
+    std::vector<StructureSpan> &comments_;
+    std::vector<size_t> open_;
+    bool balanced_ = true;
+    size_t skip_until_ = 0;
+    size_t block_ = 0;
+    uint64_t newline_ = 0;
+    uint32_t row_base_ = 0;
+};
+
+} // namespace
+
+size_t count_newlines(std::string_view text) {
+    size_t count = 0;
+    size_t offset = 0;
+    for (; offset + 64 <= text.size(); offset += 64) {
+        count += popcount(newline_mask(text.data() + offset));
+    }
+    for (; offset < text.size(); offset++) count += text[offset] == '\n';
+    return count;
+}
+
+StructureIndex StructureIndex::build(std::string_view source) {
+    StructureIndex index;
+    index.structurals_.reserve(source.size() / 32);
+    index.blocks_.reserve(source.size() / 128);
+    Scanner scanner(source, &index.structurals_, &index.blocks_, &index.comments_);
+
+    // Every block is classified once, in order, so rows fall out of the
+    // newline masks.
+    uint32_t row_base = 0;
+    for (size_t block = 0; block < source.size(); block += 64) {
+        BlockMasks masks = classify_at(source, block);
+        scanner.scan(block, masks, row_base);
+        row_base += popcount(masks.newline);
+    }
+
+    for (StructureSpan &comment : index.comments_) {
+        std::string_view text = source.substr(comment.start_byte, comment.end_byte - comment.start_byte);
+        comment.end_row = comment.start_row + static_cast<uint32_t>(count_newlines(text));
+    }
+    for (size_t unclosed : scanner.open()) index.blocks_[unclosed].end_row = row_base;
+    index.balanced_ = scanner.balanced() && scanner.open().empty();
+    return index;
+}
+
+std::vector<StructureSpan> StructureIndex::outline(uint32_t max_depth) const {
+    std::vector<StructureSpan> result;
+    for (const StructureSpan &block : blocks_) {
+        if (block.depth <= max_depth) result.push_back(block);
+    }
+    return result;
+}
+
+std::vector<StructureSpan> StructureIndex::folding_ranges() const {
+    std::vector<StructureSpan> result;
+    for (const StructureSpan &block : blocks_) {
+        if (block.end_row > block.start_row) result.push_back(block);
+    }
+    for (const StructureSpan &comment : comments_) {
+        if (comment.end_row > comment.start_row) result.push_back(comment);
+    }
+    std::stable_sort(result.begin(), result.end(), [](const StructureSpan &a, const StructureSpan &b) {
+        return a.start_row < b.start_row;
+    });
+    return result;
+}
+
+} // namespace objecttext
@@ -0,0 +1,180 @@
+#include "objecttext/to_json.h"
+
+#include <charconv>
+
+#include "objecttext/json.h"
+#include "objecttext/parser.h"
+#include "objecttext/value.h"
+
+namespace objecttext {
+
+namespace {
+
+class JsonWriter {
+public:
+    JsonWriter(TSNode root, std::string_view source, std::string *out, const JsonOptions &options)
+        : symbols_(Symbols::get()), source_(source), out_(out), indent_(options.indent),
+          cursor_(ts_tree_cursor_new(root)) {}
+    ~JsonWriter() { ts_tree_cursor_delete(&cursor_); }
+
+    void document() {
+        TSNode root = ts_tree_cursor_current_node(&cursor_);
+        TSSymbol symbol = ts_node_symbol(root);
+        if (symbol == symbols_.source_file) {
+            block(true);
+        } else if (is_entry(symbols_, symbol)) {
+            open('{');
+            newline();
+            key(entry_key(root, source_));
+            entry();
+            close('}', false);
+        } else {
+            out_->append("null");
+        }
+    }
+
+private:
+    const Symbols &symbols_;
+    std::string_view source_;
+    std::string *out_;
+    unsigned indent_;
+    unsigned depth_ = 0;
+    TSTreeCursor cursor_;
+
+    void newline() {
+        if (!indent_) return;
+        out_->push_back('\n');
+        out_->append(size_t(depth_) * indent_, ' ');
+    }
+
+    void open(char bracket) {
+        out_->push_back(bracket);
+        depth_++;
+    }
+
+    void close(char bracket, bool empty) {
+        depth_--;
+        if (!empty) newline();
+        out_->push_back(bracket);
+    }
+
+    void item(bool *first) {
+        if (!*first) out_->push_back(',');
+        *first = false;
+        newline();
+    }
+
+    void key(std::string_view name) {
+        append_json_string(out_, name);
+        out_->append(indent_ ? ": " : ":");
+    }
+
+    // The cursor is on an `assignment`, `group` or `list`.
+    void entry() {
+        TSNode node = ts_tree_cursor_current_node(&cursor_);
+        TSSymbol symbol = ts_node_symbol(node);
+        if (symbol == symbols_.assignment) {
+            scalar(entry_value(node));
+        } else {
+            block(symbol == symbols_.group);
+        }
+    }
+
+    // The cursor is on a `group`, `list` or `source_file`; its entries are
+    // written as the members of an object or the items of an array.
+    void block(bool object) {
+        open(object ? '{' : '[');
+        bool first = true;
+        if (ts_tree_cursor_goto_first_child(&cursor_)) {
+            bool in_extends = false;
+            uint32_t index = 0;
+            do {
+                TSNode child = ts_tree_cursor_current_node(&cursor_);
+                TSSymbol symbol = ts_node_symbol(child);
+                if (symbol == symbols_.extension) {
+                    if (!object) continue;
+                    if (in_extends) {
+                        out_->push_back(',');
+                    } else {
+                        item(&first);
+                        key("$extends");
+                        out_->push_back('[');
+                        in_extends = true;
+                    }
+                    TSNode reference = ts_node_named_child(child, 0);
+                    append_json_string(out_, node_text(ts_node_is_null(reference) ? child : reference,
+                                                       source_));
+                    continue;
+                }
+                if (in_extends) {
+                    out_->push_back(']');
+                    in_extends = false;
+                }
+                if (!is_entry(symbols_, symbol)) continue;
+
+                std::string_view name = entry_key(child, source_);
+                item(&first);
+                if (object) {
+                    if (name.empty()) {
+                        char digits[16];
+                        char *end = std::to_chars(digits, digits + sizeof(digits), index).ptr;
+                        key(std::string_view(digits, end - digits));
+                    } else {
+                        key(name);
+                    }
+                    entry();
+                } else if (!name.empty()) {
+                    open('{');
+                    newline();
+                    key(name);
+                    entry();
+                    close('}', false);
+                } else {
+                    entry();
+                }
+                index++;
+            } while (ts_tree_cursor_goto_next_sibling(&cursor_));
+            if (in_extends) out_->push_back(']');
+            ts_tree_cursor_goto_parent(&cursor_);
+        }
+        close(object ? '}' : ']', first);
+    }
+
+    void scalar(TSNode value) {
+        if (ts_node_is_null(value)) {
+            out_->append("null");
+            return;
+        }
+        TSNode literal = ts_node_named_child(value, 0);
+        if (ts_node_is_null(literal)) literal = value;
+        TSSymbol symbol = ts_node_symbol(literal);
+        std::string_view text = node_text(literal, source_);
+
+        double number;
+        if (symbol == symbols_.number && parse_number(text, &number)) {
+            append_json_number(out_, number);
+            return;
+        }
+        text = unquote(text);
+        if (symbol != symbols_.string || text.find("\\\"") == std::string_view::npos) {
+            append_json_string(out_, text);
+            return;
+        }
+        std::string unescaped;
+        unescaped.reserve(text.size());
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] == '\\' && i + 1 < text.size() && text[i + 1] == '"') i++;
+            unescaped.push_back(text[i]);
+        }
+        append_json_string(out_, unescaped);
+    }
+};
+
+} // namespace
+
+void write_json(TSNode root, std::string_view source, std::string *out,
+                const JsonOptions &options) {
+    JsonWriter(root, source, out, options).document();
+}
+
+} // namespace objecttext
@@ -0,0 +1,176 @@
+#include "objecttext/trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace objecttext {
+
+namespace detail {
+std::atomic<bool> trace_enabled{false};
+} // namespace detail
+
+namespace {
+
+struct Event {
+    const char *name;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    std::string detail;
+};
+
+// Events are buffered per thread and only merged when the file is written,
+// so recording never contends with other threads.
+struct ThreadEvents {
+    uint32_t tid;
+    std::mutex mutex;
+    std::vector<Event> events;
+};
+
+struct Tracer {
+    std::mutex mutex;
+    std::string path;
+    uint64_t epoch_ns = 0;
+    std::vector<std::unique_ptr<ThreadEvents>> threads;
+    std::vector<ThreadEvents *> free_threads; // left by exited threads
+};
+
+// Never destroyed, so that threads outliving main() can still record.
+Tracer &tracer() {
+    static Tracer *instance = new Tracer;
+    return *instance;
+}
+
+// Returns the buffer of a thread to the tracer when the thread exits, so
+// that the workers parallel_for starts on every call reuse the buffers (and
+// tids) of earlier ones. Events still buffered are written as usual.
+struct EventsOwner {
+    ThreadEvents *events = nullptr;
+    ~EventsOwner() {
+        if (!events) return;
+        Tracer &state = tracer();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.free_threads.push_back(events);
+    }
+};
+
+ThreadEvents &thread_events() {
+    thread_local EventsOwner owner;
+    if (!owner.events) {
+        Tracer &state = tracer();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.free_threads.empty()) {
+            owner.events = state.free_threads.back();
+            state.free_threads.pop_back();
+        } else {
+            state.threads.push_back(std::make_unique<ThreadEvents>());
+            owner.events = state.threads.back().get();
+            owner.events->tid = static_cast<uint32_t>(state.threads.size());
+        }
+    }
+    return *owner.events;
+}
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+void write_json_string(FILE *file, std::string_view text) {
+    fputc('"', file);
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            fputc('\\', file);
+            fputc(c, file);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            fprintf(file, "\\u%04x", c);
+        } else {
+            fputc(c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+} // namespace
+
+bool start_tracing(const std::string &path) {
+    Tracer &state = tracer();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (tracing()) return false;
+    state.path = path;
+    state.epoch_ns = now_ns();
+    for (auto &thread : state.threads) {
+        std::lock_guard<std::mutex> events_lock(thread->mutex);
+        thread->events.clear();
+    }
+    detail::trace_enabled.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+bool start_tracing_from_environment() {
+    const char *path = getenv("OBJECTTEXT_TRACE");
+    return path && *path && start_tracing(path);
+}
+
+bool stop_tracing() {
+    Tracer &state = tracer();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!tracing()) return false;
+    detail::trace_enabled.store(false, std::memory_order_relaxed);
+
+    FILE *file = fopen(state.path.c_str(), "w");
+    if (!file) return false;
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (auto &thread : state.threads) {
+        std::vector<Event> events;
+        {
+            std::lock_guard<std::mutex> events_lock(thread->mutex);
+            events.swap(thread->events);
+        }
+        if (events.empty()) continue;
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                      "\"args\":{\"name\":\"thread %u\"}}",
+                first ? "" : ",\n", thread->tid, thread->tid);
+        first = false;
+        for (const Event &event : events) {
+            // Left over from an earlier session.
+            if (event.start_ns < state.epoch_ns) continue;
+            fprintf(file, ",\n{\"name\":");
+            write_json_string(file, event.name);
+            fprintf(file, ",\"cat\":\"objecttext\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                          "\"ts\":%.3f,\"dur\":%.3f",
+                    thread->tid, (event.start_ns - state.epoch_ns) / 1e3, event.duration_ns / 1e3);
+            if (!event.detail.empty()) {
+                fprintf(file, ",\"args\":{\"detail\":");
+                write_json_string(file, event.detail);
+                fputc('}', file);
+            }
+            fputc('}', file);
+        }
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
+
+void TraceScope::begin(std::string_view detail) {
+    active_ = true;
+    detail_ = detail;
+    start_ns_ = now_ns();
+}
+
+void TraceScope::end() {
+    uint64_t end_ns = now_ns();
+    // Scopes still open when tracing stopped are dropped.
+    if (!tracing()) return;
+    ThreadEvents &events = thread_events();
+    std::lock_guard<std::mutex> lock(events.mutex);
+    events.events.push_back({name_, start_ns_, end_ns - start_ns_, std::move(detail_)});
+}
+
+} // namespace objecttext
@@ -0,0 +1,73 @@
+#include "objecttext/value.h"
+
+#include <clocale>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+namespace objecttext {
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool parse_number(std::string_view text, double *value, unsigned *suffix) {
+    unsigned flags = kSuffixNone;
+    if (!text.empty() && text.back() == 'd') {
+        flags |= kSuffixDegrees;
+        text.remove_suffix(1);
+    }
+    if (!text.empty() && text.back() == '%') {
+        flags |= kSuffixPercent;
+        text.remove_suffix(1);
+    }
+    if (text.empty()) return false;
+    char first = text[0] == '-' && text.size() > 1 ? text[1] : text[0];
+    if (first != '.' && (first < '0' || first > '9')) return false;
+
+    // strtod() rather than std::from_chars(), which Apple libc++ lacks for
+    // double. It wants a terminated string and reads the decimal point of
+    // the current locale, so the text is copied with '.' swapped for it.
+    // Only digits, signs, points and exponents pass, which rules out the
+    // hex, "inf" and "nan" forms strtod() also takes.
+    char point = *localeconv()->decimal_point;
+    char small[64];
+    std::string large;
+    char *buffer = small;
+    if (text.size() >= sizeof(small)) {
+        large.resize(text.size());
+        buffer = &large[0];
+    }
+    for (size_t i = 0; i < text.size(); i++) {
+        char c = text[i];
+        if (c == '.') {
+            c = point;
+        } else if ((c < '0' || c > '9') && c != '-' && c != '+' && c != 'e' && c != 'E') {
+            return false;
+        }
+        buffer[i] = c;
+    }
+    buffer[text.size()] = '\0';
+    char *end = nullptr;
+    double result = strtod(buffer, &end);
+    if (end != buffer + text.size() || !std::isfinite(result)) return false;
+
+    if (flags & kSuffixPercent) result /= 100;
+    *value = result;
+    if (suffix) *suffix = flags;
+    return true;
+}
+
+std::string_view unquote(std::string_view text) {
+    while (!text.empty() && is_space(text.front())) text.remove_prefix(1);
+    while (!text.empty() && is_space(text.back())) text.remove_suffix(1);
+    if (text.size() >= 3 && text[0] == '@' && text[1] == '"' && text.back() == '"') {
+        return text.substr(2, text.size() - 3);
+    }
+    if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+        return text.substr(1, text.size() - 2);
+    }
+    return text;
+}
+
+} // namespace objecttext
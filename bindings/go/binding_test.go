@@ -13,3 +13,50 @@ func TestCanLoadGrammar(t *testing.T) {
 		t.Errorf("Error loading Object Text grammar")
 	}
 }
+
+func TestParseFlat(t *testing.T) {
+	parser := tree_sitter_objecttext.NewFlatParser()
+	defer parser.Close()
+	source := []byte("Ship\n{\n    Cost = 150\n    Mass = 150\n}\n")
+
+	tree, err := parser.ParseFlat(source, false)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if tree.HasError() {
+		t.Errorf("unexpected error nodes")
+	}
+	root := tree.Nodes[0]
+	if tree_sitter_objecttext.SymbolName(root.Symbol) != "source_file" ||
+		root.Parent != tree_sitter_objecttext.FlatNone || int(root.End) != len(tree.Nodes) {
+		t.Errorf("unexpected root %+v", root)
+	}
+	keys := 0
+	for i := range tree.Nodes {
+		node := &tree.Nodes[i]
+		if tree_sitter_objecttext.SymbolName(node.Symbol) == "number" &&
+			tree.Strings[node.Text] != string(tree.Text(node)) {
+			t.Errorf("text of node %d is %q", i, tree.Strings[node.Text])
+		}
+		if tree_sitter_objecttext.SymbolName(node.Symbol) == "identifier" {
+			keys++
+		}
+	}
+	// Ship, Cost and Mass, with the two 150s sharing a string.
+	if keys != 3 || len(tree.Strings) != 4 {
+		t.Errorf("found %d keys and strings %q", keys, tree.Strings)
+	}
+
+	named, err := parser.ParseFlat(source, true)
+	if err != nil {
+		t.Fatal(err)
+	}
+	for _, node := range named.Nodes {
+		if node.Flags&tree_sitter_objecttext.FlatNamed == 0 {
+			t.Errorf("anonymous node %q in a named-only tree", named.Text(&node))
+		}
+	}
+	if len(named.Nodes) >= len(tree.Nodes) {
+		t.Errorf("named-only tree has %d of %d nodes", len(named.Nodes), len(tree.Nodes))
+	}
+}
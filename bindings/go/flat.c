@@ -0,0 +1,211 @@
+#include "flat.h"
+#include "ts_api.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+const TSLanguage *tree_sitter_objecttext(void);
+
+// A growable array of |size|-byte elements.
+typedef struct {
+    void *data;
+    uint32_t count;
+    uint32_t capacity;
+} Buffer;
+
+static bool buffer_reserve(Buffer *buffer, size_t size, uint32_t capacity) {
+    if (capacity <= buffer->capacity) return true;
+    uint32_t grown = buffer->capacity ? buffer->capacity * 2 : 64;
+    if (grown < capacity) grown = capacity;
+    void *data = realloc(buffer->data, (size_t)grown * size);
+    if (!data) return false;
+    buffer->data = data;
+    buffer->capacity = grown;
+    return true;
+}
+
+// Maps text to string ids with open addressing over |source| ranges.
+typedef struct {
+    const char *source;
+    Buffer strings; // ObjecttextFlatString
+    uint32_t *slots; // string id + 1, or 0 for an empty slot
+    uint32_t slot_count;
+} Strings;
+
+static uint32_t hash_text(const char *text, uint32_t length) {
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < length; i++) hash = (hash ^ (uint8_t)text[i]) * 16777619u;
+    return hash;
+}
+
+static bool strings_grow(Strings *self) {
+    uint32_t slot_count = self->slot_count ? self->slot_count * 2 : 256;
+    uint32_t *slots = calloc(slot_count, sizeof(uint32_t));
+    if (!slots) return false;
+    const ObjecttextFlatString *strings = self->strings.data;
+    for (uint32_t id = 0; id < self->strings.count; id++) {
+        uint32_t slot = hash_text(self->source + strings[id].start_byte, strings[id].length);
+        while (slots[slot & (slot_count - 1)]) slot++;
+        slots[slot & (slot_count - 1)] = id + 1;
+    }
+    free(self->slots);
+    self->slots = slots;
+    self->slot_count = slot_count;
+    return true;
+}
+
+static uint32_t strings_intern(Strings *self, uint32_t start, uint32_t length) {
+    if ((self->strings.count + 1) * 2 > self->slot_count && !strings_grow(self)) {
+        return OBJECTTEXT_FLAT_NONE;
+    }
+    const char *text = self->source + start;
+    ObjecttextFlatString *strings = self->strings.data;
+    uint32_t mask = self->slot_count - 1;
+    for (uint32_t slot = hash_text(text, length);; slot++) {
+        uint32_t id = self->slots[slot & mask];
+        if (!id) break;
+        const ObjecttextFlatString *string = &strings[id - 1];
+        if (string->length == length && memcmp(self->source + string->start_byte, text, length) == 0) {
+            return id - 1;
+        }
+    }
+    if (!buffer_reserve(&self->strings, sizeof(ObjecttextFlatString), self->strings.count + 1)) {
+        return OBJECTTEXT_FLAT_NONE;
+    }
+    uint32_t id = self->strings.count++;
+    ((ObjecttextFlatString *)self->strings.data)[id] = (ObjecttextFlatString){start, length};
+    uint32_t slot = hash_text(text, length);
+    while (self->slots[slot & mask]) slot++;
+    self->slots[slot & mask] = id + 1;
+    return id;
+}
+
+// One level per cursor depth: the node added for it, if any, and the
+// nearest added node at or above it, which becomes the parent of its
+// children.
+typedef struct {
+    uint32_t self;
+    uint32_t owner;
+} Level;
+
+typedef struct {
+    uint32_t length;
+    bool named_only;
+    bool failed;
+    Buffer nodes;  // ObjecttextFlatNode
+    Buffer levels; // Level
+    Strings strings;
+} Flattener;
+
+static void enter(Flattener *self, TSNode node) {
+    uint32_t depth = self->levels.count;
+    if (!buffer_reserve(&self->levels, sizeof(Level), depth + 1)) {
+        self->failed = true;
+        return;
+    }
+    Level *levels = self->levels.data;
+    uint32_t parent = depth ? levels[depth - 1].owner : OBJECTTEXT_FLAT_NONE;
+    bool named = ts_node_is_named(node);
+    uint32_t index = OBJECTTEXT_FLAT_NONE;
+    if (named || !self->named_only) {
+        index = self->nodes.count;
+        if (!buffer_reserve(&self->nodes, sizeof(ObjecttextFlatNode), index + 1)) {
+            self->failed = true;
+            return;
+        }
+        uint32_t start = ts_node_start_byte(node);
+        uint32_t end = ts_node_end_byte(node);
+        uint16_t flags = 0;
+        if (named) flags |= OBJECTTEXT_FLAT_NAMED;
+        if (ts_node_is_error(node)) flags |= OBJECTTEXT_FLAT_ERROR;
+        if (ts_node_is_missing(node)) flags |= OBJECTTEXT_FLAT_MISSING;
+        if (ts_node_is_extra(node)) flags |= OBJECTTEXT_FLAT_EXTRA;
+        if (ts_node_has_error(node)) flags |= OBJECTTEXT_FLAT_HAS_ERROR;
+        uint32_t text = OBJECTTEXT_FLAT_NONE;
+        if (named && start < end && end <= self->length && ts_node_named_child_count(node) == 0) {
+            text = strings_intern(&self->strings, start, end - start);
+            if (text == OBJECTTEXT_FLAT_NONE) self->failed = true;
+        }
+        ((ObjecttextFlatNode *)self->nodes.data)[index] = (ObjecttextFlatNode){
+            ts_node_symbol(node), flags, parent, index + 1, start, end, text,
+        };
+        self->nodes.count++;
+    }
+    levels[depth] = (Level){index, index != OBJECTTEXT_FLAT_NONE ? index : parent};
+    self->levels.count++;
+}
+
+static void leave(Flattener *self) {
+    Level *level = &((Level *)self->levels.data)[--self->levels.count];
+    if (level->self != OBJECTTEXT_FLAT_NONE) {
+        ((ObjecttextFlatNode *)self->nodes.data)[level->self].end = self->nodes.count;
+    }
+}
+
+void *objecttext_flat_parser_new(void) {
+    TSParser *parser = ts_parser_new();
+    if (parser) ts_parser_set_language(parser, tree_sitter_objecttext());
+    return parser;
+}
+
+void objecttext_flat_parser_delete(void *parser) {
+    ts_parser_delete(parser);
+}
+
+bool objecttext_flat_parse(void *parser, const char *source, uint32_t length, bool named_only,
+                           ObjecttextFlatTree *result) {
+    memset(result, 0, sizeof(*result));
+    TSTree *tree = ts_parser_parse_string(parser, NULL, source, length);
+    if (!tree) return false;
+
+    Flattener flattener = {length, named_only, false, {0}, {0}, {source, {0}, NULL, 0}};
+    TSTreeCursor cursor = ts_tree_cursor_new(ts_tree_root_node(tree));
+    enter(&flattener, ts_tree_cursor_current_node(&cursor));
+    while (!flattener.failed) {
+        if (ts_tree_cursor_goto_first_child(&cursor)) {
+            enter(&flattener, ts_tree_cursor_current_node(&cursor));
+            continue;
+        }
+        bool done = false;
+        for (;;) {
+            leave(&flattener);
+            if (ts_tree_cursor_goto_next_sibling(&cursor)) {
+                enter(&flattener, ts_tree_cursor_current_node(&cursor));
+                break;
+            }
+            if (!ts_tree_cursor_goto_parent(&cursor)) {
+                done = true;
+                break;
+            }
+        }
+        if (done) break;
+    }
+    ts_tree_cursor_delete(&cursor);
+    ts_tree_delete(tree);
+    free(flattener.levels.data);
+    free(flattener.strings.slots);
+
+    result->nodes = flattener.nodes.data;
+    result->node_count = flattener.nodes.count;
+    result->strings = flattener.strings.strings.data;
+    result->string_count = flattener.strings.strings.count;
+    if (flattener.failed) {
+        objecttext_flat_tree_free(result);
+        return false;
+    }
+    return true;
+}
+
+void objecttext_flat_tree_free(ObjecttextFlatTree *tree) {
+    free(tree->nodes);
+    free(tree->strings);
+    memset(tree, 0, sizeof(*tree));
+}
+
+uint32_t objecttext_flat_symbol_count(void) {
+    return ts_language_symbol_count(tree_sitter_objecttext());
+}
+
+const char *objecttext_flat_symbol_name(uint16_t symbol) {
+    return ts_language_symbol_name(tree_sitter_objecttext(), symbol);
+}
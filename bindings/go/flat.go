@@ -0,0 +1,155 @@
+package tree_sitter_objecttext
+
+// #include <stdlib.h>
+// #include "flat.h"
+// #include "ts_api.h"
+import "C"
+
+import (
+	"errors"
+	"math"
+	"sync"
+	"unsafe"
+
+	// Compiles the tree-sitter runtime that flat.c calls into.
+	tree_sitter "github.com/tree-sitter/go-tree-sitter"
+)
+
+// FlatNone marks the missing parent of the root and nodes without text.
+const FlatNone = math.MaxUint32
+
+// FlatNodeFlags describes a FlatNode.
+type FlatNodeFlags uint16
+
+const (
+	FlatNamed    FlatNodeFlags = 1 << 0
+	FlatError    FlatNodeFlags = 1 << 1 // an ERROR node
+	FlatMissing  FlatNodeFlags = 1 << 2 // inserted by the parser to recover
+	FlatExtra    FlatNodeFlags = 1 << 3 // a comment
+	FlatHasError FlatNodeFlags = 1 << 4 // the node or a descendant is an error
+)
+
+// FlatNode is one node of a FlatTree. Its layout matches
+// ObjecttextFlatNode in flat.h.
+type FlatNode struct {
+	Symbol    uint16
+	Flags     FlatNodeFlags
+	Parent    uint32 // FlatNone for the root
+	End       uint32 // one past the last descendant
+	StartByte uint32
+	EndByte   uint32
+	Text      uint32 // an index into FlatTree.Strings, or FlatNone
+}
+
+var (
+	_ [unsafe.Sizeof(FlatNode{}) - C.sizeof_ObjecttextFlatNode]struct{}
+	_ [C.sizeof_ObjecttextFlatNode - unsafe.Sizeof(FlatNode{})]struct{}
+)
+
+// The structs ts_api.h declares must match the runtime go-tree-sitter
+// compiles; these fail to build when an upgrade changes either of them.
+var (
+	_ [unsafe.Sizeof(tree_sitter.Node{}) - C.sizeof_TSNode]struct{}
+	_ [C.sizeof_TSNode - unsafe.Sizeof(tree_sitter.Node{})]struct{}
+	_ [unsafe.Sizeof(tree_sitter.TreeCursor{}) - C.sizeof_TSTreeCursor]struct{}
+	_ [C.sizeof_TSTreeCursor - unsafe.Sizeof(tree_sitter.TreeCursor{})]struct{}
+)
+
+// FlatTree is a parsed file as one slice of nodes and a table of strings,
+// built in C by a single cgo call instead of one call per node access.
+//
+// Nodes are in preorder, so the descendants of node i are the nodes from
+// i+1 up to End: its first child is i+1 when End > i+1, and the sibling
+// after a child c is c.End while that is below End. Named nodes without
+// named children (keys, numbers, strings, bare words, comments) carry
+// their text as an index into Strings, so the thousand Cost keys of a file
+// share one string.
+type FlatTree struct {
+	Nodes   []FlatNode
+	Strings []string
+	Source  []byte
+}
+
+// Text returns the source of a node.
+func (t *FlatTree) Text(node *FlatNode) []byte {
+	return t.Source[node.StartByte:node.EndByte]
+}
+
+// HasError reports whether the tree has ERROR or MISSING nodes.
+func (t *FlatTree) HasError() bool {
+	return len(t.Nodes) > 0 && t.Nodes[0].Flags&FlatHasError != 0
+}
+
+// ErrParse is returned when the parser gives no tree or memory runs out.
+var ErrParse = errors.New("tree_sitter_objecttext: parse failed")
+
+// FlatParser parses sources into FlatTrees. A FlatParser is not safe for
+// concurrent use; give each goroutine its own.
+type FlatParser struct {
+	parser unsafe.Pointer
+}
+
+// NewFlatParser returns a parser that must be released with Close.
+func NewFlatParser() *FlatParser {
+	return &FlatParser{parser: C.objecttext_flat_parser_new()}
+}
+
+// Close releases the parser.
+func (p *FlatParser) Close() {
+	if p.parser != nil {
+		C.objecttext_flat_parser_delete(p.parser)
+		p.parser = nil
+	}
+}
+
+// ParseFlat parses source and returns its tree flattened. With namedOnly,
+// anonymous nodes such as '{' and '=' are left out and their children are
+// attached to the nearest named ancestor. The tree keeps source.
+func (p *FlatParser) ParseFlat(source []byte, namedOnly bool) (*FlatTree, error) {
+	if p.parser == nil || uint64(len(source)) > math.MaxUint32 {
+		return nil, ErrParse
+	}
+	var text *C.char
+	if len(source) > 0 {
+		text = (*C.char)(unsafe.Pointer(&source[0]))
+	}
+	var flat C.ObjecttextFlatTree
+	if !C.objecttext_flat_parse(p.parser, text, C.uint32_t(len(source)), C.bool(namedOnly), &flat) {
+		return nil, ErrParse
+	}
+	defer C.objecttext_flat_tree_free(&flat)
+
+	tree := &FlatTree{
+		Nodes:   make([]FlatNode, flat.node_count),
+		Strings: make([]string, flat.string_count),
+		Source:  source,
+	}
+	if flat.node_count > 0 {
+		copy(tree.Nodes, unsafe.Slice((*FlatNode)(unsafe.Pointer(flat.nodes)), flat.node_count))
+	}
+	if flat.string_count > 0 {
+		strings := unsafe.Slice(flat.strings, flat.string_count)
+		for i, s := range strings {
+			tree.Strings[i] = string(source[s.start_byte : s.start_byte+s.length])
+		}
+	}
+	return tree, nil
+}
+
+var symbolNames = sync.OnceValue(func() []string {
+	count := int(C.objecttext_flat_symbol_count())
+	names := make([]string, count)
+	for i := range names {
+		names[i] = C.GoString(C.objecttext_flat_symbol_name(C.uint16_t(i)))
+	}
+	return names
+})
+
+// SymbolName returns the node type of a FlatNode symbol, e.g. "assignment".
+func SymbolName(symbol uint16) string {
+	names := symbolNames()
+	if int(symbol) >= len(names) {
+		return ""
+	}
+	return names[symbol]
+}
@@ -0,0 +1,57 @@
+#ifndef TREE_SITTER_OBJECTTEXT_GO_FLAT_H_
+#define TREE_SITTER_OBJECTTEXT_GO_FLAT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// A node of a flattened tree. The Go FlatNode type has the same layout, so
+// the nodes are copied out with one memmove.
+typedef struct {
+    uint16_t symbol;
+    uint16_t flags;
+    uint32_t parent;     // OBJECTTEXT_FLAT_NONE for the root
+    uint32_t end;        // one past the last descendant, in preorder
+    uint32_t start_byte;
+    uint32_t end_byte;
+    uint32_t text;       // a string id or OBJECTTEXT_FLAT_NONE
+} ObjecttextFlatNode;
+
+// An interned string: the first occurrence of the text in the source.
+typedef struct {
+    uint32_t start_byte;
+    uint32_t length;
+} ObjecttextFlatString;
+
+typedef struct {
+    ObjecttextFlatNode *nodes;
+    uint32_t node_count;
+    ObjecttextFlatString *strings;
+    uint32_t string_count;
+} ObjecttextFlatTree;
+
+#define OBJECTTEXT_FLAT_NONE UINT32_MAX
+
+enum {
+    OBJECTTEXT_FLAT_NAMED = 1 << 0,
+    OBJECTTEXT_FLAT_ERROR = 1 << 1,
+    OBJECTTEXT_FLAT_MISSING = 1 << 2,
+    OBJECTTEXT_FLAT_EXTRA = 1 << 3,
+    OBJECTTEXT_FLAT_HAS_ERROR = 1 << 4,
+};
+
+void *objecttext_flat_parser_new(void);
+void objecttext_flat_parser_delete(void *parser);
+
+// Parses |source| and flattens the tree into |result|, in the layout of the
+// C++ FlatTree: nodes in preorder, with the text of named nodes that have
+// no named children interned. With |named_only|, anonymous nodes are left
+// out. Returns false if the parse failed or memory ran out; otherwise the
+// caller frees |result| with objecttext_flat_tree_free().
+bool objecttext_flat_parse(void *parser, const char *source, uint32_t length, bool named_only,
+                           ObjecttextFlatTree *result);
+void objecttext_flat_tree_free(ObjecttextFlatTree *tree);
+
+uint32_t objecttext_flat_symbol_count(void);
+const char *objecttext_flat_symbol_name(uint16_t symbol);
+
+#endif // TREE_SITTER_OBJECTTEXT_GO_FLAT_H_
@@ -0,0 +1,57 @@
+#ifndef TREE_SITTER_OBJECTTEXT_GO_TS_API_H_
+#define TREE_SITTER_OBJECTTEXT_GO_TS_API_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// The tree-sitter runtime is compiled by go-tree-sitter, which flat.go
+// imports, and resolved when the program is linked. Its headers are not
+// reachable from this module, so the part of tree_sitter/api.h that flat.c
+// uses is declared here, as of the runtime go.mod pins (0.24). TSTreeCursor
+// has changed before (its context had two elements until 0.22), so flat.go
+// checks both structs against go-tree-sitter's Node and TreeCursor, which
+// wrap the real ones.
+
+typedef uint16_t TSSymbol;
+typedef struct TSLanguage TSLanguage;
+typedef struct TSParser TSParser;
+typedef struct TSTree TSTree;
+
+typedef struct {
+    uint32_t context[4];
+    const void *id;
+    const TSTree *tree;
+} TSNode;
+
+typedef struct {
+    const void *tree;
+    const void *id;
+    uint32_t context[3];
+} TSTreeCursor;
+
+TSParser *ts_parser_new(void);
+void ts_parser_delete(TSParser *self);
+bool ts_parser_set_language(TSParser *self, const TSLanguage *language);
+TSTree *ts_parser_parse_string(TSParser *self, const TSTree *old_tree, const char *string,
+                               uint32_t length);
+void ts_tree_delete(TSTree *self);
+TSNode ts_tree_root_node(const TSTree *self);
+TSTreeCursor ts_tree_cursor_new(TSNode node);
+void ts_tree_cursor_delete(TSTreeCursor *self);
+bool ts_tree_cursor_goto_first_child(TSTreeCursor *self);
+bool ts_tree_cursor_goto_next_sibling(TSTreeCursor *self);
+bool ts_tree_cursor_goto_parent(TSTreeCursor *self);
+TSNode ts_tree_cursor_current_node(const TSTreeCursor *self);
+TSSymbol ts_node_symbol(TSNode self);
+bool ts_node_is_named(TSNode self);
+bool ts_node_is_error(TSNode self);
+bool ts_node_is_missing(TSNode self);
+bool ts_node_is_extra(TSNode self);
+bool ts_node_has_error(TSNode self);
+uint32_t ts_node_start_byte(TSNode self);
+uint32_t ts_node_end_byte(TSNode self);
+uint32_t ts_node_named_child_count(TSNode self);
+uint32_t ts_language_symbol_count(const TSLanguage *self);
+const char *ts_language_symbol_name(const TSLanguage *self, TSSymbol symbol);
+
+#endif // TREE_SITTER_OBJECTTEXT_GO_TS_API_H_
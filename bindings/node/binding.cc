@@ -4,6 +4,12 @@ typedef struct TSLanguage TSLanguage;
 
 extern "C" TSLanguage *tree_sitter_objecttext();
 
+#ifdef OBJECTTEXT_WITH_RUNTIME
+void InitFlatTree(Napi::Env env, Napi::Object exports);
+void InitParseFiles(Napi::Env env, Napi::Object exports);
+void InitToJSON(Napi::Env env, Napi::Object exports);
+#endif
+
 // "tree-sitter", "language" hashed with BLAKE2
 const napi_type_tag LANGUAGE_TYPE_TAG = {
     0x8AF2E5212AD58ABF, 0xD5006CAD83ABBA16
@@ -13,6 +19,11 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
     auto language = Napi::External<TSLanguage>::New(env, tree_sitter_objecttext());
     language.TypeTag(&LANGUAGE_TYPE_TAG);
     exports["language"] = language;
+#ifdef OBJECTTEXT_WITH_RUNTIME
+    InitFlatTree(env, exports);
+    InitParseFiles(env, exports);
+    InitToJSON(env, exports);
+#endif
     return exports;
 }
 
@@ -1,4 +1,7 @@
 const assert = require("node:assert");
+const fs = require("node:fs");
+const os = require("node:os");
+const path = require("node:path");
 const { test } = require("node:test");
 
 const Parser = require("tree-sitter");
@@ -7,3 +10,82 @@ test("can load grammar", () => {
   const parser = new Parser();
   assert.doesNotThrow(() => parser.setLanguage(require(".")));
 });
+
+test("parseFiles summarizes files on the thread pool", async (t) => {
+  const { parseFiles } = require(".");
+  if (typeof parseFiles !== "function") {
+    t.skip("built without the tree-sitter runtime");
+    return;
+  }
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), "objecttext-"));
+  t.after(() => fs.rmSync(dir, { recursive: true, force: true }));
+  const good = path.join(dir, "good.rules");
+  const broken = path.join(dir, "broken.rules");
+  fs.writeFileSync(good, "Ship\n{\n    Parts\n    {\n        Cost = 150\n    }\n}\n");
+  fs.writeFileSync(broken, "Ship\n{\n    ..Cost = 1\n");
+
+  const results = await parseFiles([good, broken, path.join(dir, "missing")], {
+    query: "Ship/Parts/Cost",
+    concurrency: 2,
+  });
+  assert.strictEqual(results.length, 3);
+  assert.strictEqual(results[0].ok, true);
+  assert.strictEqual(results[0].root, "Ship");
+  assert.strictEqual(results[0].hasError, false);
+  assert.deepStrictEqual(results[0].matches.map((match) => match.value), ["150"]);
+  assert.strictEqual(results[1].hasError, true);
+  assert.strictEqual(results[2].ok, false);
+
+  assert.deepStrictEqual(await parseFiles([]), []);
+  assert.throws(() => parseFiles([good], { query: "Ship[" }), /invalid path query/);
+});
+
+test("parseFlat shares one buffer between its columns", (t) => {
+  const { parseFlat } = require(".");
+  if (typeof parseFlat !== "function") {
+    t.skip("built without the tree-sitter runtime");
+    return;
+  }
+  const source = "Ship\n{\n    Cost = 150\n    Tank\n    {\n        Cost = 40\n    }\n}\n";
+  const tree = parseFlat(source);
+  assert.strictEqual(tree.parent.buffer, tree.buffer);
+  assert.strictEqual(tree.symbol.buffer, tree.buffer);
+  assert.strictEqual(tree.parent[0], 0xffffffff);
+  assert.strictEqual(tree.end[0], tree.nodeCount);
+  assert.strictEqual(tree.symbolNames[tree.symbol[0]], "source_file");
+
+  const decoder = new TextDecoder();
+  const string = (id) =>
+    decoder.decode(tree.stringData.subarray(tree.stringOffsets[id], tree.stringOffsets[id + 1]));
+  const costs = [];
+  for (let i = 0; i < tree.nodeCount; i++) {
+    if (tree.text[i] !== 0xffffffff && string(tree.text[i]) === "Cost") costs.push(tree.text[i]);
+  }
+  assert.strictEqual(costs.length, 2);
+  assert.strictEqual(costs[0], costs[1]);
+
+  const named = parseFlat(Buffer.from(source), { named: true });
+  assert.ok(named.nodeCount < tree.nodeCount);
+  assert.ok(named.flags.every((flags) => flags & 1));
+
+  const broken = parseFlat("..Stray = 1\n");
+  const errors = [];
+  for (let i = 0; i < broken.nodeCount; i++) {
+    if (broken.flags[i] & 2) errors.push(broken.symbolNames[broken.symbol[i]]);
+  }
+  assert.ok(errors.length > 0);
+  assert.ok(errors.every((name) => name === "ERROR"));
+});
+
+test("toJSON converts a document natively", (t) => {
+  const { toJSON } = require(".");
+  if (typeof toJSON !== "function") {
+    t.skip("built without the tree-sitter runtime");
+    return;
+  }
+  const source = 'Ship\n{\n    Name = "A \\"big\\" ship"\n    Scale = 50%\n    Parts\n    [\n        {\n            Cost = 5\n        }\n    ]\n}\n';
+  const expected = { Ship: { Name: 'A "big" ship', Scale: 0.5, Parts: [{ Cost: 5 }] } };
+  assert.deepStrictEqual(JSON.parse(toJSON(source)), expected);
+  assert.deepStrictEqual(JSON.parse(toJSON(Buffer.from(source), { buffer: true })), expected);
+  assert.strictEqual(toJSON("A\n{\n    B = 1\n}\n", { indent: 2 }), '{\n  "A": {\n    "B": 1\n  }\n}');
+});
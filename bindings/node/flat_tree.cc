@@ -0,0 +1,127 @@
+#include <napi.h>
+
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include <tree_sitter/tree-sitter-objecttext.h>
+
+#include "objecttext/flat_tree.h"
+#include "objecttext/parser.h"
+
+using namespace objecttext;
+
+namespace {
+
+// Where the columns of a FlatTree are, kept after the tree itself has been
+// handed to an ArrayBuffer.
+struct Layout {
+    size_t offsets[static_cast<int>(FlatColumn::StringData) + 1];
+    size_t nodes;
+    size_t strings;
+    size_t string_bytes;
+
+    explicit Layout(const FlatTree &tree)
+        : nodes(tree.node_count()), strings(tree.string_count()),
+          string_bytes(tree.size() - tree.offset(FlatColumn::StringData)) {
+        for (int i = 0; i <= static_cast<int>(FlatColumn::StringData); i++) {
+            offsets[i] = tree.offset(static_cast<FlatColumn>(i));
+        }
+    }
+
+    template <typename T>
+    Napi::TypedArrayOf<T> view(Napi::Env env, Napi::ArrayBuffer buffer, FlatColumn column,
+                               size_t length) const {
+        return Napi::TypedArrayOf<T>::New(env, length, buffer, offsets[static_cast<int>(column)]);
+    }
+};
+
+Napi::ArrayBuffer hand_over(Napi::Env env, FlatTree *tree) {
+#ifdef NODE_API_NO_EXTERNAL_BUFFERS_ALLOWED
+    // Runtimes with a V8 sandbox, such as Electron, refuse memory allocated
+    // outside it; copy once instead.
+    Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, tree->size());
+    memcpy(buffer.Data(), tree->data(), tree->size());
+    delete tree;
+    return buffer;
+#else
+    // The buffer takes ownership of the tree and frees it when collected.
+    int64_t size = static_cast<int64_t>(tree->size());
+    Napi::MemoryManagement::AdjustExternalMemory(env, size);
+    return Napi::ArrayBuffer::New(
+        env, tree->data(), tree->size(),
+        [size](Napi::Env env, void *, FlatTree *tree) {
+            Napi::MemoryManagement::AdjustExternalMemory(env, -size);
+            delete tree;
+        },
+        tree);
+#endif
+}
+
+Napi::Array symbol_names(Napi::Env env) {
+    const TSLanguage *language = tree_sitter_objecttext();
+    uint32_t count = ts_language_symbol_count(language);
+    Napi::Array names = Napi::Array::New(env, count);
+    for (uint32_t symbol = 0; symbol < count; symbol++) {
+        names[symbol] = ts_language_symbol_name(language, static_cast<TSSymbol>(symbol));
+    }
+    // ERROR nodes carry the builtin symbol 65535, past the language's own,
+    // so it gets a sparse entry of its own.
+    TSSymbol error = static_cast<TSSymbol>(-1);
+    names[static_cast<uint32_t>(error)] = ts_language_symbol_name(language, error);
+    return names;
+}
+
+// parseFlat(source, { named }) -> FlatTree
+Napi::Value ParseFlat(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    std::string text;
+    std::string_view source;
+    if (info.Length() > 0 && info[0].IsString()) {
+        text = info[0].As<Napi::String>().Utf8Value();
+        source = text;
+    } else if (info.Length() > 0 && info[0].IsTypedArray() &&
+               info[0].As<Napi::TypedArray>().TypedArrayType() == napi_uint8_array) {
+        // Buffers are parsed in place.
+        Napi::Uint8Array bytes = info[0].As<Napi::Uint8Array>();
+        source = std::string_view(reinterpret_cast<const char *>(bytes.Data()), bytes.ByteLength());
+    } else {
+        throw Napi::TypeError::New(env, "parseFlat expects a string or a Uint8Array");
+    }
+    bool named_only = false;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        named_only = info[1].As<Napi::Object>().Get("named").ToBoolean();
+    }
+
+    // Parsers are not shared between worker threads.
+    thread_local Parser parser;
+    Tree tree = parser.parse(source);
+    FlatTree *flat = new FlatTree(FlatTree::build(ts_tree_root_node(tree.get()), source, named_only));
+    const Layout layout(*flat);
+    Napi::ArrayBuffer buffer = hand_over(env, flat);
+
+    size_t nodes = layout.nodes;
+    Napi::Object result = Napi::Object::New(env);
+    result["buffer"] = buffer;
+    result["nodeCount"] = static_cast<double>(nodes);
+    result["stringCount"] = static_cast<double>(layout.strings);
+    result["parent"] = layout.view<uint32_t>(env, buffer, FlatColumn::Parent, nodes);
+    result["end"] = layout.view<uint32_t>(env, buffer, FlatColumn::End, nodes);
+    result["startByte"] = layout.view<uint32_t>(env, buffer, FlatColumn::StartByte, nodes);
+    result["endByte"] = layout.view<uint32_t>(env, buffer, FlatColumn::EndByte, nodes);
+    result["text"] = layout.view<uint32_t>(env, buffer, FlatColumn::Text, nodes);
+    result["stringOffsets"] =
+        layout.view<uint32_t>(env, buffer, FlatColumn::StringOffsets, layout.strings + 1);
+    result["symbol"] = layout.view<uint16_t>(env, buffer, FlatColumn::Symbol, nodes);
+    result["flags"] = layout.view<uint8_t>(env, buffer, FlatColumn::Flags, nodes);
+    result["stringData"] =
+        layout.view<uint8_t>(env, buffer, FlatColumn::StringData, layout.string_bytes);
+    result["symbolNames"] = symbol_names(env);
+    return result;
+}
+
+} // namespace
+
+void InitFlatTree(Napi::Env env, Napi::Object exports) {
+    exports["parseFlat"] = Napi::Function::New(env, ParseFlat, "parseFlat");
+}
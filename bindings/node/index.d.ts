@@ -18,9 +18,107 @@ type NodeInfo =
       children: ChildNode[];
     });
 
+type PathMatch = {
+  key: string;
+  /** Raw text of the value, empty for groups and lists. */
+  value: string;
+  startByte: number;
+  endByte: number;
+  row: number;
+  column: number;
+};
+
+type FileSummary = {
+  path: string;
+  /** False if the file could not be read; the other fields are then absent. */
+  ok: boolean;
+  /** Key of the top-level entry. */
+  root?: string;
+  bytes?: number;
+  nodes?: number;
+  errorNodes?: number;
+  missingNodes?: number;
+  hasError?: boolean;
+  parseMs?: number;
+  /** Present when a query was given. */
+  matches?: PathMatch[];
+};
+
+type ParseFilesOptions = {
+  /** A path query such as `Parts/Thruster/Components/Cost[> 100]`. */
+  query?: string;
+  /** Files parsed at once; defaults to UV_THREADPOOL_SIZE, or 4. */
+  concurrency?: number;
+};
+
+/**
+ * A parsed file as parallel typed arrays over one ArrayBuffer, in preorder.
+ * The descendants of node `i` are the nodes from `i + 1` up to `end[i]`, so
+ * its first child is `i + 1` when `end[i] > i + 1`, and the sibling after it
+ * is `end[i]` when that is below `end[parent[i]]`.
+ */
+type FlatTree = {
+  buffer: ArrayBuffer;
+  nodeCount: number;
+  stringCount: number;
+  /** 0xffffffff for the root. */
+  parent: Uint32Array;
+  end: Uint32Array;
+  startByte: Uint32Array;
+  endByte: Uint32Array;
+  /**
+   * For named nodes without named children, an id into the string table:
+   * the UTF-8 bytes `stringData[stringOffsets[id]..stringOffsets[id + 1]]`.
+   * 0xffffffff for other nodes.
+   */
+  text: Uint32Array;
+  stringOffsets: Uint32Array;
+  stringData: Uint8Array;
+  /** Indexes `symbolNames`. */
+  symbol: Uint16Array;
+  /** 1 named, 2 ERROR, 4 MISSING, 8 extra (a comment), 16 has an error inside. */
+  flags: Uint8Array;
+  /** Names by symbol; sparse, with "ERROR" at 65535 after the grammar's own. */
+  symbolNames: string[];
+};
+
+type ParseFlatOptions = {
+  /** Leave out anonymous nodes such as brackets and `=`. */
+  named?: boolean;
+};
+
+type ToJSONOptions = {
+  /** Spaces per nesting level; the default writes one line. */
+  indent?: number;
+  /** Return a Buffer that wraps the native output instead of a string. */
+  buffer?: boolean;
+};
+
 type Language = {
   language: unknown;
   nodeTypeInfo: NodeInfo[];
+  /**
+   * Reads and parses the files on the libuv thread pool and resolves with a
+   * summary of each, in the order of `paths`. Only present when the addon
+   * was built with the tree-sitter runtime.
+   */
+  parseFiles?: (paths: string[], options?: ParseFilesOptions) => Promise<FileSummary[]>;
+  /**
+   * Parses `source` on the calling thread and returns the whole tree in one
+   * buffer, without a call into the addon per node. Only present when the
+   * addon was built with the tree-sitter runtime.
+   */
+  parseFlat?: (source: string | Uint8Array, options?: ParseFlatOptions) => FlatTree;
+  /**
+   * Parses `source` and converts it to JSON natively: groups become objects,
+   * lists arrays, numbers numbers (`50%` is 0.5) and other values strings.
+   * Only present when the addon was built with the tree-sitter runtime.
+   */
+  toJSON?: {
+    (source: string | Uint8Array, options?: ToJSONOptions & { buffer?: false }): string;
+    /** A Buffer when running under Node. */
+    (source: string | Uint8Array, options: ToJSONOptions & { buffer: true }): Uint8Array;
+  };
 };
 
 declare const language: Language;
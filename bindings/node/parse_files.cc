@@ -0,0 +1,208 @@
+#include <napi.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "objecttext/parse_metrics.h"
+#include "objecttext/parser.h"
+#include "objecttext/path_match.h"
+#include "objecttext/path_query.h"
+
+using namespace objecttext;
+
+namespace {
+
+struct FileSummary {
+    std::string path;
+    bool ok = false; // false if the file could not be read
+    std::string root; // key of the top-level entry
+    ParseStats stats;
+    std::vector<PathMatch> matches;
+};
+
+// One parseFiles() call, shared by the workers that serve it. Workers take
+// the next unclaimed file until none are left, so files of different sizes
+// balance themselves across the pool.
+struct Batch {
+    std::vector<std::string> paths;
+    std::optional<PathQuery> query;
+    std::vector<FileSummary> results;
+    std::atomic<size_t> next{0};
+    unsigned running = 0; // only touched on the main thread
+    bool settled = false;  // the promise was rejected or resolved
+    Napi::Promise::Deferred deferred;
+
+    explicit Batch(Napi::Env env) : deferred(Napi::Promise::Deferred::New(env)) {}
+};
+
+void summarize(Parser &parser, const PathQuery *query, FileSummary *summary) {
+    std::string source;
+    if (!read_file(summary->path, &source)) return;
+    summary->ok = true;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Tree tree = parser.parse(source);
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    summary->stats = ParseStats::collect(tree.get(), seconds, false, false);
+
+    TSNode root = ts_tree_root_node(tree.get());
+    const Symbols &symbols = Symbols::get();
+    uint32_t count = ts_node_child_count(root);
+    for (uint32_t i = 0; i < count; i++) {
+        TSNode child = ts_node_child(root, i);
+        if (is_entry(symbols, ts_node_symbol(child))) {
+            summary->root = std::string(entry_key(child, source));
+            break;
+        }
+    }
+    if (query) {
+        PathMatcher matcher(*query);
+        matcher.run(root, source, [&](TSNode node) {
+            summary->matches.push_back(make_path_match(node, source));
+        });
+    }
+}
+
+Napi::Value to_js(Napi::Env env, const Batch &batch) {
+    Napi::Array results = Napi::Array::New(env, batch.results.size());
+    for (uint32_t i = 0; i < batch.results.size(); i++) {
+        const FileSummary &summary = batch.results[i];
+        Napi::Object object = Napi::Object::New(env);
+        object["path"] = summary.path;
+        object["ok"] = summary.ok;
+        if (summary.ok) {
+            const ParseStats &stats = summary.stats;
+            object["root"] = summary.root;
+            object["bytes"] = static_cast<double>(stats.bytes);
+            object["nodes"] = static_cast<double>(stats.nodes);
+            object["errorNodes"] = static_cast<double>(stats.error_nodes);
+            object["missingNodes"] = static_cast<double>(stats.missing_nodes);
+            object["hasError"] = stats.error_nodes > 0 || stats.missing_nodes > 0;
+            object["parseMs"] = stats.seconds * 1e3;
+        }
+        if (batch.query) {
+            Napi::Array matches = Napi::Array::New(env, summary.matches.size());
+            for (uint32_t j = 0; j < summary.matches.size(); j++) {
+                const PathMatch &match = summary.matches[j];
+                Napi::Object item = Napi::Object::New(env);
+                item["key"] = match.key;
+                item["value"] = match.value;
+                item["startByte"] = match.start_byte;
+                item["endByte"] = match.end_byte;
+                item["row"] = match.start_point.row;
+                item["column"] = match.start_point.column;
+                matches[j] = item;
+            }
+            object["matches"] = matches;
+        }
+        results[i] = object;
+    }
+    return results;
+}
+
+class ParseFilesWorker : public Napi::AsyncWorker {
+public:
+    ParseFilesWorker(Napi::Env env, std::shared_ptr<Batch> batch)
+        : Napi::AsyncWorker(env, "objecttext.parseFiles"), batch_(std::move(batch)) {}
+
+    // Runs on a libuv pool thread, without touching JavaScript values.
+    void Execute() override {
+        Parser parser;
+        const PathQuery *query = batch_->query ? &*batch_->query : nullptr;
+        for (size_t index; (index = batch_->next.fetch_add(1, std::memory_order_relaxed)) <
+                           batch_->paths.size();) {
+            summarize(parser, query, &batch_->results[index]);
+        }
+    }
+
+    void OnOK() override {
+        if (--batch_->running == 0 && !batch_->settled) {
+            batch_->settled = true;
+            batch_->deferred.Resolve(to_js(Env(), *batch_));
+        }
+    }
+
+    // Called instead of OnOK() when Execute() failed or threw. The first
+    // failure rejects the promise; the other workers still finish.
+    void OnError(const Napi::Error &error) override {
+        --batch_->running;
+        if (!batch_->settled) {
+            batch_->settled = true;
+            batch_->deferred.Reject(error.Value());
+        }
+    }
+
+private:
+    std::shared_ptr<Batch> batch_;
+};
+
+unsigned pool_size() {
+    const char *value = getenv("UV_THREADPOOL_SIZE");
+    int size = value ? atoi(value) : 0;
+    return size > 0 ? static_cast<unsigned>(size) : 4;
+}
+
+// parseFiles(paths, { query, concurrency }) -> Promise<FileSummary[]>
+Napi::Value ParseFiles(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        throw Napi::TypeError::New(env, "parseFiles expects an array of paths");
+    }
+    auto batch = std::make_shared<Batch>(env);
+    Napi::Array paths = info[0].As<Napi::Array>();
+    for (uint32_t i = 0; i < paths.Length(); i++) {
+        Napi::Value path = paths[i];
+        if (!path.IsString()) throw Napi::TypeError::New(env, "paths must be strings");
+        batch->paths.push_back(path.As<Napi::String>().Utf8Value());
+    }
+
+    unsigned concurrency = pool_size();
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        Napi::Value query = options.Get("query");
+        if (query.IsString()) {
+            std::string text = query.As<Napi::String>().Utf8Value();
+            uint32_t offset = 0;
+            batch->query = PathQuery::compile(text, &offset);
+            if (!batch->query) {
+                throw Napi::Error::New(env, "invalid path query at offset " + std::to_string(offset));
+            }
+        } else if (!query.IsUndefined()) {
+            throw Napi::TypeError::New(env, "query must be a string");
+        }
+        Napi::Value workers = options.Get("concurrency");
+        if (workers.IsNumber() && workers.As<Napi::Number>().Int32Value() > 0) {
+            concurrency = static_cast<unsigned>(workers.As<Napi::Number>().Int32Value());
+        }
+    }
+
+    Napi::Promise promise = batch->deferred.Promise();
+    batch->results.resize(batch->paths.size());
+    for (size_t i = 0; i < batch->paths.size(); i++) batch->results[i].path = batch->paths[i];
+    if (batch->paths.empty()) {
+        batch->deferred.Resolve(Napi::Array::New(env));
+        return promise;
+    }
+
+    // More workers than the pool has threads would only queue behind each
+    // other.
+    batch->running = static_cast<unsigned>(std::min<size_t>(concurrency, batch->paths.size()));
+    for (unsigned i = 0, workers = batch->running; i < workers; i++) {
+        (new ParseFilesWorker(env, batch))->Queue();
+    }
+    return promise;
+}
+
+} // namespace
+
+void InitParseFiles(Napi::Env env, Napi::Object exports) {
+    exports["parseFiles"] = Napi::Function::New(env, ParseFiles, "parseFiles");
+}
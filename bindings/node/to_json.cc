@@ -0,0 +1,74 @@
+#include <napi.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "objecttext/parser.h"
+#include "objecttext/to_json.h"
+
+using namespace objecttext;
+
+namespace {
+
+Napi::Buffer<char> to_buffer(Napi::Env env, std::string *json) {
+#ifdef NODE_API_NO_EXTERNAL_BUFFERS_ALLOWED
+    Napi::Buffer<char> buffer = Napi::Buffer<char>::Copy(env, json->data(), json->size());
+    delete json;
+    return buffer;
+#else
+    // The Buffer takes ownership of the string and frees it when collected.
+    int64_t size = static_cast<int64_t>(json->capacity());
+    Napi::MemoryManagement::AdjustExternalMemory(env, size);
+    return Napi::Buffer<char>::New(
+        env, json->data(), json->size(),
+        [size](Napi::Env env, char *, std::string *json) {
+            Napi::MemoryManagement::AdjustExternalMemory(env, -size);
+            delete json;
+        },
+        json);
+#endif
+}
+
+// toJSON(source, { indent, buffer }) -> string | Buffer
+Napi::Value ToJSON(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    std::string text;
+    std::string_view source;
+    if (info.Length() > 0 && info[0].IsString()) {
+        text = info[0].As<Napi::String>().Utf8Value();
+        source = text;
+    } else if (info.Length() > 0 && info[0].IsTypedArray() &&
+               info[0].As<Napi::TypedArray>().TypedArrayType() == napi_uint8_array) {
+        Napi::Uint8Array bytes = info[0].As<Napi::Uint8Array>();
+        source = std::string_view(reinterpret_cast<const char *>(bytes.Data()), bytes.ByteLength());
+    } else {
+        throw Napi::TypeError::New(env, "toJSON expects a string or a Uint8Array");
+    }
+    JsonOptions options;
+    bool as_buffer = false;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object object = info[1].As<Napi::Object>();
+        Napi::Value indent = object.Get("indent");
+        if (indent.IsNumber() && indent.As<Napi::Number>().Int32Value() > 0) {
+            options.indent = static_cast<unsigned>(indent.As<Napi::Number>().Int32Value());
+        }
+        as_buffer = object.Get("buffer").ToBoolean();
+    }
+
+    thread_local Parser parser;
+    Tree tree = parser.parse(source);
+    // JSON of a rules file is about as long as the file; reserving that
+    // much saves most of the regrowth.
+    auto json = std::make_unique<std::string>();
+    json->reserve(source.size() + source.size() / 4);
+    write_json(ts_tree_root_node(tree.get()), source, json.get(), options);
+    if (as_buffer) return to_buffer(env, json.release());
+    return Napi::String::New(env, json->data(), json->size());
+}
+
+} // namespace
+
+void InitToJSON(Napi::Env env, Napi::Object exports) {
+    exports["toJSON"] = Napi::Function::New(env, ToJSON, "toJSON");
+}
@@ -0,0 +1,37 @@
+// Prints the directory of the tree-sitter C runtime that binding.gyp builds
+// parseFiles() against: $TREE_SITTER_LIB_DIR, or the sources vendored by the
+// `tree-sitter` package. Prints nothing if neither exists or the runtime is
+// older than 0.25, which the C++ API needs (ABI 15 and
+// ts_parser_parse_with_options()); the addon then only exports the language.
+const fs = require("fs");
+const path = require("path");
+
+function find() {
+  if (process.env.TREE_SITTER_LIB_DIR) return process.env.TREE_SITTER_LIB_DIR;
+  try {
+    const root = path.dirname(require.resolve("tree-sitter/package.json"));
+    return path.join(root, "vendor", "tree-sitter", "lib");
+  } catch (_) {
+    return "";
+  }
+}
+
+function supported(dir) {
+  if (!dir || !fs.existsSync(path.join(dir, "src", "lib.c"))) return false;
+  let api;
+  try {
+    api = fs.readFileSync(path.join(dir, "include", "tree_sitter", "api.h"), "utf8");
+  } catch (_) {
+    return false;
+  }
+  const version = /#define\s+TREE_SITTER_LANGUAGE_VERSION\s+(\d+)/.exec(api);
+  return version !== null && Number(version[1]) >= 15 && api.includes("ts_parser_parse_with_options");
+}
+
+const dir = find();
+if (supported(dir)) {
+  process.stdout.write(dir);
+} else if (process.env.TREE_SITTER_LIB_DIR) {
+  process.stderr.write(`TREE_SITTER_LIB_DIR=${dir} is not a tree-sitter 0.25+ runtime; ` +
+                       "building the addon without parseFiles(), parseFlat() and toJSON()\n");
+}
@@ -1,4 +1,8 @@
-from unittest import TestCase
+import mmap
+from collections.abc import Mapping, Sequence
+from os import path
+from tempfile import TemporaryDirectory, TemporaryFile
+from unittest import TestCase, skipUnless
 
 from tree_sitter import Language, Parser
 import tree_sitter_objecttext
@@ -10,3 +14,132 @@ class TestLanguage(TestCase):
             Parser(Language(tree_sitter_objecttext.language()))
         except Exception:
             self.fail("Error loading Object Text grammar")
+
+
+@skipUnless(hasattr(tree_sitter_objecttext, "parse_many"), "built without the tree-sitter runtime")
+class TestParseMany(TestCase):
+    def test_parse_many(self):
+        with TemporaryDirectory() as directory:
+            good = path.join(directory, "good.rules")
+            broken = path.join(directory, "broken.rules")
+            with open(good, "w") as file:
+                file.write("Ship\n{\n    Cost = 150\n}\n")
+            with open(broken, "w") as file:
+                file.write("Ship\n{\n    ..Cost = 1\n")
+
+            results = tree_sitter_objecttext.parse_many(
+                [good, broken, path.join(directory, "missing")], threads=2
+            )
+            self.assertEqual([result.path for result in results][:2], [good, broken])
+            self.assertTrue(results[0].ok)
+            self.assertEqual(results[0].root, "Ship")
+            self.assertFalse(results[0].has_error)
+            self.assertGreater(results[0].nodes, 0)
+            self.assertTrue(results[1].has_error)
+            self.assertFalse(results[2].ok)
+            self.assertIsNone(results[2].nodes)
+            self.assertEqual(tree_sitter_objecttext.parse_many([]), [])
+
+
+@skipUnless(hasattr(tree_sitter_objecttext, "parse"), "built without the tree-sitter runtime")
+class TestParse(TestCase):
+    SOURCE = b"Ship\n{\n    Cost = 150\n}\n"
+
+    def test_text_is_a_view_of_the_buffer(self):
+        source = bytearray(self.SOURCE)
+        tree = tree_sitter_objecttext.parse(source)
+        self.assertEqual(tree.root_key, "Ship")
+        self.assertFalse(tree.has_error)
+        [match] = tree.match("Ship/Cost")
+        self.assertIsInstance(match.value, memoryview)
+        self.assertEqual(bytes(match.value), b"150")
+        self.assertEqual(tree.text(match.start_byte, match.end_byte, copy=True), b"Cost = 150")
+
+        # The buffer stays pinned while the tree or a slice of it is alive.
+        with self.assertRaises(BufferError):
+            source.extend(b"\n")
+        value = match.value
+        del tree, match
+        with self.assertRaises(BufferError):
+            source.extend(b"\n")
+        value.release()
+        source.extend(b"\n")
+
+    def test_mmap(self):
+        with TemporaryFile() as file:
+            file.write(self.SOURCE)
+            file.flush()
+            with mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ) as mapped:
+                tree = tree_sitter_objecttext.parse(mapped)
+                self.assertEqual(bytes(tree.source), self.SOURCE)
+                with self.assertRaises(BufferError):
+                    mapped.close()
+                del tree
+
+    def test_str_and_memoryview(self):
+        self.assertEqual(tree_sitter_objecttext.parse(self.SOURCE.decode()).root_key, "Ship")
+        view = memoryview(self.SOURCE)[:-1]
+        self.assertEqual(bytes(tree_sitter_objecttext.parse(view).source), self.SOURCE[:-1])
+
+
+@skipUnless(hasattr(tree_sitter_objecttext, "parse"), "built without the tree-sitter runtime")
+class TestToDict(TestCase):
+    SOURCE = (
+        b"Ship\n"
+        b"{\n"
+        b"    Parts\n"
+        b"    {\n"
+        b"        Thruster : Base\n"
+        b"        {\n"
+        b"            Name = \"Big \\\"one\\\"\"\n"
+        b"            Cost = 150\n"
+        b"            Scale = 50%\n"
+        b"            Thrust = 2 * (10 + 5)\n"
+        b"        }\n"
+        b"    }\n"
+        b"    Tags\n"
+        b"    [\n"
+        b"        Key = 1\n"
+        b"        {\n"
+        b"            Cost = 2\n"
+        b"        }\n"
+        b"    ]\n"
+        b"}\n"
+    )
+
+    def test_to_dict(self):
+        document = tree_sitter_objecttext.parse(self.SOURCE).to_dict()
+        thruster = document["Ship"]["Parts"]["Thruster"]
+        self.assertEqual(thruster["$extends"], ["Base"])
+        self.assertEqual(thruster["Name"], 'Big "one"')
+        self.assertEqual(thruster["Cost"], 150)
+        self.assertIsInstance(thruster["Cost"], int)
+        self.assertEqual(thruster["Scale"], 0.5)
+        self.assertEqual(thruster["Thrust"], "2 * (10 + 5)")
+        self.assertEqual(document["Ship"]["Tags"], [{"Key": 1}, {"Cost": 2}])
+
+        evaluated = tree_sitter_objecttext.parse(self.SOURCE).to_dict(evaluate=True)
+        self.assertEqual(evaluated["Ship"]["Parts"]["Thruster"]["Thrust"], 30.0)
+
+    def test_view(self):
+        view = tree_sitter_objecttext.parse(self.SOURCE).view()
+        self.assertIsInstance(view, Mapping)
+        parts = view["Ship"]["Parts"]
+        self.assertIsInstance(parts, tree_sitter_objecttext.GroupView)
+        self.assertEqual(parts["Thruster"]["Cost"], 150)
+        self.assertEqual(list(parts["Thruster"]), ["$extends", "Name", "Cost", "Scale", "Thrust"])
+        self.assertIn("Scale", parts["Thruster"])
+        self.assertIsNone(parts.get("Missing"))
+        with self.assertRaises(KeyError):
+            parts["Missing"]
+
+        tags = view["Ship"]["Tags"]
+        self.assertIsInstance(tags, Sequence)
+        self.assertEqual(len(tags), 2)
+        self.assertEqual(tags[0], {"Key": 1})
+        self.assertEqual(tags[-1]["Cost"], 2)
+        self.assertEqual(tags.to_list(), [{"Key": 1}, {"Cost": 2}])
+        self.assertEqual(view.to_dict(), tree_sitter_objecttext.parse(self.SOURCE).to_dict())
+        self.assertEqual(
+            view.to_dict(evaluate=True)["Ship"]["Parts"]["Thruster"]["Thrust"], 30.0
+        )
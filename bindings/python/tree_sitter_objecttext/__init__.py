@@ -1,9 +1,23 @@
 """Halfling Engine's Object Text. Used in Cosmoteer."""
 
+from collections.abc import Mapping as _Mapping, Sequence as _Sequence
 from importlib.resources import files as _files
 
 from ._binding import language
 
+try:
+    from ._binding import (
+        GroupView, ListView, ParseResult, PathMatch, Tree, parse, parse_many,
+    )
+except ImportError:  # built without the tree-sitter runtime
+    _NATIVE = []
+else:
+    _Mapping.register(GroupView)
+    _Sequence.register(ListView)
+    _NATIVE = [
+        "GroupView", "ListView", "ParseResult", "PathMatch", "Tree", "parse", "parse_many",
+    ]
+
 
 def _get_query(name, file):
     query = _files(f"{__package__}.queries") / file
@@ -12,27 +26,22 @@ def _get_query(name, file):
 
 
 def __getattr__(name):
-    # NOTE: uncomment these to include any queries that this grammar contains:
-
-    # if name == "HIGHLIGHTS_QUERY":
-    #     return _get_query("HIGHLIGHTS_QUERY", "highlights.scm")
-    # if name == "INJECTIONS_QUERY":
-    #     return _get_query("INJECTIONS_QUERY", "injections.scm")
-    # if name == "LOCALS_QUERY":
-    #     return _get_query("LOCALS_QUERY", "locals.scm")
-    # if name == "TAGS_QUERY":
-    #     return _get_query("TAGS_QUERY", "tags.scm")
+    if name == "HIGHLIGHTS_QUERY":
+        return _get_query("HIGHLIGHTS_QUERY", "highlights.scm")
+    if name == "LOCALS_QUERY":
+        return _get_query("LOCALS_QUERY", "locals.scm")
+    if name == "TAGS_QUERY":
+        return _get_query("TAGS_QUERY", "tags.scm")
 
     raise AttributeError(f"module {__name__!r} has no attribute {name!r}")
 
 
 __all__ = [
     "language",
-    # "HIGHLIGHTS_QUERY",
-    # "INJECTIONS_QUERY",
-    # "LOCALS_QUERY",
-    # "TAGS_QUERY",
-]
+    "HIGHLIGHTS_QUERY",
+    "LOCALS_QUERY",
+    "TAGS_QUERY",
+] + _NATIVE
 
 
 def __dir__():
@@ -1,10 +1,132 @@
-from typing import Final
+from typing_extensions import Buffer
+from os import PathLike
+from typing import (
+    Any, Final, Iterable, Iterator, Mapping, NamedTuple, Protocol, Sequence, final, overload,
+)
 
-# NOTE: uncomment these to include any queries that this grammar contains:
-
-# HIGHLIGHTS_QUERY: Final[str]
-# INJECTIONS_QUERY: Final[str]
-# LOCALS_QUERY: Final[str]
-# TAGS_QUERY: Final[str]
+HIGHLIGHTS_QUERY: Final[str]
+LOCALS_QUERY: Final[str]
+TAGS_QUERY: Final[str]
 
 def language() -> object: ...
+
+_Path = str | bytes | PathLike[str] | PathLike[bytes]
+
+class ParseResult(NamedTuple):
+    """Summary of one file parsed by parse_many()."""
+
+    path: _Path
+    ok: bool
+    """False if the file could not be read; the other fields are then None."""
+    root: str | None
+    """Key of the top-level entry."""
+    bytes: int | None
+    nodes: int | None
+    error_nodes: int | None
+    missing_nodes: int | None
+    has_error: bool | None
+    parse_seconds: float | None
+
+def parse_many(paths: Iterable[_Path], threads: int = 0) -> list[ParseResult]:
+    """Parse files on native threads without holding the GIL.
+
+    Only present when the package was built with TREE_SITTER_LIB_DIR set.
+    threads=0 uses one thread per core.
+    """
+
+class _Node(Protocol):
+    @property
+    def start_byte(self) -> int: ...
+    @property
+    def end_byte(self) -> int: ...
+
+class PathMatch(NamedTuple):
+    """An entry reached by Tree.match()."""
+
+    key: str
+    value: memoryview | bytes | None
+    """Source of an assignment's value; None for groups and lists."""
+    start_byte: int
+    end_byte: int
+    row: int
+    column: int
+
+@final
+class Tree:
+    """A syntax tree that keeps the buffer it was parsed from.
+
+    The buffer stays exported while the tree or any slice of it is alive:
+    a bytearray cannot be resized and an mmap cannot be closed until then.
+    """
+
+    @property
+    def source(self) -> memoryview: ...
+    @property
+    def has_error(self) -> bool: ...
+    @property
+    def root_key(self) -> str | None: ...
+    @overload
+    def text(self, node: _Node, /, *, copy: bool = False) -> memoryview | bytes: ...
+    @overload
+    def text(self, start: int, end: int, /, *, copy: bool = False) -> memoryview | bytes: ...
+    def match(self, query: str, *, copy: bool = False) -> list[PathMatch]: ...
+    def to_dict(self, *, evaluate: bool = False) -> dict[str, Any]:
+        """Convert the document to dicts, lists and scalars in one pass.
+
+        Groups become dicts and lists become lists; keyed entries in a list
+        become one-item dicts and unnamed blocks in a group are keyed by
+        their index. Extensions are listed under "$extends". Whole numbers
+        become int and other numbers float (50% is 0.5); strings lose their
+        quotes. With evaluate=True, arithmetic without references becomes a
+        float, otherwise it stays text like every other value.
+        """
+    def view(self, *, evaluate: bool = False) -> GroupView:
+        """A mapping of the document that converts entries as they are looked up."""
+    def __buffer__(self, flags: int, /) -> memoryview: ...
+
+_Value = str | int | float | GroupView | ListView | dict[str, Any] | None
+
+@final
+class GroupView(Mapping[str, _Value]):
+    """A read-only mapping over a group, with the keys of Tree.to_dict().
+
+    Nothing is converted until it is looked up, so view["Parts"]["Cost"]
+    reads only the entries on that path. Blocks come back as views.
+    """
+
+    @property
+    def tree(self) -> Tree: ...
+    @property
+    def start_byte(self) -> int: ...
+    @property
+    def end_byte(self) -> int: ...
+    def __getitem__(self, key: str, /) -> _Value: ...
+    def __iter__(self) -> Iterator[str]: ...
+    def __len__(self) -> int: ...
+    def keys(self) -> list[str]: ...  # type: ignore[override]
+    def values(self) -> list[_Value]: ...  # type: ignore[override]
+    def items(self) -> list[tuple[str, _Value]]: ...  # type: ignore[override]
+    def to_dict(self, *, evaluate: bool = ...) -> dict[str, Any]: ...
+
+@final
+class ListView(Sequence[_Value]):
+    """A read-only sequence over a list that converts items as they are indexed."""
+
+    @property
+    def tree(self) -> Tree: ...
+    @property
+    def start_byte(self) -> int: ...
+    @property
+    def end_byte(self) -> int: ...
+    @overload
+    def __getitem__(self, index: int, /) -> _Value: ...
+    @overload
+    def __getitem__(self, index: slice, /) -> Sequence[_Value]: ...
+    def __len__(self) -> int: ...
+    def to_list(self, *, evaluate: bool = ...) -> list[Any]: ...
+
+def parse(source: str | Buffer) -> Tree:
+    """Parse source in place, without copying buffers.
+
+    Only present when the package was built with TREE_SITTER_LIB_DIR set.
+    """
@@ -4,11 +4,28 @@ typedef struct TSLanguage TSLanguage;
 
 TSLanguage *tree_sitter_objecttext(void);
 
+#ifdef OBJECTTEXT_WITH_RUNTIME
+int _binding_init_parse_many(PyObject *module);
+PyObject *_binding_parse_many(PyObject *module, PyObject *args, PyObject *kwargs);
+int _binding_init_tree(PyObject *module);
+PyObject *_binding_parse(PyObject *module, PyObject *source);
+#endif
+
 static PyObject* _binding_language(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args)) {
     return PyCapsule_New(tree_sitter_objecttext(), "tree_sitter.Language", NULL);
 }
 
+#ifdef OBJECTTEXT_WITH_RUNTIME
+static int _binding_exec(PyObject *module) {
+    if (_binding_init_parse_many(module) < 0) return -1;
+    return _binding_init_tree(module);
+}
+#endif
+
 static struct PyModuleDef_Slot slots[] = {
+#ifdef OBJECTTEXT_WITH_RUNTIME
+    {Py_mod_exec, _binding_exec},
+#endif
 #ifdef Py_GIL_DISABLED
     {Py_mod_gil, Py_MOD_GIL_NOT_USED},
 #endif
@@ -18,6 +35,17 @@ static struct PyModuleDef_Slot slots[] = {
 static PyMethodDef methods[] = {
     {"language", _binding_language, METH_NOARGS,
      "Get the tree-sitter language for this grammar."},
+#ifdef OBJECTTEXT_WITH_RUNTIME
+    {"parse_many", (PyCFunction)(void (*)(void))_binding_parse_many, METH_VARARGS | METH_KEYWORDS,
+     "parse_many(paths, threads=0)\n--\n\n"
+     "Parse files on a pool of native threads without holding the GIL and\n"
+     "return a ParseResult for each, in the order of paths. threads=0 uses\n"
+     "one thread per core."},
+    {"parse", _binding_parse, METH_O,
+     "parse(source)\n--\n\n"
+     "Parse a str or any object with the buffer protocol (bytes, bytearray,\n"
+     "memoryview, mmap.mmap) in place and return a Tree that holds on to it."},
+#endif
     {NULL, NULL, 0, NULL}
 };
 
@@ -0,0 +1,191 @@
+#include <Python.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "objecttext/parallel.h"
+#include "objecttext/parse_metrics.h"
+#include "objecttext/parser.h"
+
+using namespace objecttext;
+
+namespace {
+
+struct FileResult {
+    bool ok = false; // false if the file could not be read
+    std::string root; // key of the top-level entry
+    ParseStats stats;
+};
+
+void parse_file(Parser &parser, const std::string &path, FileResult *result) {
+    std::string source;
+    if (!read_file(path, &source)) return;
+    result->ok = true;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Tree tree = parser.parse(source);
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result->stats = ParseStats::collect(tree.get(), seconds, false, false);
+
+    TSNode root = ts_tree_root_node(tree.get());
+    const Symbols &symbols = Symbols::get();
+    uint32_t count = ts_node_child_count(root);
+    for (uint32_t i = 0; i < count; i++) {
+        TSNode child = ts_node_child(root, i);
+        if (is_entry(symbols, ts_node_symbol(child))) {
+            result->root = std::string(entry_key(child, source));
+            break;
+        }
+    }
+}
+
+PyStructSequence_Field result_fields[] = {
+    {"path", "the path as given"},
+    {"ok", "False if the file could not be read; the other fields are then None"},
+    {"root", "key of the top-level entry"},
+    {"bytes", "size of the file"},
+    {"nodes", "nodes in the tree"},
+    {"error_nodes", "ERROR nodes in the tree"},
+    {"missing_nodes", "nodes the parser inserted to recover"},
+    {"has_error", "whether the tree has ERROR or MISSING nodes"},
+    {"parse_seconds", "wall time of the parse"},
+    {nullptr, nullptr},
+};
+
+PyStructSequence_Desc result_desc = {
+    "tree_sitter_objecttext.ParseResult",
+    "Summary of one file parsed by parse_many().",
+    result_fields,
+    9,
+};
+
+// Builds the ParseResult for |result|, stealing |path|.
+PyObject *to_python(PyObject *type, PyObject *path, const FileResult &result) {
+    PyObject *item = PyStructSequence_New(reinterpret_cast<PyTypeObject *>(type));
+    if (!item) {
+        Py_DECREF(path);
+        return nullptr;
+    }
+    PyStructSequence_SetItem(item, 0, path);
+    PyStructSequence_SetItem(item, 1, PyBool_FromLong(result.ok));
+    if (!result.ok) {
+        for (Py_ssize_t field = 2; field < 9; field++) {
+            Py_INCREF(Py_None);
+            PyStructSequence_SetItem(item, field, Py_None);
+        }
+        return item;
+    }
+    const ParseStats &stats = result.stats;
+    PyObject *values[] = {
+        PyUnicode_DecodeUTF8(result.root.data(), static_cast<Py_ssize_t>(result.root.size()),
+                             "replace"),
+        PyLong_FromSize_t(stats.bytes),
+        PyLong_FromSize_t(stats.nodes),
+        PyLong_FromSize_t(stats.error_nodes),
+        PyLong_FromSize_t(stats.missing_nodes),
+        PyBool_FromLong(stats.error_nodes > 0 || stats.missing_nodes > 0),
+        PyFloat_FromDouble(stats.seconds),
+    };
+    bool failed = false;
+    for (Py_ssize_t i = 0; i < 7; i++) {
+        if (!values[i]) {
+            failed = true;
+            Py_INCREF(Py_None);
+            values[i] = Py_None;
+        }
+        PyStructSequence_SetItem(item, i + 2, values[i]);
+    }
+    if (failed) {
+        Py_DECREF(item);
+        return nullptr;
+    }
+    return item;
+}
+
+} // namespace
+
+extern "C" {
+
+// Adds the ParseResult type to |module|.
+int _binding_init_parse_many(PyObject *module) {
+    PyTypeObject *type = PyStructSequence_NewType(&result_desc);
+    if (!type) return -1;
+    if (PyModule_AddObject(module, "ParseResult", reinterpret_cast<PyObject *>(type)) < 0) {
+        Py_DECREF(type);
+        return -1;
+    }
+    return 0;
+}
+
+PyObject *_binding_parse_many(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static const char *keywords[] = {"paths", "threads", nullptr};
+    PyObject *paths;
+    int threads = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|i:parse_many", const_cast<char **>(keywords),
+                                     &paths, &threads)) {
+        return nullptr;
+    }
+    if (threads < 0) {
+        PyErr_SetString(PyExc_ValueError, "threads must not be negative");
+        return nullptr;
+    }
+    PyObject *type = PyObject_GetAttrString(module, "ParseResult");
+    if (!type) return nullptr;
+
+    // Paths are converted while the GIL is held; the workers only see
+    // std::strings.
+    PyObject *originals = PyList_New(0);
+    PyObject *iterator = originals ? PyObject_GetIter(paths) : nullptr;
+    if (!iterator) {
+        Py_XDECREF(originals);
+        Py_DECREF(type);
+        return nullptr;
+    }
+    std::vector<std::string> files;
+    for (PyObject *path; (path = PyIter_Next(iterator));) {
+        PyObject *encoded = nullptr;
+        int appended = PyList_Append(originals, path);
+        if (appended == 0 && PyUnicode_FSConverter(path, &encoded)) {
+            files.emplace_back(PyBytes_AsString(encoded),
+                               static_cast<size_t>(PyBytes_Size(encoded)));
+            Py_DECREF(encoded);
+        }
+        Py_DECREF(path);
+        if (PyErr_Occurred()) break;
+    }
+    Py_DECREF(iterator);
+    if (PyErr_Occurred()) {
+        Py_DECREF(originals);
+        Py_DECREF(type);
+        return nullptr;
+    }
+
+    std::vector<FileResult> results(files.size());
+    Py_BEGIN_ALLOW_THREADS
+    unsigned workers = threads ? static_cast<unsigned>(threads) : default_threads();
+    std::vector<Parser> parsers(std::min<size_t>(workers, files.size()));
+    parallel_for(files.size(), workers, [&](size_t index, unsigned worker) {
+        parse_file(parsers[worker], files[index], &results[index]);
+    });
+    Py_END_ALLOW_THREADS
+
+    PyObject *list = PyList_New(static_cast<Py_ssize_t>(results.size()));
+    for (size_t i = 0; list && i < results.size(); i++) {
+        PyObject *path = PyList_GetItem(originals, static_cast<Py_ssize_t>(i));
+        Py_INCREF(path);
+        PyObject *item = to_python(type, path, results[i]);
+        if (!item) {
+            Py_CLEAR(list);
+            break;
+        }
+        PyList_SetItem(list, static_cast<Py_ssize_t>(i), item);
+    }
+    Py_DECREF(originals);
+    Py_DECREF(type);
+    return list;
+}
+
+} // extern "C"
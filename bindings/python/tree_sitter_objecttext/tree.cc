@@ -0,0 +1,949 @@
+#include <Python.h>
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "objecttext/expression.h"
+#include "objecttext/parser.h"
+#include "objecttext/path_match.h"
+#include "objecttext/path_query.h"
+#include "objecttext/value.h"
+
+using namespace objecttext;
+
+namespace {
+
+// A syntax tree together with the buffer it was parsed from. The buffer is
+// held with PyObject_GetBuffer for the tree's lifetime, so a bytearray
+// cannot be resized and an mmap cannot be closed underneath it, and the
+// tree exports the same memory read-only so that text comes out as
+// memoryview slices instead of copies.
+struct TreeObject {
+    PyObject_HEAD
+    Py_buffer source;
+    TSTree *tree;
+};
+
+TreeObject *as_tree(PyObject *self) {
+    return reinterpret_cast<TreeObject *>(self);
+}
+
+std::string_view source_of(const TreeObject *tree) {
+    return std::string_view(static_cast<const char *>(tree->source.buf),
+                            static_cast<size_t>(tree->source.len));
+}
+
+void tree_dealloc(PyObject *self) {
+    TreeObject *tree = as_tree(self);
+    PyTypeObject *type = Py_TYPE(self);
+    if (tree->tree) ts_tree_delete(tree->tree);
+    if (tree->source.obj) PyBuffer_Release(&tree->source);
+    reinterpret_cast<freefunc>(PyType_GetSlot(type, Py_tp_free))(self);
+    Py_DECREF(type);
+}
+
+int tree_getbuffer(PyObject *self, Py_buffer *view, int flags) {
+    TreeObject *tree = as_tree(self);
+    return PyBuffer_FillInfo(view, self, tree->source.buf, tree->source.len, 1, flags);
+}
+
+// A read-only view of bytes [start, end) of the source that keeps the tree
+// alive.
+PyObject *slice(PyObject *self, Py_ssize_t start, Py_ssize_t end) {
+    PyObject *view = PyMemoryView_FromObject(self);
+    if (!view) return nullptr;
+    PyObject *start_index = PyLong_FromSsize_t(start);
+    PyObject *end_index = PyLong_FromSsize_t(end);
+    PyObject *range = start_index && end_index ? PySlice_New(start_index, end_index, nullptr)
+                                               : nullptr;
+    PyObject *result = range ? PyObject_GetItem(view, range) : nullptr;
+    Py_XDECREF(range);
+    Py_XDECREF(end_index);
+    Py_XDECREF(start_index);
+    Py_DECREF(view);
+    return result;
+}
+
+PyObject *text_of(PyObject *self, uint32_t start, uint32_t end, bool copy) {
+    TreeObject *tree = as_tree(self);
+    if (copy) {
+        return PyBytes_FromStringAndSize(static_cast<const char *>(tree->source.buf) + start,
+                                         static_cast<Py_ssize_t>(end - start));
+    }
+    return slice(self, start, end);
+}
+
+bool byte_offset(PyObject *object, const char *name, Py_ssize_t *offset) {
+    PyObject *value = name ? PyObject_GetAttrString(object, name) : object;
+    if (!value) return false;
+    *offset = PyLong_AsSsize_t(value);
+    if (name) Py_DECREF(value);
+    return !(*offset == -1 && PyErr_Occurred());
+}
+
+// text(node) or text(start_byte, end_byte), with copy=True for bytes.
+PyObject *tree_text(PyObject *self, PyObject *args, PyObject *kwargs) {
+    static const char *keywords[] = {"start", "end", "copy", nullptr};
+    PyObject *start_object;
+    PyObject *end_object = nullptr;
+    int copy = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O$p:text", const_cast<char **>(keywords),
+                                     &start_object, &end_object, &copy)) {
+        return nullptr;
+    }
+    Py_ssize_t start, end;
+    if (end_object) {
+        if (!byte_offset(start_object, nullptr, &start) || !byte_offset(end_object, nullptr, &end)) {
+            return nullptr;
+        }
+    } else if (!byte_offset(start_object, "start_byte", &start) ||
+               !byte_offset(start_object, "end_byte", &end)) {
+        return nullptr;
+    }
+    if (start < 0 || start > end || end > as_tree(self)->source.len) {
+        PyErr_SetString(PyExc_IndexError, "byte range outside the source");
+        return nullptr;
+    }
+    return text_of(self, static_cast<uint32_t>(start), static_cast<uint32_t>(end), copy);
+}
+
+PyObject *path_match_type(PyObject *self) {
+    PyObject *module = PyType_GetModule(Py_TYPE(self));
+    return module ? PyObject_GetAttrString(module, "PathMatch") : nullptr;
+}
+
+// match(query, copy=False) -> list[PathMatch]
+PyObject *tree_match(PyObject *self, PyObject *args, PyObject *kwargs) {
+    static const char *keywords[] = {"query", "copy", nullptr};
+    const char *text;
+    Py_ssize_t length;
+    int copy = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s#|$p:match", const_cast<char **>(keywords),
+                                     &text, &length, &copy)) {
+        return nullptr;
+    }
+    uint32_t error_offset = 0;
+    std::optional<PathQuery> query =
+        PathQuery::compile(std::string_view(text, static_cast<size_t>(length)), &error_offset);
+    if (!query) {
+        PyErr_Format(PyExc_ValueError, "invalid path query at offset %u", error_offset);
+        return nullptr;
+    }
+    PyObject *type = path_match_type(self);
+    if (!type) return nullptr;
+
+    TreeObject *tree = as_tree(self);
+    std::string_view source = source_of(tree);
+    PyObject *matches = PyList_New(0);
+    PathMatcher matcher(*query);
+    matcher.run(ts_tree_root_node(tree->tree), source, [&](TSNode entry) {
+        if (!matches) return;
+        PyObject *item = PyStructSequence_New(reinterpret_cast<PyTypeObject *>(type));
+        if (!item) {
+            Py_CLEAR(matches);
+            return;
+        }
+        std::string_view key = entry_key(entry, source);
+        TSNode value = entry_value(entry);
+        TSPoint point = ts_node_start_point(entry);
+        PyObject *fields[] = {
+            PyUnicode_DecodeUTF8(key.data(), static_cast<Py_ssize_t>(key.size()), "replace"),
+            ts_node_is_null(value)
+                ? (Py_INCREF(Py_None), Py_None)
+                : text_of(self, ts_node_start_byte(value), ts_node_end_byte(value), copy),
+            PyLong_FromUnsignedLong(ts_node_start_byte(entry)),
+            PyLong_FromUnsignedLong(ts_node_end_byte(entry)),
+            PyLong_FromUnsignedLong(point.row),
+            PyLong_FromUnsignedLong(point.column),
+        };
+        bool failed = false;
+        for (Py_ssize_t i = 0; i < 6; i++) {
+            if (!fields[i]) {
+                failed = true;
+                Py_INCREF(Py_None);
+                fields[i] = Py_None;
+            }
+            PyStructSequence_SetItem(item, i, fields[i]);
+        }
+        if (failed || PyList_Append(matches, item) < 0) Py_CLEAR(matches);
+        Py_DECREF(item);
+    });
+    Py_DECREF(type);
+    return matches;
+}
+
+// The Python value of an assignment's `value` node: int for whole number
+// literals, float for the rest, str for everything else. With |evaluate|,
+// arithmetic (`2 * 50%`) is computed as a float where it has no references.
+PyObject *scalar(std::string_view source, TSNode value, bool evaluate) {
+    if (ts_node_is_null(value)) Py_RETURN_NONE;
+    const Symbols &symbols = Symbols::get();
+    TSNode literal = ts_node_named_child(value, 0);
+    if (ts_node_is_null(literal)) literal = value;
+    TSSymbol symbol = ts_node_symbol(literal);
+    std::string_view text = node_text(literal, source);
+
+    double number;
+    unsigned suffix;
+    if (symbol == symbols.number && parse_number(text, &number, &suffix)) {
+        if (!(suffix & kSuffixPercent) && text.find('.') == std::string_view::npos &&
+            std::fabs(number) <= 9007199254740992.0) {
+            return PyLong_FromLongLong(static_cast<long long>(number));
+        }
+        return PyFloat_FromDouble(number);
+    }
+    if (evaluate &&
+        (symbol == symbols.binary_expression || symbol == symbols.urinary_expression ||
+         symbol == symbols.parenthesized_expression) &&
+        evaluate_expression(literal, source, &number)) {
+        return PyFloat_FromDouble(number);
+    }
+    text = unquote(text);
+    if (symbol != symbols.string || text.find("\\\"") == std::string_view::npos) {
+        return PyUnicode_DecodeUTF8(text.data(), static_cast<Py_ssize_t>(text.size()), "replace");
+    }
+    std::string unescaped;
+    unescaped.reserve(text.size());
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '\\' && i + 1 < text.size() && text[i + 1] == '"') i++;
+        unescaped.push_back(text[i]);
+    }
+    return PyUnicode_DecodeUTF8(unescaped.data(), static_cast<Py_ssize_t>(unescaped.size()),
+                                "replace");
+}
+
+// The text of an `extension`: its reference, e.g. `Parts/Base`.
+std::string_view extension_text(TSNode extension, std::string_view source) {
+    TSNode reference = ts_node_named_child(extension, 0);
+    return node_text(ts_node_is_null(reference) ? extension : reference, source);
+}
+
+std::string_view index_key(uint32_t index, char (&digits)[16]) {
+    char *end = std::to_chars(digits, digits + sizeof(digits), index).ptr;
+    return std::string_view(digits, static_cast<size_t>(end - digits));
+}
+
+// Converts a tree to dicts and lists in one cursor walk, with the mapping of
+// write_json(): groups become dicts, lists become lists, keyed entries in a
+// list become one-item dicts, unnamed blocks in a group are keyed by their
+// index, and extensions are listed under "$extends". A key that repeats in a
+// group keeps its first position and its last value.
+//
+// Each distinct key is decoded once per conversion and interned, so the
+// thousands of "Cost" keys in a rules file share one str, and lookups with a
+// literal key compare by identity.
+class DictBuilder {
+public:
+    DictBuilder(std::string_view source, bool evaluate)
+        : symbols_(Symbols::get()), source_(source), evaluate_(evaluate) {}
+    ~DictBuilder() {
+        for (auto &entry : keys_) Py_DECREF(entry.second);
+    }
+
+    // |node| is a `source_file`, `group`, `list` or `assignment`.
+    PyObject *convert(TSNode node) {
+        cursor_ = ts_tree_cursor_new(node);
+        PyObject *result = entry();
+        ts_tree_cursor_delete(&cursor_);
+        return result;
+    }
+
+    // A new reference to the interned str for |name|.
+    PyObject *key(std::string_view name) {
+        auto found = keys_.find(name);
+        if (found != keys_.end()) {
+            Py_INCREF(found->second);
+            return found->second;
+        }
+        PyObject *key =
+            PyUnicode_DecodeUTF8(name.data(), static_cast<Py_ssize_t>(name.size()), "replace");
+        if (!key) return nullptr;
+        PyUnicode_InternInPlace(&key);
+        // Index keys are formatted into a stack buffer, so the map keeps a
+        // view of the str's own UTF-8 rather than of |name|.
+        Py_ssize_t size;
+        const char *utf8 = PyUnicode_AsUTF8AndSize(key, &size);
+        if (!utf8) {
+            Py_DECREF(key);
+            return nullptr;
+        }
+        if (keys_.emplace(std::string_view(utf8, static_cast<size_t>(size)), key).second) {
+            Py_INCREF(key); // the map's reference
+        }
+        return key;
+    }
+
+private:
+    const Symbols &symbols_;
+    std::string_view source_;
+    bool evaluate_;
+    TSTreeCursor cursor_;
+    std::unordered_map<std::string_view, PyObject *> keys_;
+
+    // The cursor is on a `source_file`, `assignment`, `group` or `list`.
+    PyObject *entry() {
+        TSNode node = ts_tree_cursor_current_node(&cursor_);
+        TSSymbol symbol = ts_node_symbol(node);
+        if (symbol == symbols_.assignment) return scalar(source_, entry_value(node), evaluate_);
+        if (symbol == symbols_.source_file || symbol == symbols_.group) return block(true);
+        if (symbol == symbols_.list) return block(false);
+        Py_RETURN_NONE;
+    }
+
+    PyObject *block(bool object) {
+        if (Py_EnterRecursiveCall(" while converting a tree")) return nullptr;
+        PyObject *result = object ? PyDict_New() : PyList_New(0);
+        if (result && ts_tree_cursor_goto_first_child(&cursor_)) {
+            PyObject *extends = nullptr;
+            uint32_t index = 0;
+            do {
+                TSNode child = ts_tree_cursor_current_node(&cursor_);
+                TSSymbol symbol = ts_node_symbol(child);
+                if (symbol == symbols_.extension) {
+                    if (object && !add_extension(result, &extends, child)) Py_CLEAR(result);
+                    continue;
+                }
+                if (!is_entry(symbols_, symbol)) continue;
+                if (!add_entry(result, object, child, index++)) Py_CLEAR(result);
+            } while (result && ts_tree_cursor_goto_next_sibling(&cursor_));
+            ts_tree_cursor_goto_parent(&cursor_);
+        }
+        Py_LeaveRecursiveCall();
+        return result;
+    }
+
+    bool add_extension(PyObject *dict, PyObject **extends, TSNode extension) {
+        if (!*extends) {
+            PyObject *name = key("$extends");
+            *extends = name ? PyList_New(0) : nullptr;
+            int set = *extends ? PyDict_SetItem(dict, name, *extends) : -1;
+            Py_XDECREF(name);
+            if (*extends) Py_DECREF(*extends); // |dict| holds it
+            if (set < 0) return false;
+        }
+        std::string_view text = extension_text(extension, source_);
+        PyObject *item =
+            PyUnicode_DecodeUTF8(text.data(), static_cast<Py_ssize_t>(text.size()), "replace");
+        int appended = item ? PyList_Append(*extends, item) : -1;
+        Py_XDECREF(item);
+        return appended == 0;
+    }
+
+    bool add_entry(PyObject *result, bool object, TSNode child, uint32_t index) {
+        std::string_view name = entry_key(child, source_);
+        char digits[16];
+        if (object && name.empty()) name = index_key(index, digits);
+        PyObject *name_object = name.empty() ? nullptr : key(name);
+        if (!name.empty() && !name_object) return false;
+        PyObject *value = entry();
+        if (!value) {
+            Py_XDECREF(name_object);
+            return false;
+        }
+        int status;
+        if (object) {
+            status = PyDict_SetItem(result, name_object, value);
+        } else if (name_object) {
+            PyObject *item = PyDict_New();
+            status = item ? PyDict_SetItem(item, name_object, value) : -1;
+            if (status == 0) status = PyList_Append(result, item);
+            Py_XDECREF(item);
+        } else {
+            status = PyList_Append(result, value);
+        }
+        Py_XDECREF(name_object);
+        Py_DECREF(value);
+        return status == 0;
+    }
+};
+
+// to_dict(*, evaluate=False) on a Tree or a view.
+PyObject *to_dict(std::string_view source, TSNode node, PyObject *args, PyObject *kwargs,
+                  const char *name, bool evaluate) {
+    static const char *keywords[] = {"evaluate", nullptr};
+    int evaluate_flag = evaluate;
+    std::string format = std::string("|$p:") + name;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, format.c_str(), const_cast<char **>(keywords),
+                                     &evaluate_flag)) {
+        return nullptr;
+    }
+    return DictBuilder(source, evaluate_flag).convert(node);
+}
+
+PyObject *tree_to_dict(PyObject *self, PyObject *args, PyObject *kwargs) {
+    TreeObject *tree = as_tree(self);
+    return to_dict(source_of(tree), ts_tree_root_node(tree->tree), args, kwargs, "to_dict", false);
+}
+
+// A lazy view of a group or a list. Nothing below |node| is converted until
+// it is indexed: view["Parts"]["Thruster"]["Cost"] scans the entries of
+// three blocks and converts one value, where to_dict() converts the whole
+// document. The view keeps the tree, and with it the source, alive.
+struct ViewObject {
+    PyObject_HEAD
+    PyObject *tree;
+    TSNode node;
+    bool evaluate;
+};
+
+ViewObject *as_view(PyObject *self) {
+    return reinterpret_cast<ViewObject *>(self);
+}
+
+std::string_view source_of(const ViewObject *view) {
+    return source_of(as_tree(view->tree));
+}
+
+void view_dealloc(PyObject *self) {
+    PyTypeObject *type = Py_TYPE(self);
+    Py_XDECREF(as_view(self)->tree);
+    reinterpret_cast<freefunc>(PyType_GetSlot(type, Py_tp_free))(self);
+    Py_DECREF(type);
+}
+
+// A new GroupView or ListView, found on |module_owner|'s module.
+PyObject *new_view(PyObject *module_owner, const char *type_name, PyObject *tree, TSNode node,
+                   bool evaluate) {
+    PyObject *module = PyType_GetModule(Py_TYPE(module_owner));
+    PyObject *type = module ? PyObject_GetAttrString(module, type_name) : nullptr;
+    if (!type) return nullptr;
+    auto alloc = reinterpret_cast<allocfunc>(
+        PyType_GetSlot(reinterpret_cast<PyTypeObject *>(type), Py_tp_alloc));
+    PyObject *self = alloc(reinterpret_cast<PyTypeObject *>(type), 0);
+    Py_DECREF(type);
+    if (!self) return nullptr;
+    ViewObject *view = as_view(self);
+    Py_INCREF(tree);
+    view->tree = tree;
+    view->node = node;
+    view->evaluate = evaluate;
+    return self;
+}
+
+// The value of |entry| inside |view|: a scalar for an assignment, a view
+// for a group or a list.
+PyObject *view_value(PyObject *self, TSNode entry) {
+    ViewObject *view = as_view(self);
+    const Symbols &symbols = Symbols::get();
+    TSSymbol symbol = ts_node_symbol(entry);
+    if (symbol == symbols.assignment) {
+        return scalar(source_of(view), entry_value(entry), view->evaluate);
+    }
+    return new_view(self, symbol == symbols.list ? "ListView" : "GroupView", view->tree, entry,
+                    view->evaluate);
+}
+
+// Calls |visit(child, index)| for each entry directly under |node|, with
+// |index| counting entries, and |extension(child)| for its extensions.
+// Either may return false to stop.
+template <typename Visit, typename Extension>
+void for_each_entry(TSNode node, Visit visit, Extension extension) {
+    const Symbols &symbols = Symbols::get();
+    TSTreeCursor cursor = ts_tree_cursor_new(node);
+    if (ts_tree_cursor_goto_first_child(&cursor)) {
+        uint32_t index = 0;
+        do {
+            TSNode child = ts_tree_cursor_current_node(&cursor);
+            TSSymbol symbol = ts_node_symbol(child);
+            if (symbol == symbols.extension) {
+                if (!extension(child)) break;
+            } else if (is_entry(symbols, symbol) && !visit(child, index++)) {
+                break;
+            }
+        } while (ts_tree_cursor_goto_next_sibling(&cursor));
+    }
+    ts_tree_cursor_delete(&cursor);
+}
+
+template <typename Visit>
+void for_each_entry(TSNode node, Visit visit) {
+    for_each_entry(node, visit, [](TSNode) { return true; });
+}
+
+// The extensions of |node| as a list of str.
+PyObject *extension_list(const ViewObject *view) {
+    std::string_view source = source_of(view);
+    PyObject *list = PyList_New(0);
+    for_each_entry(
+        view->node, [](TSNode, uint32_t) { return true; },
+        [&](TSNode extension) {
+            std::string_view text = extension_text(extension, source);
+            PyObject *item =
+                PyUnicode_DecodeUTF8(text.data(), static_cast<Py_ssize_t>(text.size()), "replace");
+            if (!item || PyList_Append(list, item) < 0) Py_CLEAR(list);
+            Py_XDECREF(item);
+            return list != nullptr;
+        });
+    return list;
+}
+
+bool has_extensions(TSNode node) {
+    bool found = false;
+    for_each_entry(
+        node, [](TSNode, uint32_t) { return true; },
+        [&](TSNode) { return !(found = true); });
+    return found;
+}
+
+// The entry of a group stored under |name|, as to_dict() keys it; the last
+// one wins when a key repeats.
+TSNode group_lookup(const ViewObject *view, std::string_view name) {
+    std::string_view source = source_of(view);
+    TSNode found = {};
+    for_each_entry(view->node, [&](TSNode child, uint32_t index) {
+        std::string_view key = entry_key(child, source);
+        char digits[16];
+        if (key.empty()) key = index_key(index, digits);
+        if (key == name) found = child;
+        return true;
+    });
+    return found;
+}
+
+// Looks |key| up in a GroupView. Returns 1 and sets |*value| when found,
+// 0 when missing and -1 on error.
+int group_get(PyObject *self, PyObject *key, PyObject **value) {
+    if (!PyUnicode_Check(key)) return 0;
+    Py_ssize_t size;
+    const char *utf8 = PyUnicode_AsUTF8AndSize(key, &size);
+    if (!utf8) return -1;
+    std::string_view name(utf8, static_cast<size_t>(size));
+    ViewObject *view = as_view(self);
+    if (name == "$extends") {
+        if (!has_extensions(view->node)) return 0;
+        *value = extension_list(view);
+        return *value ? 1 : -1;
+    }
+    TSNode entry = group_lookup(view, name);
+    if (ts_node_is_null(entry)) return 0;
+    *value = view_value(self, entry);
+    return *value ? 1 : -1;
+}
+
+PyObject *group_subscript(PyObject *self, PyObject *key) {
+    PyObject *value = nullptr;
+    int found = group_get(self, key, &value);
+    if (found == 0) PyErr_SetObject(PyExc_KeyError, key);
+    return value;
+}
+
+int group_contains(PyObject *self, PyObject *key) {
+    PyObject *value = nullptr;
+    int found = group_get(self, key, &value);
+    Py_XDECREF(value);
+    return found;
+}
+
+// The keys of a GroupView in to_dict() order, without repeats.
+PyObject *group_keys(PyObject *self, PyObject *) {
+    ViewObject *view = as_view(self);
+    std::string_view source = source_of(view);
+    DictBuilder builder(source, false);
+    PyObject *seen = PyDict_New();
+    PyObject *keys = seen ? PyList_New(0) : nullptr;
+    auto add = [&](std::string_view name) {
+        PyObject *key = builder.key(name);
+        int present = key ? PyDict_Contains(seen, key) : -1;
+        if (present == 0) {
+            present = PyDict_SetItem(seen, key, Py_None) == 0 && PyList_Append(keys, key) == 0
+                          ? 1
+                          : -1;
+        }
+        Py_XDECREF(key);
+        if (present < 0) Py_CLEAR(keys);
+        return keys != nullptr;
+    };
+    bool extends = false;
+    if (keys) {
+        for_each_entry(
+            view->node,
+            [&](TSNode child, uint32_t index) {
+                std::string_view name = entry_key(child, source);
+                char digits[16];
+                return add(name.empty() ? index_key(index, digits) : name);
+            },
+            [&](TSNode) { return extends || (extends = add("$extends")); });
+    }
+    Py_XDECREF(seen);
+    return keys;
+}
+
+Py_ssize_t group_length(PyObject *self) {
+    PyObject *keys = group_keys(self, nullptr);
+    if (!keys) return -1;
+    Py_ssize_t length = PyList_Size(keys);
+    Py_DECREF(keys);
+    return length;
+}
+
+PyObject *group_iter(PyObject *self) {
+    PyObject *keys = group_keys(self, nullptr);
+    if (!keys) return nullptr;
+    PyObject *iterator = PyObject_GetIter(keys);
+    Py_DECREF(keys);
+    return iterator;
+}
+
+// values() and items(): one value per key, converted lazily as views.
+PyObject *group_collect(PyObject *self, bool items) {
+    PyObject *keys = group_keys(self, nullptr);
+    if (!keys) return nullptr;
+    Py_ssize_t count = PyList_Size(keys);
+    PyObject *result = PyList_New(count);
+    for (Py_ssize_t i = 0; result && i < count; i++) {
+        PyObject *key = PyList_GetItem(keys, i);
+        PyObject *value = group_subscript(self, key);
+        PyObject *item = value && items ? PyTuple_Pack(2, key, value) : value;
+        if (items) Py_XDECREF(value);
+        if (!item) {
+            Py_CLEAR(result);
+            break;
+        }
+        PyList_SetItem(result, i, item);
+    }
+    Py_DECREF(keys);
+    return result;
+}
+
+PyObject *group_values(PyObject *self, PyObject *) {
+    return group_collect(self, false);
+}
+
+PyObject *group_items(PyObject *self, PyObject *) {
+    return group_collect(self, true);
+}
+
+PyObject *group_get_method(PyObject *self, PyObject *args) {
+    PyObject *key;
+    PyObject *fallback = Py_None;
+    if (!PyArg_ParseTuple(args, "O|O:get", &key, &fallback)) return nullptr;
+    PyObject *value = nullptr;
+    int found = group_get(self, key, &value);
+    if (found < 0) return nullptr;
+    if (found == 0) {
+        Py_INCREF(fallback);
+        return fallback;
+    }
+    return value;
+}
+
+PyObject *view_to_python(PyObject *self, PyObject *args, PyObject *kwargs) {
+    ViewObject *view = as_view(self);
+    bool list = ts_node_symbol(view->node) == Symbols::get().list;
+    return to_dict(source_of(view), view->node, args, kwargs, list ? "to_list" : "to_dict",
+                   view->evaluate);
+}
+
+PyObject *view_repr(PyObject *self) {
+    ViewObject *view = as_view(self);
+    std::string_view key = entry_key(view->node, source_of(view));
+    PyObject *type_name = PyType_GetName(Py_TYPE(self));
+    if (!type_name) return nullptr;
+    PyObject *name =
+        PyUnicode_DecodeUTF8(key.data(), static_cast<Py_ssize_t>(key.size()), "replace");
+    PyObject *repr = name ? PyUnicode_FromFormat("<%U %R at byte %u>", type_name, name,
+                                                 ts_node_start_byte(view->node))
+                          : nullptr;
+    Py_XDECREF(name);
+    Py_DECREF(type_name);
+    return repr;
+}
+
+// The entry at |index| of a ListView.
+PyObject *list_item(PyObject *self, Py_ssize_t index) {
+    ViewObject *view = as_view(self);
+    TSNode found = {};
+    for_each_entry(view->node, [&](TSNode child, uint32_t position) {
+        if (static_cast<Py_ssize_t>(position) != index) return true;
+        found = child;
+        return false;
+    });
+    if (index < 0 || ts_node_is_null(found)) {
+        PyErr_SetString(PyExc_IndexError, "list index out of range");
+        return nullptr;
+    }
+    PyObject *value = view_value(self, found);
+    std::string_view name = entry_key(found, source_of(view));
+    if (!value || name.empty()) return value;
+    PyObject *item = PyDict_New();
+    PyObject *key =
+        item ? PyUnicode_DecodeUTF8(name.data(), static_cast<Py_ssize_t>(name.size()), "replace")
+             : nullptr;
+    if (!key || PyDict_SetItem(item, key, value) < 0) Py_CLEAR(item);
+    Py_XDECREF(key);
+    Py_DECREF(value);
+    return item;
+}
+
+Py_ssize_t list_length(PyObject *self) {
+    Py_ssize_t length = 0;
+    for_each_entry(as_view(self)->node, [&](TSNode, uint32_t) {
+        length++;
+        return true;
+    });
+    return length;
+}
+
+PyObject *view_get_tree(PyObject *self, void *) {
+    PyObject *tree = as_view(self)->tree;
+    Py_INCREF(tree);
+    return tree;
+}
+
+PyObject *view_get_start_byte(PyObject *self, void *) {
+    return PyLong_FromUnsignedLong(ts_node_start_byte(as_view(self)->node));
+}
+
+PyObject *view_get_end_byte(PyObject *self, void *) {
+    return PyLong_FromUnsignedLong(ts_node_end_byte(as_view(self)->node));
+}
+
+PyGetSetDef view_getset[] = {
+    {"tree", view_get_tree, nullptr, "The Tree this view reads from.", nullptr},
+    {"start_byte", view_get_start_byte, nullptr, nullptr, nullptr},
+    {"end_byte", view_get_end_byte, nullptr, nullptr, nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+PyMethodDef group_methods[] = {
+    {"keys", group_keys, METH_NOARGS, "The keys, in to_dict() order, as a list."},
+    {"values", group_values, METH_NOARGS, "The values as a list; blocks stay views."},
+    {"items", group_items, METH_NOARGS, "(key, value) pairs as a list; blocks stay views."},
+    {"get", group_get_method, METH_VARARGS, "get(key, default=None)"},
+    {"to_dict", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(view_to_python)),
+     METH_VARARGS | METH_KEYWORDS,
+     "to_dict(*, evaluate=...)\n--\n\n"
+     "Convert the whole group, as Tree.to_dict() does. evaluate defaults to\n"
+     "the value given to Tree.view()."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyType_Slot group_slots[] = {
+    {Py_tp_dealloc, reinterpret_cast<void *>(view_dealloc)},
+    {Py_tp_repr, reinterpret_cast<void *>(view_repr)},
+    {Py_tp_iter, reinterpret_cast<void *>(group_iter)},
+    {Py_tp_methods, group_methods},
+    {Py_tp_getset, view_getset},
+    {Py_mp_subscript, reinterpret_cast<void *>(group_subscript)},
+    {Py_mp_length, reinterpret_cast<void *>(group_length)},
+    {Py_sq_contains, reinterpret_cast<void *>(group_contains)},
+    {Py_tp_doc, const_cast<char *>("A read-only mapping over a group that converts entries as "
+                                   "they are looked up.")},
+    {0, nullptr},
+};
+
+PyType_Spec group_spec = {
+    "tree_sitter_objecttext.GroupView",
+    sizeof(ViewObject),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    group_slots,
+};
+
+PyMethodDef list_methods[] = {
+    {"to_list", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(view_to_python)),
+     METH_VARARGS | METH_KEYWORDS,
+     "to_list(*, evaluate=...)\n--\n\n"
+     "Convert the whole list, as Tree.to_dict() does. evaluate defaults to\n"
+     "the value given to Tree.view()."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyType_Slot list_slots[] = {
+    {Py_tp_dealloc, reinterpret_cast<void *>(view_dealloc)},
+    {Py_tp_repr, reinterpret_cast<void *>(view_repr)},
+    {Py_tp_methods, list_methods},
+    {Py_tp_getset, view_getset},
+    {Py_sq_item, reinterpret_cast<void *>(list_item)},
+    {Py_sq_length, reinterpret_cast<void *>(list_length)},
+    {Py_tp_doc, const_cast<char *>("A read-only sequence over a list that converts items as they "
+                                   "are indexed.")},
+    {0, nullptr},
+};
+
+PyType_Spec list_spec = {
+    "tree_sitter_objecttext.ListView",
+    sizeof(ViewObject),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    list_slots,
+};
+
+// view(*, evaluate=False) -> GroupView over the whole document.
+PyObject *tree_view(PyObject *self, PyObject *args, PyObject *kwargs) {
+    static const char *keywords[] = {"evaluate", nullptr};
+    int evaluate = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|$p:view", const_cast<char **>(keywords),
+                                     &evaluate)) {
+        return nullptr;
+    }
+    return new_view(self, "GroupView", self, ts_tree_root_node(as_tree(self)->tree), evaluate);
+}
+
+PyObject *tree_get_source(PyObject *self, void *) {
+    return PyMemoryView_FromObject(self);
+}
+
+PyObject *tree_get_has_error(PyObject *self, void *) {
+    return PyBool_FromLong(ts_node_has_error(ts_tree_root_node(as_tree(self)->tree)));
+}
+
+PyObject *tree_get_root_key(PyObject *self, void *) {
+    TreeObject *tree = as_tree(self);
+    std::string_view source = source_of(tree);
+    TSNode root = ts_tree_root_node(tree->tree);
+    const Symbols &symbols = Symbols::get();
+    uint32_t count = ts_node_child_count(root);
+    for (uint32_t i = 0; i < count; i++) {
+        TSNode child = ts_node_child(root, i);
+        if (!is_entry(symbols, ts_node_symbol(child))) continue;
+        std::string_view key = entry_key(child, source);
+        return PyUnicode_DecodeUTF8(key.data(), static_cast<Py_ssize_t>(key.size()), "replace");
+    }
+    Py_RETURN_NONE;
+}
+
+PyMethodDef tree_methods[] = {
+    {"text", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(tree_text)),
+     METH_VARARGS | METH_KEYWORDS,
+     "text(node, *, copy=False) or text(start_byte, end_byte, *, copy=False)\n--\n\n"
+     "The source bytes of a node (anything with start_byte and end_byte) or\n"
+     "of a byte range, as a read-only memoryview into the parsed buffer, or\n"
+     "as bytes with copy=True."},
+    {"match", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(tree_match)),
+     METH_VARARGS | METH_KEYWORDS,
+     "match(query, *, copy=False)\n--\n\n"
+     "Run a path query such as 'Parts/*/Cost[> 100]' and return a PathMatch\n"
+     "for each entry it reaches. Values are memoryview slices unless\n"
+     "copy=True."},
+    {"to_dict", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(tree_to_dict)),
+     METH_VARARGS | METH_KEYWORDS,
+     "to_dict(*, evaluate=False)\n--\n\n"
+     "Convert the document to dicts, lists and scalars in one pass. Whole\n"
+     "numbers become int and other numbers float; with evaluate=True,\n"
+     "arithmetic without references becomes a float as well."},
+    {"view", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(tree_view)),
+     METH_VARARGS | METH_KEYWORDS,
+     "view(*, evaluate=False)\n--\n\n"
+     "A GroupView of the document that converts only the entries that are\n"
+     "looked up, with the same mapping as to_dict()."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyGetSetDef tree_getset[] = {
+    {"source", tree_get_source, nullptr, "The parsed buffer, as a read-only memoryview.", nullptr},
+    {"has_error", tree_get_has_error, nullptr, "Whether the tree has ERROR or MISSING nodes.",
+     nullptr},
+    {"root_key", tree_get_root_key, nullptr, "Key of the top-level entry, or None.", nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+PyType_Slot tree_slots[] = {
+    {Py_tp_dealloc, reinterpret_cast<void *>(tree_dealloc)},
+    {Py_tp_methods, tree_methods},
+    {Py_tp_getset, tree_getset},
+    {Py_bf_getbuffer, reinterpret_cast<void *>(tree_getbuffer)},
+    {Py_tp_doc, const_cast<char *>("A syntax tree that keeps the buffer it was parsed from.")},
+    {0, nullptr},
+};
+
+PyType_Spec tree_spec = {
+    "tree_sitter_objecttext.Tree",
+    sizeof(TreeObject),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    tree_slots,
+};
+
+PyStructSequence_Field match_fields[] = {
+    {"key", "key of the entry, empty for unnamed blocks"},
+    {"value", "source of an assignment's value, None for groups and lists"},
+    {"start_byte", nullptr},
+    {"end_byte", nullptr},
+    {"row", nullptr},
+    {"column", nullptr},
+    {nullptr, nullptr},
+};
+
+PyStructSequence_Desc match_desc = {
+    "tree_sitter_objecttext.PathMatch",
+    "An entry reached by Tree.match().",
+    match_fields,
+    6,
+};
+
+// Pins |object|'s buffer in |view|. str is encoded as UTF-8 first.
+bool get_source(PyObject *object, Py_buffer *view) {
+    if (PyUnicode_Check(object)) {
+        PyObject *encoded = PyUnicode_AsUTF8String(object);
+        if (!encoded) return false;
+        int result = PyObject_GetBuffer(encoded, view, PyBUF_SIMPLE);
+        Py_DECREF(encoded);
+        return result == 0;
+    }
+    return PyObject_GetBuffer(object, view, PyBUF_SIMPLE) == 0;
+}
+
+} // namespace
+
+extern "C" {
+
+// Adds the Tree, GroupView, ListView and PathMatch types to |module|.
+int _binding_init_tree(PyObject *module) {
+    const char *names[] = {"Tree", "GroupView", "ListView"};
+    PyType_Spec *specs[] = {&tree_spec, &group_spec, &list_spec};
+    for (size_t i = 0; i < 3; i++) {
+        PyObject *type = PyType_FromModuleAndSpec(module, specs[i], nullptr);
+        if (!type) return -1;
+        if (PyModule_AddObject(module, names[i], type) < 0) {
+            Py_DECREF(type);
+            return -1;
+        }
+    }
+    PyTypeObject *match_type = PyStructSequence_NewType(&match_desc);
+    if (!match_type) return -1;
+    if (PyModule_AddObject(module, "PathMatch", reinterpret_cast<PyObject *>(match_type)) < 0) {
+        Py_DECREF(match_type);
+        return -1;
+    }
+    return 0;
+}
+
+PyObject *_binding_parse(PyObject *module, PyObject *source) {
+    Py_buffer view;
+    if (!get_source(source, &view)) return nullptr;
+    if (static_cast<size_t>(view.len) > UINT32_MAX) {
+        PyBuffer_Release(&view);
+        PyErr_SetString(PyExc_ValueError, "sources are limited to 4 GiB");
+        return nullptr;
+    }
+    PyObject *type = PyObject_GetAttrString(module, "Tree");
+    if (!type) {
+        PyBuffer_Release(&view);
+        return nullptr;
+    }
+    auto alloc = reinterpret_cast<allocfunc>(
+        PyType_GetSlot(reinterpret_cast<PyTypeObject *>(type), Py_tp_alloc));
+    PyObject *self = alloc(reinterpret_cast<PyTypeObject *>(type), 0);
+    Py_DECREF(type);
+    if (!self) {
+        PyBuffer_Release(&view);
+        return nullptr;
+    }
+    TreeObject *tree = as_tree(self);
+    tree->source = view;
+
+    // The buffer is pinned, so other threads may run while it is parsed.
+    Py_BEGIN_ALLOW_THREADS
+    thread_local Parser parser;
+    tree->tree = parser.parse(source_of(tree)).release();
+    Py_END_ALLOW_THREADS
+    return self;
+}
+
+} // extern "C"
@@ -0,0 +1,312 @@
+//! The serde Deserializer against a walk into owned values.
+//!
+//! Usage: cargo bench --features serde --bench deserialize --
+//!            <corpus directory> [--megabytes M] [--repeat R]
+//!
+//! Reads files from a corpus written by objecttext-corpus until `M` MB
+//! (default 50) are loaded, e.g. after
+//!
+//!   objecttext-corpus /tmp/corpus --files 100 --kilobytes 512 --kind rules
+//!
+//! and deserializes every file into a `Document` that borrows its text,
+//! keeping the best of `R` rounds: a parse alone, as a floor; that parse
+//! plus the two-step path, a cursor walk into an owned `serde_json::Value`
+//! that is then deserialized; and that parse plus `de::from_tree`, which
+//! reads the tree directly.
+
+use std::borrow::Cow;
+use std::fmt;
+use std::hint::black_box;
+use std::path::PathBuf;
+use std::time::{Duration, Instant};
+
+use serde::de::{self, Deserialize, Deserializer, MapAccess, SeqAccess, Visitor};
+use serde_json::{Map, Value};
+use tree_sitter::{Node, Parser, Tree, TreeCursor};
+use tree_sitter_objecttext::de::from_tree;
+
+// Whatever a document holds, with text borrowed where the deserializer
+// allows it.
+#[derive(Debug, PartialEq)]
+enum Document<'a> {
+    Integer(i64),
+    Float(f64),
+    Bool(bool),
+    Text(Cow<'a, str>),
+    List(Vec<Document<'a>>),
+    Map(Vec<(Cow<'a, str>, Document<'a>)>),
+}
+
+impl<'de> Deserialize<'de> for Document<'de> {
+    fn deserialize<D: Deserializer<'de>>(deserializer: D) -> Result<Self, D::Error> {
+        deserializer.deserialize_any(DocumentVisitor)
+    }
+}
+
+struct DocumentVisitor;
+
+impl<'de> Visitor<'de> for DocumentVisitor {
+    type Value = Document<'de>;
+
+    fn expecting(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.write_str("an Object Text value")
+    }
+
+    fn visit_bool<E>(self, value: bool) -> Result<Self::Value, E> {
+        Ok(Document::Bool(value))
+    }
+
+    fn visit_i64<E>(self, value: i64) -> Result<Self::Value, E> {
+        Ok(Document::Integer(value))
+    }
+
+    fn visit_u64<E: de::Error>(self, value: u64) -> Result<Self::Value, E> {
+        i64::try_from(value).map(Document::Integer).map_err(E::custom)
+    }
+
+    fn visit_f64<E>(self, value: f64) -> Result<Self::Value, E> {
+        Ok(Document::Float(value))
+    }
+
+    fn visit_borrowed_str<E>(self, value: &'de str) -> Result<Self::Value, E> {
+        Ok(Document::Text(Cow::Borrowed(value)))
+    }
+
+    fn visit_str<E>(self, value: &str) -> Result<Self::Value, E> {
+        Ok(Document::Text(Cow::Owned(value.to_owned())))
+    }
+
+    fn visit_seq<A: SeqAccess<'de>>(self, mut seq: A) -> Result<Self::Value, A::Error> {
+        let mut items = Vec::new();
+        while let Some(item) = seq.next_element()? {
+            items.push(item);
+        }
+        Ok(Document::List(items))
+    }
+
+    fn visit_map<A: MapAccess<'de>>(self, mut map: A) -> Result<Self::Value, A::Error> {
+        let mut entries = Vec::new();
+        while let Some(entry) = map.next_entry::<Cow<'de, str>, _>()? {
+            entries.push(entry);
+        }
+        Ok(Document::Map(entries))
+    }
+}
+
+// The two-step path: the tree as owned JSON values, keyed the way
+// de::from_tree keys them.
+fn to_value(cursor: &mut TreeCursor, source: &str) -> Value {
+    let node = cursor.node();
+    if node.kind() == "assignment" {
+        let value = (0..node.child_count())
+            .filter_map(|i| node.child(i))
+            .find(|child| child.kind() == "value");
+        return value.map_or(Value::Null, |value| scalar(value, source));
+    }
+    let object = node.kind() != "list";
+    let mut map = Map::new();
+    let mut list = Vec::new();
+    let mut extensions = Vec::new();
+    if cursor.goto_first_child() {
+        let mut index = 0;
+        loop {
+            let child = cursor.node();
+            match child.kind() {
+                "extension" => {
+                    let reference = child.named_child(0).unwrap_or(child);
+                    extensions.push(Value::String(source[reference.byte_range()].to_owned()));
+                }
+                "assignment" | "group" | "list" => {
+                    let key = match child.child(0) {
+                        Some(first) if first.kind() == "identifier" => &source[first.byte_range()],
+                        _ => "",
+                    };
+                    let value = to_value(cursor, source);
+                    if object {
+                        let key = if key.is_empty() { index.to_string() } else { key.to_owned() };
+                        map.insert(key, value);
+                    } else if key.is_empty() {
+                        list.push(value);
+                    } else {
+                        list.push(Value::Object(Map::from_iter([(key.to_owned(), value)])));
+                    }
+                    index += 1;
+                }
+                _ => {}
+            }
+            if !cursor.goto_next_sibling() {
+                break;
+            }
+        }
+        cursor.goto_parent();
+    }
+    if !object {
+        return Value::Array(list);
+    }
+    if !extensions.is_empty() {
+        map.insert("$extends".to_owned(), Value::Array(extensions));
+    }
+    Value::Object(map)
+}
+
+fn scalar(value: Node, source: &str) -> Value {
+    let literal = value.named_child(0).unwrap_or(value);
+    let text = &source[literal.byte_range()];
+    match literal.kind() {
+        "number" => {
+            let text = text.strip_suffix('d').unwrap_or(text);
+            if let Some(digits) = text.strip_suffix('%') {
+                return digits.parse::<f64>().map_or(Value::Null, |v| (v / 100.0).into());
+            }
+            match text.parse::<i64>() {
+                Ok(integer) => integer.into(),
+                Err(_) => text.parse::<f64>().map_or(Value::Null, Value::from),
+            }
+        }
+        "string" => Value::String(text[1..text.len() - 1].replace("\\\"", "\"")),
+        "verbatim" => Value::String(text[2..text.len() - 1].to_owned()),
+        _ => Value::String(text.trim().to_owned()),
+    }
+}
+
+fn two_step(tree: &Tree, source: &str) -> usize {
+    let value = to_value(&mut tree.root_node().walk(), source);
+    let document = Document::deserialize(&value).expect("deserialize");
+    count(&document)
+}
+
+fn direct(tree: &Tree, source: &str) -> usize {
+    let document: Document = from_tree(tree, source).expect("deserialize");
+    count(&document)
+}
+
+// serde_json::Map sorts its keys; de::from_tree keeps the source order.
+fn sort(document: &mut Document) {
+    match document {
+        Document::List(items) => items.iter_mut().for_each(sort),
+        Document::Map(entries) => {
+            entries.sort_by(|a, b| a.0.cmp(&b.0));
+            entries.iter_mut().for_each(|(_, value)| sort(value));
+        }
+        _ => {}
+    }
+}
+
+// Entries in a document, so neither path can be optimized away.
+fn count(document: &Document) -> usize {
+    match document {
+        Document::List(items) => items.iter().map(count).sum::<usize>() + 1,
+        Document::Map(entries) => entries.iter().map(|(_, value)| count(value)).sum::<usize>() + 1,
+        _ => 1,
+    }
+}
+
+struct Options {
+    directory: PathBuf,
+    megabytes: f64,
+    repeat: usize,
+}
+
+fn parse_args() -> Options {
+    let mut directory = None;
+    let mut megabytes = 50.0;
+    let mut repeat = 3;
+    let mut args = std::env::args().skip(1);
+    while let Some(arg) = args.next() {
+        match arg.as_str() {
+            "--megabytes" => megabytes = args.next().and_then(|v| v.parse().ok()).unwrap_or(megabytes),
+            "--repeat" => repeat = args.next().and_then(|v| v.parse().ok()).unwrap_or(repeat).max(1),
+            // Passed by `cargo bench` itself.
+            "--bench" => {}
+            _ if !arg.starts_with('-') && directory.is_none() => directory = Some(PathBuf::from(arg)),
+            _ => panic!("unknown argument {arg}"),
+        }
+    }
+    let Some(directory) = directory else {
+        eprintln!("usage: deserialize <corpus directory> [--megabytes M] [--repeat R]");
+        std::process::exit(2);
+    };
+    Options {
+        directory,
+        megabytes,
+        repeat,
+    }
+}
+
+fn best(repeat: usize, mut run: impl FnMut()) -> Duration {
+    (0..repeat)
+        .map(|_| {
+            let start = Instant::now();
+            run();
+            start.elapsed()
+        })
+        .min()
+        .unwrap_or_default()
+}
+
+fn main() {
+    let options = parse_args();
+    let mut names: Vec<_> = std::fs::read_dir(&options.directory)
+        .expect("read corpus directory")
+        .map(|entry| entry.expect("read corpus directory").path())
+        .collect();
+    names.sort();
+    let mut sources = Vec::new();
+    let mut bytes = 0;
+    for name in names {
+        if bytes as f64 >= options.megabytes * 1e6 {
+            break;
+        }
+        let source = std::fs::read_to_string(name).expect("read corpus file");
+        bytes += source.len();
+        sources.push(source);
+    }
+
+    let mut parser = Parser::new();
+    parser
+        .set_language(&tree_sitter_objecttext::LANGUAGE.into())
+        .expect("Error loading Object Text parser");
+    let mut parse = |source: &str| parser.parse(source, None).expect("parse");
+
+    if let Some(source) = sources.first() {
+        let tree = parse(source);
+        let value = to_value(&mut tree.root_node().walk(), source);
+        let mut owned = Document::deserialize(&value).expect("deserialize");
+        let mut borrowed: Document = from_tree(&tree, source).expect("deserialize");
+        sort(&mut owned);
+        sort(&mut borrowed);
+        if owned != borrowed {
+            eprintln!("warning: the two paths disagree on the first file");
+        }
+    }
+
+    let rows = [
+        ("parse only", best(options.repeat, || {
+            sources.iter().for_each(|source| drop(black_box(parse(source))))
+        })),
+        ("walk + from &Value", best(options.repeat, || {
+            sources.iter().for_each(|source| {
+                black_box(two_step(&parse(source), source));
+            })
+        })),
+        ("de::from_tree", best(options.repeat, || {
+            sources.iter().for_each(|source| {
+                black_box(direct(&parse(source), source));
+            })
+        })),
+    ];
+
+    let megabytes = bytes as f64 / 1e6;
+    let two_step_seconds = rows[1].1.as_secs_f64();
+    println!("{} files, {megabytes:.1} MB, best of {}", sources.len(), options.repeat);
+    println!("{:<22} {:>10} {:>8} {:>8}", "method", "ms", "MB/s", "vs walk");
+    for (name, duration) in rows {
+        let seconds = duration.as_secs_f64();
+        println!(
+            "{name:<22} {:>10.1} {:>8.1} {:>7.2}x",
+            seconds * 1e3,
+            megabytes / seconds,
+            two_step_seconds / seconds
+        );
+    }
+}
@@ -0,0 +1,680 @@
+//! Deserialize Object Text with [serde], straight from a syntax tree.
+//!
+//! The [`Deserializer`] walks one [`TreeCursor`] and hands out `&str` slices
+//! of the source, so `&'de str` and `Cow<'de, str>` fields borrow instead of
+//! copying, and nothing is built in between: no owned keys, no DOM.
+//!
+//! Documents map the way `write_json` in the C++ API maps them:
+//!
+//! - the document and groups are maps (or structs), keyed by entry key;
+//! - lists are sequences, and a keyed entry inside a list is a map with a
+//!   single entry;
+//! - unnamed groups and lists inside a group are keyed by their index, as
+//!   path queries address them;
+//! - the extensions of a group (`Thruster : BaseThruster`) are a sequence
+//!   under `"$extends"`;
+//! - numbers are `i64` when written without `.` or `%`, otherwise `f64`
+//!   (`50%` is 0.5, `90d` is 90); strings lose their quotes and `\"`
+//!   escapes; `true` and `false` are booleans when a `bool` is asked for;
+//!   everything else is its trimmed text.
+//!
+//! ```
+//! # use serde::Deserialize;
+//! #[derive(Deserialize)]
+//! #[serde(rename_all = "PascalCase")]
+//! struct Part<'a> {
+//!     name: &'a str,
+//!     cost: u32,
+//! }
+//!
+//! #[derive(Deserialize)]
+//! #[serde(rename_all = "PascalCase")]
+//! struct Document<'a> {
+//!     #[serde(borrow)]
+//!     part: Part<'a>,
+//! }
+//!
+//! let source = "Part\n{\n    Name = Thruster\n    Cost = 150\n}\n";
+//! let document: Document = tree_sitter_objecttext::de::from_str(source).unwrap();
+//! assert_eq!(document.part.name, "Thruster");
+//! assert_eq!(document.part.cost, 150);
+//! ```
+//!
+//! [serde]: https://serde.rs
+
+use std::borrow::Cow;
+use std::fmt;
+use std::sync::OnceLock;
+
+use serde::de::{self, value::BorrowedStrDeserializer, value::SeqDeserializer, IntoDeserializer};
+use serde::forward_to_deserialize_any;
+use tree_sitter::{Node, Point, Tree, TreeCursor};
+
+/// A deserialization or syntax error, with the position of the node that
+/// caused it when one is known.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct Error {
+    message: String,
+    position: Option<Point>,
+}
+
+impl Error {
+    /// The zero-based row and column of the offending node.
+    pub fn position(&self) -> Option<Point> {
+        self.position
+    }
+
+    fn at(mut self, position: Point) -> Self {
+        self.position.get_or_insert(position);
+        self
+    }
+}
+
+impl fmt::Display for Error {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        match self.position {
+            Some(point) => write!(f, "{} at {}:{}", self.message, point.row + 1, point.column + 1),
+            None => f.write_str(&self.message),
+        }
+    }
+}
+
+impl std::error::Error for Error {}
+
+impl de::Error for Error {
+    fn custom<T: fmt::Display>(message: T) -> Self {
+        Error {
+            message: message.to_string(),
+            position: None,
+        }
+    }
+}
+
+pub type Result<T> = std::result::Result<T, Error>;
+
+/// Parses `source` and deserializes the document.
+///
+/// Fails with the position of the first ERROR or MISSING node if the source
+/// does not parse cleanly.
+pub fn from_str<'de, T: de::Deserialize<'de>>(source: &'de str) -> Result<T> {
+    let mut parser = tree_sitter::Parser::new();
+    parser
+        .set_language(&crate::LANGUAGE.into())
+        .map_err(de::Error::custom)?;
+    let tree = parser
+        .parse(source, None)
+        .ok_or_else(|| <Error as de::Error>::custom("the parse was cancelled"))?;
+    from_tree(&tree, source)
+}
+
+/// Deserializes a tree parsed from `source`.
+pub fn from_tree<'de, T: de::Deserialize<'de>>(tree: &Tree, source: &'de str) -> Result<T> {
+    let root = tree.root_node();
+    if root.has_error() {
+        let error: Error = de::Error::custom("syntax error");
+        return Err(error.at(first_error(root).start_position()));
+    }
+    let mut deserializer = Deserializer::new(root, source);
+    T::deserialize(&mut deserializer).map_err(|error| {
+        let position = deserializer.cursor.node().start_position();
+        error.at(position)
+    })
+}
+
+// Follows has_error() down to the first ERROR or MISSING node.
+fn first_error(mut node: Node) -> Node {
+    'descend: while !node.is_error() && !node.is_missing() {
+        let mut cursor = node.walk();
+        for child in node.children(&mut cursor) {
+            if child.has_error() {
+                node = child;
+                continue 'descend;
+            }
+        }
+        break;
+    }
+    node
+}
+
+struct Kinds {
+    source_file: u16,
+    identifier: u16,
+    assignment: u16,
+    group: u16,
+    list: u16,
+    value: u16,
+    string: u16,
+    verbatim: u16,
+    number: u16,
+    extension: u16,
+}
+
+fn kinds() -> &'static Kinds {
+    static KINDS: OnceLock<Kinds> = OnceLock::new();
+    KINDS.get_or_init(|| {
+        let language: tree_sitter::Language = crate::LANGUAGE.into();
+        let id = |name| language.id_for_node_kind(name, true);
+        Kinds {
+            source_file: id("source_file"),
+            identifier: id("identifier"),
+            assignment: id("assignment"),
+            group: id("group"),
+            list: id("list"),
+            value: id("value"),
+            string: id("string"),
+            verbatim: id("verbatim"),
+            number: id("number"),
+            extension: id("extension"),
+        }
+    })
+}
+
+impl Kinds {
+    fn is_entry(&self, kind: u16) -> bool {
+        kind == self.assignment || kind == self.group || kind == self.list
+    }
+}
+
+/// A serde deserializer positioned on a `source_file`, `group`, `list` or
+/// `assignment` node.
+pub struct Deserializer<'de, 'tree> {
+    source: &'de str,
+    cursor: TreeCursor<'tree>,
+    kinds: &'static Kinds,
+}
+
+impl<'de, 'tree> Deserializer<'de, 'tree> {
+    /// A deserializer for `node`, usually a tree's root, parsed from
+    /// `source`.
+    pub fn new(node: Node<'tree>, source: &'de str) -> Self {
+        Deserializer {
+            source,
+            cursor: node.walk(),
+            kinds: kinds(),
+        }
+    }
+
+    fn text(&self, node: Node) -> &'de str {
+        &self.source[node.byte_range()]
+    }
+
+    // The key of the entry under the cursor, or "" for unnamed blocks.
+    fn key(&self, entry: Node) -> &'de str {
+        match entry.child(0) {
+            Some(first) if first.kind_id() == self.kinds.identifier => self.text(first),
+            _ => "",
+        }
+    }
+
+    // The value of the assignment under the cursor.
+    fn scalar(&self) -> Result<Scalar<'de>> {
+        let node = self.cursor.node();
+        if node.kind_id() != self.kinds.assignment {
+            return Err(de::Error::invalid_type(self.unexpected(node), &"a value"));
+        }
+        let value = (0..node.child_count())
+            .rev()
+            .filter_map(|i| node.child(i))
+            .find(|child| child.kind_id() == self.kinds.value);
+        let Some(value) = value else {
+            return Ok(Scalar::Text(Cow::Borrowed("")));
+        };
+        let literal = value.named_child(0).unwrap_or(value);
+        let kind = literal.kind_id();
+        let text = self.text(literal);
+        Ok(if kind == self.kinds.number {
+            Scalar::Number(text)
+        } else if kind == self.kinds.string {
+            let inner = text.get(1..text.len().saturating_sub(1)).unwrap_or("");
+            if inner.contains("\\\"") {
+                Scalar::Text(Cow::Owned(inner.replace("\\\"", "\"")))
+            } else {
+                Scalar::Text(Cow::Borrowed(inner))
+            }
+        } else if kind == self.kinds.verbatim {
+            Scalar::Text(Cow::Borrowed(text.get(2..text.len().saturating_sub(1)).unwrap_or("")))
+        } else {
+            Scalar::Text(Cow::Borrowed(text.trim()))
+        })
+    }
+
+    fn unexpected(&self, node: Node) -> de::Unexpected<'static> {
+        let kind = node.kind_id();
+        if kind == self.kinds.list {
+            de::Unexpected::Seq
+        } else if kind == self.kinds.group || kind == self.kinds.source_file {
+            de::Unexpected::Map
+        } else {
+            de::Unexpected::Other("a value")
+        }
+    }
+
+    fn block<V: de::Visitor<'de>>(&mut self, visitor: V) -> Result<V::Value> {
+        let mut access = Block::new(self);
+        let value = if access.object {
+            visitor.visit_map(&mut access)?
+        } else {
+            visitor.visit_seq(&mut access)?
+        };
+        access.finish();
+        Ok(value)
+    }
+}
+
+// An assignment's value.
+enum Scalar<'de> {
+    Number(&'de str),
+    Text(Cow<'de, str>),
+}
+
+// Parses a `number` literal the way parse_number() in the C++ API does:
+// `%` divides by 100 and `d` is dropped. Whole numbers without `.` or `%`
+// also come back as integers.
+fn parse_number(text: &str) -> Option<(f64, Option<i64>)> {
+    let text = text.strip_suffix('d').unwrap_or(text);
+    let (digits, percent) = match text.strip_suffix('%') {
+        Some(digits) => (digits, true),
+        None => (text, false),
+    };
+    let value: f64 = digits.parse().ok()?;
+    if percent {
+        return Some((value / 100.0, None));
+    }
+    Some((value, digits.parse().ok()))
+}
+
+macro_rules! deserialize_integer {
+    ($($method:ident)*) => {$(
+        // The visitor checks the range of the target type.
+        fn $method<V: de::Visitor<'de>>(self, visitor: V) -> Result<V::Value> {
+            let Scalar::Number(text) = self.scalar()? else {
+                return self.deserialize_any(visitor);
+            };
+            match parse_number(text) {
+                Some((_, Some(integer))) => visitor.visit_i64(integer),
+                Some((value, None)) if value.fract() == 0.0 && value.abs() < 9.007_199_254_740_992e15 => {
+                    visitor.visit_i64(value as i64)
+                }
+                _ => Err(de::Error::invalid_value(de::Unexpected::Other(text), &visitor)),
+            }
+        }
+    )*};
+}
+
+impl<'de, 'a, 'tree> de::Deserializer<'de> for &'a mut Deserializer<'de, 'tree> {
+    type Error = Error;
+
+    fn deserialize_any<V: de::Visitor<'de>>(self, visitor: V) -> Result<V::Value> {
+        let kind = self.cursor.node().kind_id();
+        if kind == self.kinds.source_file || kind == self.kinds.group || kind == self.kinds.list {
+            return self.block(visitor);
+        }
+        match self.scalar()? {
+            Scalar::Number(text) => match parse_number(text) {
+                Some((_, Some(integer))) => visitor.visit_i64(integer),
+                Some((value, None)) => visitor.visit_f64(value),
+                None => visitor.visit_borrowed_str(text),
+            },
+            Scalar::Text(Cow::Borrowed(text)) => visitor.visit_borrowed_str(text),
+            Scalar::Text(Cow::Owned(text)) => visitor.visit_string(text),
+        }
+    }
+
+    fn deserialize_bool<V: de::Visitor<'de>>(self, visitor: V) -> Result<V::Value> {
+        match self.scalar()? {
+            Scalar::Text(text) if text.eq_ignore_ascii_case("true") => visitor.visit_bool(true),
+            Scalar::Text(text) if text.eq_ignore_ascii_case("false") => visitor.visit_bool(false),
+            _ => self.deserialize_any(visitor),
+        }
+    }
+
+    deserialize_integer! {
+        deserialize_i8 deserialize_i16 deserialize_i32 deserialize_i64
+        deserialize_u8 deserialize_u16 deserialize_u32 deserialize_u64
+    }
+
+    fn deserialize_f32<V: de::Visitor<'de>>(self, visitor: V) -> Result<V::Value> {
+        self.deserialize_f64(visitor)
+    }
+
+    fn deserialize_f64<V: de::Visitor<'de>>(self, visitor: V) -> Result<V::Value> {
+        match self.scalar()? {
+            Scalar::Number(text) => match parse_number(text) {
+                Some((value, _)) => visitor.visit_f64(value),
+                None => Err(de::Error::invalid_value(de::Unexpected::Other(text), &visitor)),
+            },
+            _ => self.deserialize_any(visitor),
+        }
+    }
+
+    // Numbers stay text when text is asked for, e.g. `Version = 1.0`.
+    fn deserialize_str<V: de::Visitor<'de>>(self, visitor: V) -> Result<V::Value> {
+        match self.scalar()? {
+            Scalar::Number(text) | Scalar::Text(Cow::Borrowed(text)) => {
+                visitor.visit_borrowed_str(text)
+            }
+            Scalar::Text(Cow::Owned(text)) => visitor.visit_string(text),
+        }
+    }
+
+    fn deserialize_string<V: de::Visitor<'de>>(self, visitor: V) -> Result<V::Value> {
+        self.deserialize_str(visitor)
+    }
+
+    fn deserialize_char<V: de::Visitor<'de>>(self, visitor: V) -> Result<V::Value> {
+        self.deserialize_str(visitor)
+    }
+
+    fn deserialize_identifier<V: de::Visitor<'de>>(self, visitor: V) -> Result<V::Value> {
+        self.deserialize_str(visitor)
+    }
+
+    // An entry that is present is never None.
+    fn deserialize_option<V: de::Visitor<'de>>(self, visitor: V) -> Result<V::Value> {
+        visitor.visit_some(self)
+    }
+
+    fn deserialize_unit<V: de::Visitor<'de>>(self, visitor: V) -> Result<V::Value> {
+        visitor.visit_unit()
+    }
+
+    fn deserialize_unit_struct<V: de::Visitor<'de>>(
+        self,
+        _name: &'static str,
+        visitor: V,
+    ) -> Result<V::Value> {
+        visitor.visit_unit()
+    }
+
+    fn deserialize_newtype_struct<V: de::Visitor<'de>>(
+        self,
+        _name: &'static str,
+        visitor: V,
+    ) -> Result<V::Value> {
+        visitor.visit_newtype_struct(self)
+    }
+
+    // Unit variants are bare words: `Type = Engine`.
+    fn deserialize_enum<V: de::Visitor<'de>>(
+        self,
+        _name: &'static str,
+        _variants: &'static [&'static str],
+        visitor: V,
+    ) -> Result<V::Value> {
+        match self.scalar()? {
+            Scalar::Number(text) | Scalar::Text(Cow::Borrowed(text)) => {
+                visitor.visit_enum(BorrowedStrDeserializer::new(text))
+            }
+            Scalar::Text(Cow::Owned(text)) => visitor.visit_enum(text.into_deserializer()),
+        }
+    }
+
+    // Skipped entries are not walked.
+    fn deserialize_ignored_any<V: de::Visitor<'de>>(self, visitor: V) -> Result<V::Value> {
+        visitor.visit_unit()
+    }
+
+    forward_to_deserialize_any! {
+        i128 u128 bytes byte_buf seq tuple tuple_struct map struct
+    }
+}
+
+// The entries of a block, as a map or a sequence. The cursor steps into the
+// block on the first call and back out once the entries run out.
+struct Block<'a, 'de, 'tree> {
+    de: &'a mut Deserializer<'de, 'tree>,
+    object: bool,
+    entered: bool,
+    done: bool,
+    // The cursor already rests on the next child to look at.
+    pending: bool,
+    index: usize,
+    extends: Option<Vec<&'de str>>,
+}
+
+impl<'a, 'de, 'tree> Block<'a, 'de, 'tree> {
+    fn new(de: &'a mut Deserializer<'de, 'tree>) -> Self {
+        let object = de.cursor.node().kind_id() != de.kinds.list;
+        Block {
+            de,
+            object,
+            entered: false,
+            done: false,
+            pending: false,
+            index: 0,
+            extends: None,
+        }
+    }
+
+    fn advance(&mut self) -> bool {
+        if self.done {
+            return false;
+        }
+        if self.pending {
+            self.pending = false;
+            return true;
+        }
+        let moved = if self.entered {
+            self.de.cursor.goto_next_sibling()
+        } else {
+            self.entered = self.de.cursor.goto_first_child();
+            self.entered
+        };
+        if !moved {
+            self.finish();
+        }
+        moved
+    }
+
+    // Moves the cursor back to the block, also when a visitor stops early.
+    fn finish(&mut self) {
+        if self.entered && !self.done {
+            self.de.cursor.goto_parent();
+        }
+        self.done = true;
+    }
+
+    // Collects the run of `extension` children starting at the cursor.
+    fn collect_extensions(&mut self) -> Vec<&'de str> {
+        let mut extensions = Vec::new();
+        loop {
+            let node = self.de.cursor.node();
+            if node.kind_id() != self.de.kinds.extension {
+                self.pending = true;
+                break;
+            }
+            let reference = node.named_child(0).unwrap_or(node);
+            extensions.push(self.de.text(reference));
+            if !self.de.cursor.goto_next_sibling() {
+                self.de.cursor.goto_parent();
+                self.done = true;
+                break;
+            }
+        }
+        extensions
+    }
+
+    // Moves to the next entry and returns its key. In a group, a run of
+    // extensions comes back as the key "$extends", with the references
+    // kept for the value.
+    fn next_key(&mut self) -> Option<&'de str> {
+        while self.advance() {
+            let kind = self.de.cursor.node().kind_id();
+            if kind == self.de.kinds.extension && self.object {
+                self.extends = Some(self.collect_extensions());
+                return Some("$extends");
+            }
+            if self.de.kinds.is_entry(kind) {
+                return Some(self.de.key(self.de.cursor.node()));
+            }
+        }
+        None
+    }
+}
+
+impl<'de> de::MapAccess<'de> for Block<'_, 'de, '_> {
+    type Error = Error;
+
+    fn next_key_seed<K: de::DeserializeSeed<'de>>(&mut self, seed: K) -> Result<Option<K::Value>> {
+        let Some(key) = self.next_key() else {
+            return Ok(None);
+        };
+        if self.extends.is_some() {
+            return seed.deserialize(BorrowedStrDeserializer::new(key)).map(Some);
+        }
+        let index = self.index;
+        self.index += 1;
+        if key.is_empty() {
+            return seed.deserialize(index.to_string().into_deserializer()).map(Some);
+        }
+        seed.deserialize(BorrowedStrDeserializer::new(key)).map(Some)
+    }
+
+    fn next_value_seed<V: de::DeserializeSeed<'de>>(&mut self, seed: V) -> Result<V::Value> {
+        if let Some(extensions) = self.extends.take() {
+            let items = extensions.into_iter().map(BorrowedStrDeserializer::new);
+            return seed.deserialize(SeqDeserializer::new(items));
+        }
+        seed.deserialize(&mut *self.de)
+    }
+}
+
+impl<'de> de::SeqAccess<'de> for Block<'_, 'de, '_> {
+    type Error = Error;
+
+    fn next_element_seed<T: de::DeserializeSeed<'de>>(&mut self, seed: T) -> Result<Option<T::Value>> {
+        let Some(key) = self.next_key() else {
+            return Ok(None);
+        };
+        if key.is_empty() {
+            return seed.deserialize(&mut *self.de).map(Some);
+        }
+        seed.deserialize(KeyedEntry {
+            de: &mut *self.de,
+            key: Some(key),
+        })
+        .map(Some)
+    }
+}
+
+// A keyed entry inside a list, as a map with one entry.
+struct KeyedEntry<'a, 'de, 'tree> {
+    de: &'a mut Deserializer<'de, 'tree>,
+    key: Option<&'de str>,
+}
+
+impl<'de> de::Deserializer<'de> for KeyedEntry<'_, 'de, '_> {
+    type Error = Error;
+
+    fn deserialize_any<V: de::Visitor<'de>>(mut self, visitor: V) -> Result<V::Value> {
+        visitor.visit_map(&mut self)
+    }
+
+    fn deserialize_option<V: de::Visitor<'de>>(self, visitor: V) -> Result<V::Value> {
+        visitor.visit_some(self)
+    }
+
+    fn deserialize_ignored_any<V: de::Visitor<'de>>(self, visitor: V) -> Result<V::Value> {
+        visitor.visit_unit()
+    }
+
+    forward_to_deserialize_any! {
+        bool i8 i16 i32 i64 i128 u8 u16 u32 u64 u128 f32 f64 char str string bytes byte_buf
+        unit unit_struct newtype_struct seq tuple tuple_struct map struct enum identifier
+    }
+}
+
+impl<'de> de::MapAccess<'de> for &mut KeyedEntry<'_, 'de, '_> {
+    type Error = Error;
+
+    fn next_key_seed<K: de::DeserializeSeed<'de>>(&mut self, seed: K) -> Result<Option<K::Value>> {
+        match self.key.take() {
+            Some(key) => seed.deserialize(BorrowedStrDeserializer::new(key)).map(Some),
+            None => Ok(None),
+        }
+    }
+
+    fn next_value_seed<V: de::DeserializeSeed<'de>>(&mut self, seed: V) -> Result<V::Value> {
+        seed.deserialize(&mut *self.de)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use std::borrow::Cow;
+    use std::collections::BTreeMap;
+
+    use serde::Deserialize;
+
+    use super::from_str;
+
+    #[derive(Debug, Deserialize, PartialEq)]
+    #[serde(rename_all = "PascalCase")]
+    struct Part<'a> {
+        name: &'a str,
+        cost: u32,
+        mass: f64,
+        #[serde(borrow)]
+        title: Cow<'a, str>,
+        #[serde(default)]
+        enabled: bool,
+        #[serde(rename = "$extends", default)]
+        extends: Vec<&'a str>,
+    }
+
+    #[derive(Debug, Deserialize)]
+    #[serde(rename_all = "PascalCase")]
+    struct Document<'a> {
+        #[serde(borrow)]
+        part: Part<'a>,
+    }
+
+    #[test]
+    fn test_borrows_from_source() {
+        let source = "Part : BasePart\n{\n    Name = Thruster\n    Cost = 150\n    Mass = 1.25\n    \
+                      Title = \"Small \\\"Ant\\\"\"\n    Enabled = true\n    Skipped\n    {\n        A = 1\n    }\n}\n";
+        let document: Document = from_str(source).unwrap();
+        let part = document.part;
+        assert_eq!(part.name, "Thruster");
+        assert_eq!(part.cost, 150);
+        assert_eq!(part.mass, 1.25);
+        assert_eq!(part.title, "Small \"Ant\"");
+        assert!(matches!(part.title, Cow::Owned(_)));
+        assert!(part.enabled);
+        assert_eq!(part.extends, ["BasePart"]);
+    }
+
+    #[test]
+    fn test_numbers() {
+        let values: BTreeMap<&str, f64> = from_str("A = 50%\nB = 90d\nC = -2\n").unwrap();
+        assert_eq!(values["A"], 0.5);
+        assert_eq!(values["B"], 90.0);
+        assert_eq!(values["C"], -2.0);
+
+        let text: BTreeMap<&str, &str> = from_str("Version = 1.0\n").unwrap();
+        assert_eq!(text["Version"], "1.0");
+
+        let error = from_str::<BTreeMap<&str, u8>>("A = 1\nB = 300\n").unwrap_err();
+        assert_eq!(error.position().map(|point| point.row), Some(1));
+    }
+
+    #[test]
+    fn test_lists_and_values() {
+        let source = "Items\n[\n    A = 1\n    {\n        B = x\n    }\n]\nOuter\n{\n    [\n        N = 2\n    ]\n}\n";
+        let value: serde_json::Value = from_str(source).unwrap();
+        assert_eq!(
+            value,
+            serde_json::json!({
+                "Items": [{"A": 1}, {"B": "x"}],
+                "Outer": {"0": [{"N": 2}]},
+            })
+        );
+    }
+
+    #[test]
+    fn test_syntax_error() {
+        let error = from_str::<serde_json::Value>("A = 1\nGroup\n{\n").unwrap_err();
+        assert!(error.to_string().starts_with("syntax error"));
+        assert!(error.position().is_some());
+    }
+}
@@ -15,11 +15,17 @@
 //! assert!(!tree.root_node().has_error());
 //! ```
 //!
+//! With the `serde` feature, the `de` module deserializes documents straight
+//! from a tree into borrowed Rust types.
+//!
 //! [`Parser`]: https://docs.rs/tree-sitter/0.25.9/tree_sitter/struct.Parser.html
 //! [tree-sitter]: https://tree-sitter.github.io/
 
 use tree_sitter_language::LanguageFn;
 
+#[cfg(feature = "serde")]
+pub mod de;
+
 extern "C" {
     fn tree_sitter_objecttext() -> *const ();
 }
@@ -32,12 +38,14 @@ pub const LANGUAGE: LanguageFn = unsafe { LanguageFn::from_raw(tree_sitter_objec
 /// [`node-types.json`]: https://tree-sitter.github.io/tree-sitter/using-parsers/6-static-node-types
 pub const NODE_TYPES: &str = include_str!("../../src/node-types.json");
 
-// NOTE: uncomment these to include any queries that this grammar contains:
+/// The syntax highlighting query for this grammar.
+pub const HIGHLIGHTS_QUERY: &str = include_str!("../../queries/highlights.scm");
+
+/// The local-variable syntax highlighting query for this grammar.
+pub const LOCALS_QUERY: &str = include_str!("../../queries/locals.scm");
 
-// pub const HIGHLIGHTS_QUERY: &str = include_str!("../../queries/highlights.scm");
-// pub const INJECTIONS_QUERY: &str = include_str!("../../queries/injections.scm");
-// pub const LOCALS_QUERY: &str = include_str!("../../queries/locals.scm");
-// pub const TAGS_QUERY: &str = include_str!("../../queries/tags.scm");
+/// The symbol tagging query for this grammar.
+pub const TAGS_QUERY: &str = include_str!("../../queries/tags.scm");
 
 #[cfg(test)]
 mod tests {
@@ -48,4 +56,12 @@ mod tests {
             .set_language(&super::LANGUAGE.into())
             .expect("Error loading Object Text parser");
     }
+
+    #[test]
+    fn test_can_compile_queries() {
+        let language: tree_sitter::Language = super::LANGUAGE.into();
+        for source in [super::HIGHLIGHTS_QUERY, super::LOCALS_QUERY, super::TAGS_QUERY] {
+            tree_sitter::Query::new(&language, source).expect("Error compiling query");
+        }
+    }
 }
@@ -0,0 +1,83 @@
+#ifndef OBJECTTEXT_FUZZ_PARSE_BUDGET_H_
+#define OBJECTTEXT_FUZZ_PARSE_BUDGET_H_
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#ifdef OBJECTTEXT_COUNT_ALLOCATIONS
+#include <tree_sitter/tree-sitter-objecttext-alloc.h>
+#endif
+
+#include "objecttext/parser.h"
+
+// How much a parse may cost relative to its input. Linear grammars stay far
+// below these; inputs that exceed them hit a super-linear path. The fixed
+// allowances absorb timer noise and the parser's own setup on tiny inputs.
+struct ParseBudget {
+    double ns_per_byte = 2000;
+    double fixed_ms = 20;
+    double bytes_per_byte = 400;
+    double fixed_bytes = 1 << 20;
+
+    // OBJECTTEXT_BUDGET_NS_PER_BYTE and OBJECTTEXT_BUDGET_BYTES_PER_BYTE
+    // override the per-byte limits.
+    static ParseBudget from_environment() {
+        ParseBudget budget;
+        if (const char *value = getenv("OBJECTTEXT_BUDGET_NS_PER_BYTE")) budget.ns_per_byte = atof(value);
+        if (const char *value = getenv("OBJECTTEXT_BUDGET_BYTES_PER_BYTE")) budget.bytes_per_byte = atof(value);
+        return budget;
+    }
+};
+
+struct ParseCost {
+    double seconds = 0;
+    long long peak_bytes = -1; // -1 without the allocation counters
+};
+
+// Parses |source| once. Peak bytes need a build with
+// OBJECTTEXT_COUNT_ALLOCATIONS and the counting hooks installed before the
+// parser was created.
+inline ParseCost measure_parse(objecttext::Parser &parser, std::string_view source) {
+    ParseCost cost;
+#ifdef OBJECTTEXT_COUNT_ALLOCATIONS
+    tree_sitter_objecttext_alloc_stats_reset();
+    TSObjecttextAllocStats before;
+    tree_sitter_objecttext_alloc_stats_get(&before);
+#endif
+    auto start = std::chrono::steady_clock::now();
+    objecttext::Tree tree = parser.parse(source);
+    cost.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+#ifdef OBJECTTEXT_COUNT_ALLOCATIONS
+    TSObjecttextAllocStats after;
+    tree_sitter_objecttext_alloc_stats_get(&after);
+    cost.peak_bytes = after.peak_bytes - before.current_bytes;
+#endif
+    return cost;
+}
+
+// Returns false and describes the overrun in |reason| if |cost| is over
+// |budget| for an input of |bytes|.
+inline bool within_budget(const ParseBudget &budget, const ParseCost &cost, size_t bytes,
+                          std::string *reason) {
+    char message[160];
+    double time_limit = (budget.fixed_ms * 1e6 + budget.ns_per_byte * bytes) / 1e9;
+    if (cost.seconds > time_limit) {
+        snprintf(message, sizeof(message), "parse took %.3f ms for %zu bytes, budget %.3f ms",
+                 cost.seconds * 1e3, bytes, time_limit * 1e3);
+        *reason = message;
+        return false;
+    }
+    double memory_limit = budget.fixed_bytes + budget.bytes_per_byte * bytes;
+    if (cost.peak_bytes >= 0 && cost.peak_bytes > memory_limit) {
+        snprintf(message, sizeof(message), "parse peaked at %lld bytes for %zu bytes, budget %.0f",
+                 cost.peak_bytes, bytes, memory_limit);
+        *reason = message;
+        return false;
+    }
+    return true;
+}
+
+#endif // OBJECTTEXT_FUZZ_PARSE_BUDGET_H_
@@ -0,0 +1,41 @@
+// libFuzzer/AFL++ harness that fails on inputs which are slow or
+// memory-hungry to parse relative to their size, rather than on crashes
+// alone.
+//
+// Configure with clang, -DOBJECTTEXT_BUILD_FUZZER=ON, -DBUILD_SHARED_LIBS=OFF
+// and -fsanitize=fuzzer-no-link,address in CMAKE_C_FLAGS and
+// CMAKE_CXX_FLAGS, then run
+//
+//   objecttext-parse-fuzzer -max_len=65536 fuzz/regressions
+//
+// AFL++ works the same way with afl-clang-fast++, which understands
+// -fsanitize=fuzzer. An input over budget aborts. Minimize it with
+// `-minimize_crash=1 -runs=10000 <input>` and add the result to
+// fuzz/regressions, which objecttext-bench-regressions replays.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "parse_budget.h"
+
+extern "C" int LLVMFuzzerInitialize(int *, char ***) {
+    // The counting hooks must be in place before the first allocation.
+    tree_sitter_objecttext_alloc_stats_install();
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    static objecttext::Parser parser;
+    static const ParseBudget budget = ParseBudget::from_environment();
+
+    std::string_view source(reinterpret_cast<const char *>(data), size);
+    ParseCost cost = measure_parse(parser, source);
+    std::string reason;
+    if (!within_budget(budget, cost, size, &reason)) {
+        fprintf(stderr, "over budget: %s\n", reason.c_str());
+        abort();
+    }
+    return 0;
+}
@@ -0,0 +1,56 @@
+(comment) @comment
+
+[
+  (string)
+  (verbatim)
+] @string
+
+(bare_word) @string.special
+
+(number) @number
+
+(group
+  key: (identifier) @type)
+
+(list
+  .
+  (identifier) @type)
+
+(assignment
+  .
+  (identifier) @property)
+
+(extension
+  (internal_reference
+    (identifier) @type))
+
+(path_reference
+  [
+    "<"
+    ">"
+  ] @punctuation.special)
+
+(path_reference) @string.special.path
+
+(internal_reference
+  (identifier) @variable)
+
+"&" @operator
+
+[
+  "="
+  ":"
+  "+"
+  "-"
+  "*"
+  "/"
+] @operator
+
+[
+  "{"
+  "}"
+  "["
+  "]"
+  "("
+  ")"
+] @punctuation.bracket
@@ -0,0 +1,19 @@
+[
+  (source_file)
+  (group)
+  (list)
+] @local.scope
+
+(group
+  key: (identifier) @local.definition)
+
+(list
+  .
+  (identifier) @local.definition)
+
+(assignment
+  .
+  (identifier) @local.definition)
+
+(internal_reference
+  (identifier) @local.reference)
@@ -0,0 +1,19 @@
+(group
+  key: (identifier) @name) @definition.class
+
+(list
+  .
+  (identifier) @name) @definition.class
+
+(assignment
+  .
+  (identifier) @name) @definition.constant
+
+(extension
+  (internal_reference) @name) @reference.class
+
+(reference
+  (internal_reference) @name) @reference.constant
+
+(reference
+  (path_reference) @name) @reference.constant
@@ -1,4 +1,4 @@
-from os import path
+from os import environ, path
 from sysconfig import get_config_var
 
 from setuptools import Extension, find_packages, setup
@@ -8,6 +8,28 @@ from setuptools.command.egg_info import egg_info
 from wheel.bdist_wheel import bdist_wheel
 
 
+# parse() and parse_many() need the tree-sitter runtime (0.25 or later, for
+# ABI 15) and the C++ API. Point TREE_SITTER_LIB_DIR at the lib/ directory of
+# a tree-sitter checkout to build them in; without it only language() exists.
+# They use the buffer protocol, which joined the limited API in Python 3.11.
+TREE_SITTER_LIB = environ.get("TREE_SITTER_LIB_DIR", "")
+WITH_RUNTIME = bool(TREE_SITTER_LIB) and path.exists(path.join(TREE_SITTER_LIB, "src", "lib.c"))
+CPP_SOURCES = [
+    "bindings/cpp/arena.cc",
+    "bindings/cpp/expression.cc",
+    "bindings/cpp/metrics.cc",
+    "bindings/cpp/parse_metrics.cc",
+    "bindings/cpp/parser.cc",
+    "bindings/cpp/path_match.cc",
+    "bindings/cpp/path_query.cc",
+    "bindings/cpp/trace.cc",
+    "bindings/cpp/value.cc",
+    "bindings/python/tree_sitter_objecttext/parse_many.cc",
+    "bindings/python/tree_sitter_objecttext/tree.cc",
+]
+LIMITED_API = ("cp311", "0x030B0000") if WITH_RUNTIME else ("cp310", "0x030A0000")
+
+
 class Build(build):
     def run(self):
         if path.isdir("queries"):
@@ -20,20 +42,39 @@ class BuildExt(build_ext):
     def build_extension(self, ext: Extension):
         if self.compiler.compiler_type != "msvc":
             ext.extra_compile_args = ["-std=c11", "-fvisibility=hidden"]
+            if WITH_RUNTIME:
+                ext.extra_link_args = ["-pthread"]
+                self._compile_cpp_as_cpp17()
         else:
             ext.extra_compile_args = ["/std:c11", "/utf-8"]
+            if WITH_RUNTIME:
+                ext.extra_compile_args.append("/std:c++17")
         if path.exists("src/scanner.c"):
             ext.sources.append("src/scanner.c")
         if ext.py_limited_api:
-            ext.define_macros.append(("Py_LIMITED_API", "0x030A0000"))
+            ext.define_macros.append(("Py_LIMITED_API", LIMITED_API[1]))
         super().build_extension(ext)
 
+    def _compile_cpp_as_cpp17(self):
+        # Unix compilers get one set of flags for every source; swap the C
+        # standard for a C++ one on the .cc files.
+        compile = self.compiler._compile
+
+        def _compile(obj, src, ext, cc_args, extra_postargs, pp_opts):
+            if src.endswith(".cc"):
+                extra_postargs = [
+                    "-std=c++17" if arg == "-std=c11" else arg for arg in extra_postargs
+                ]
+            compile(obj, src, ext, cc_args, extra_postargs, pp_opts)
+
+        self.compiler._compile = _compile
+
 
 class BdistWheel(bdist_wheel):
     def get_tag(self):
         python, abi, platform = super().get_tag()
         if python.startswith("cp"):
-            python, abi = "cp310", "abi3"
+            python, abi = LIMITED_API[0], "abi3"
         return python, abi, platform
 
 
@@ -42,6 +83,9 @@ class EggInfo(egg_info):
         super().find_sources()
         self.filelist.recursive_include("queries", "*.scm")
         self.filelist.include("src/tree_sitter/*.h")
+        self.filelist.recursive_include("bindings/c", "*.h")
+        self.filelist.recursive_include("bindings/cpp/objecttext", "*.h")
+        self.filelist.include(*CPP_SOURCES)
 
 
 setup(
@@ -58,12 +102,18 @@ setup(
             sources=[
                 "bindings/python/tree_sitter_objecttext/binding.c",
                 "src/parser.c",
-            ],
+            ] + ([path.join(TREE_SITTER_LIB, "src", "lib.c")] + CPP_SOURCES if WITH_RUNTIME else []),
             define_macros=[
                 ("PY_SSIZE_T_CLEAN", None),
                 ("TREE_SITTER_HIDE_SYMBOLS", None),
-            ],
-            include_dirs=["src"],
+            ] + ([("OBJECTTEXT_WITH_RUNTIME", None), ("_DEFAULT_SOURCE", None)] if WITH_RUNTIME else []),
+            include_dirs=["src"] + ([
+                path.join(TREE_SITTER_LIB, "include"),
+                path.join(TREE_SITTER_LIB, "src"),
+                "bindings/c",
+                "bindings/cpp",
+            ] if WITH_RUNTIME else []),
+            language="c++" if WITH_RUNTIME else None,
             py_limited_api=not get_config_var("Py_GIL_DISABLED"),
         )
     ],